@@ -0,0 +1,40 @@
+#include "alloc_counter.h"
+
+#ifdef HUE_EDK_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+// Replacement operator new/delete for everything linked into the addon
+// (including the statically linked EDK). On Linux the count_allocations
+// build links with -Bsymbolic-functions so the addon binds to these
+// instead of the ones already loaded by Node.
+
+static thread_local int64_t threadAllocations = 0;
+
+static void* CountedAlloc(std::size_t size) {
+    ++threadAllocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+int64_t ThreadAllocationCount() {
+    return threadAllocations;
+}
+
+#else
+
+int64_t ThreadAllocationCount() {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocations made by the calling thread through operator new. Only
+// counted when the addon is built with count_allocations=1
+// (node-gyp rebuild --count_allocations=1); otherwise always returns -1.
+int64_t ThreadAllocationCount();
@@ -0,0 +1,468 @@
+#include <napi.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "color_kernels.h"
+#include "effect_engine.h"
+#include "frame_cache.h"
+#include "output_lut.h"
+#include "stream_session.h"
+#include "triple_buffer.h"
+
+// Native half of the benchmark suite; scripts/bench.cjs drives it and writes
+// the JSON report. Every scenario runs against the simulated backend or a
+// bare component, so no bridge or network is involved.
+
+using Clock = std::chrono::steady_clock;
+
+static double ElapsedUs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+// ============= Helpers =============
+
+// Timing samples reduced to { count, mean, p50, p99, max }
+class Samples {
+public:
+    void Reserve(size_t count) { values_.reserve(count); }
+    void Add(double value) { values_.push_back(value); }
+
+    Napi::Object Summary(Napi::Env env) {
+        Napi::Object summary = Napi::Object::New(env);
+        summary.Set("count", Napi::Number::New(env, static_cast<double>(values_.size())));
+        if (values_.empty()) {
+            return summary;
+        }
+
+        std::sort(values_.begin(), values_.end());
+        double total = 0.0;
+        for (double value : values_) {
+            total += value;
+        }
+        summary.Set("mean", Napi::Number::New(env, total / values_.size()));
+        summary.Set("p50", Napi::Number::New(env, Percentile(0.50)));
+        summary.Set("p99", Napi::Number::New(env, Percentile(0.99)));
+        summary.Set("max", Napi::Number::New(env, values_.back()));
+        return summary;
+    }
+
+    // Summary() plus the largest distance from the expected interval
+    Napi::Object IntervalSummary(Napi::Env env, double expected) {
+        Napi::Object summary = Summary(env);
+        if (!values_.empty()) {
+            double deviation = std::max(expected - values_.front(), values_.back() - expected);
+            summary.Set("maxDeviation", Napi::Number::New(env, deviation));
+        }
+        return summary;
+    }
+
+private:
+    double Percentile(double fraction) const {
+        size_t index = static_cast<size_t>(fraction * (values_.size() - 1) + 0.5);
+        return values_[index];
+    }
+
+    std::vector<double> values_;
+};
+
+static int ReadOption(const Napi::CallbackInfo& info, const char* name, int fallback) {
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        return fallback;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (!options.Has(name)) {
+        return fallback;
+    }
+    return std::max(options.Get(name).ToNumber().Int32Value(), 1);
+}
+
+// ============= Mixer Lock =============
+
+// mixerLock({ lights = 10, durationMs = 2000, writeIntervalUs = 1000 })
+//
+// Streams a native effect through a simulated session rendered at 60 Hz
+// while a writer thread re-parameterizes it under the mixer lock and
+// publishes manual frames, the two things the JS setters do. Reports how
+// long the writer waits for and holds the lock, the lock-free publish cost
+// and the render frame time (which holds the lock on the other side). The
+// render loop first runs alone for durationMs; the tick-to-tick intervals
+// of both phases show how much the writer shifts the 60 Hz cadence.
+static Napi::Value MixerLock(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    int lights = ReadOption(info, "lights", 10);
+    int durationMs = ReadOption(info, "durationMs", 2000);
+    int writeIntervalUs = ReadOption(info, "writeIntervalUs", 1000);
+
+    BackendOptions options;
+    options.kind = BackendKind::Simulated;
+    options.lights = static_cast<size_t>(lights);
+    options.captureFrames = 16;
+
+    StreamSession session("bench", "bench", true, options);
+    session.Connect(BridgeCredentials{"bench", "127.0.0.1", "bench", "bench"});
+    session.SelectGroup("1");
+    if (!session.WaitForStreaming(std::chrono::milliseconds(1000)) || !session.StartStreaming()) {
+        Napi::Error::New(env, "Simulated session did not start").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    session.SyncLightTable();
+
+    std::vector<int> lightIds;
+    for (int id = 1; id <= lights; ++id) {
+        lightIds.push_back(id);
+    }
+    EffectParams params;
+    params.period = 2000;
+    session.RunEffect(CreateNativeEffect("rainbowWave", params), lightIds);
+
+    // The render loop of one phase: frame times plus the interval between
+    // successive tick starts, against the 60 Hz period
+    const auto period = std::chrono::microseconds(1000000 / 60);
+    Samples renderUs;
+    renderUs.Reserve(static_cast<size_t>(durationMs) / 8 + 32);
+    Samples idleTicksMs;
+    Samples writerTicksMs;
+    idleTicksMs.Reserve(static_cast<size_t>(durationMs) / 16 + 16);
+    writerTicksMs.Reserve(static_cast<size_t>(durationMs) / 16 + 16);
+    std::atomic<bool> running(true);
+    auto startRenderThread = [&](Samples& ticksMs) {
+        running = true;
+        Samples* ticks = &ticksMs;
+        return std::thread([&, ticks]() {
+            auto deadline = Clock::now();
+            Clock::time_point previous;
+            bool first = true;
+            while (running.load(std::memory_order_relaxed)) {
+                auto start = Clock::now();
+                if (!first) {
+                    ticks->Add(ElapsedUs(previous, start) / 1000.0);
+                }
+                first = false;
+                previous = start;
+                session.RenderFrame();
+                renderUs.Add(ElapsedUs(start, Clock::now()));
+                deadline += period;
+                std::this_thread::sleep_until(deadline);
+            }
+        });
+    };
+
+    // Baseline: the same loop with nobody else taking the lock
+    std::thread renderThread = startRenderThread(idleTicksMs);
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    running = false;
+    renderThread.join();
+
+    Samples waitUs;
+    Samples holdUs;
+    Samples publishUs;
+    size_t expectedWrites = static_cast<size_t>(durationMs) * 1000 / writeIntervalUs + 16;
+    waitUs.Reserve(expectedWrites);
+    holdUs.Reserve(expectedWrites);
+    publishUs.Reserve(expectedWrites);
+
+    renderThread = startRenderThread(writerTicksMs);
+    auto end = Clock::now() + std::chrono::milliseconds(durationMs);
+    size_t writes = 0;
+    while (Clock::now() < end) {
+        params.period = 1000 + (writes % 1000);
+
+        auto requested = Clock::now();
+        session.LockMixer();
+        auto acquired = Clock::now();
+        session.Engine()->SetParams(params);
+        auto released = Clock::now();
+        session.UnlockMixer();
+        waitUs.Add(ElapsedUs(requested, acquired));
+        holdUs.Add(ElapsedUs(acquired, released));
+
+        auto publishStart = Clock::now();
+        session.Frame().SetAll(huestream::Color(writes % 2, 0.0, 1.0, 1.0));
+        session.PublishFrame();
+        publishUs.Add(ElapsedUs(publishStart, Clock::now()));
+
+        ++writes;
+        std::this_thread::sleep_for(std::chrono::microseconds(writeIntervalUs));
+    }
+
+    running = false;
+    renderThread.join();
+    session.ShutDown();
+
+    double periodMs = std::chrono::duration<double, std::milli>(period).count();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("lights", Napi::Number::New(env, lights));
+    result.Set("durationMs", Napi::Number::New(env, durationMs));
+    result.Set("writes", Napi::Number::New(env, static_cast<double>(writes)));
+    result.Set("lockWaitUs", waitUs.Summary(env));
+    result.Set("lockHoldUs", holdUs.Summary(env));
+    result.Set("publishUs", publishUs.Summary(env));
+    result.Set("renderFrameUs", renderUs.Summary(env));
+    result.Set("tickIntervalMs", idleTicksMs.IntervalSummary(env, periodMs));
+    result.Set("tickIntervalWithWritersMs", writerTicksMs.IntervalSummary(env, periodMs));
+    return result;
+}
+
+// ============= Triple Buffer =============
+
+// tripleBuffer({ lights = 50, durationMs = 1000 })
+//
+// Stress test for the frame hand-off: a producer publishes frames whose
+// values all equal the frame number as fast as it can while a consumer
+// acquires them. A torn frame (mixed values) or a frame older than the
+// previous one is a bug; both counts must be zero.
+static Napi::Value TripleBufferStress(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    int lights = ReadOption(info, "lights", 50);
+    int durationMs = ReadOption(info, "durationMs", 1000);
+
+    struct Frame {
+        std::vector<uint64_t> values;
+    };
+    TripleBuffer<Frame> buffer;
+    buffer.Reset(Frame{std::vector<uint64_t>(static_cast<size_t>(lights) * 3, 0)});
+
+    std::atomic<bool> running(true);
+    uint64_t published = 0;
+    std::thread producer([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            ++published;
+            Frame& back = buffer.Back();
+            std::fill(back.values.begin(), back.values.end(), published);
+            buffer.Publish();
+        }
+    });
+
+    uint64_t acquired = 0;
+    uint64_t torn = 0;
+    uint64_t regressions = 0;
+    uint64_t last = 0;
+    auto end = Clock::now() + std::chrono::milliseconds(durationMs);
+    while (Clock::now() < end) {
+        if (!buffer.Acquire()) {
+            continue;
+        }
+        ++acquired;
+        const Frame& front = buffer.Front();
+        uint64_t first = front.values.front();
+        if (std::any_of(front.values.begin(), front.values.end(),
+                        [first](uint64_t value) { return value != first; })) {
+            ++torn;
+        }
+        if (first <= last) {
+            ++regressions;
+        }
+        last = first;
+    }
+
+    running = false;
+    producer.join();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("lights", Napi::Number::New(env, lights));
+    result.Set("durationMs", Napi::Number::New(env, durationMs));
+    result.Set("published", Napi::Number::New(env, static_cast<double>(published)));
+    result.Set("acquired", Napi::Number::New(env, static_cast<double>(acquired)));
+    result.Set("torn", Napi::Number::New(env, static_cast<double>(torn)));
+    result.Set("regressions", Napi::Number::New(env, static_cast<double>(regressions)));
+    return result;
+}
+
+// ============= Color Kernels =============
+
+// colorKernels({ lights = 50, iterations = 20000 })
+//
+// Per-frame cost of each batch kernel without the N-API call around it; the
+// runner compares this with the same kernels called from JS and with the JS
+// color helpers.
+static Napi::Value ColorKernelCost(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    int lights = ReadOption(info, "lights", 50);
+    int iterations = ReadOption(info, "iterations", 20000);
+    size_t count = static_cast<size_t>(lights);
+
+    std::vector<float> input(count * 3);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<float>((i * 37) % 256);
+    }
+    std::vector<float> hsv(count * 3);
+    for (size_t i = 0; i < count; ++i) {
+        hsv[i * 3] = static_cast<float>(i) / count;
+        hsv[i * 3 + 1] = 1.0f;
+        hsv[i * 3 + 2] = 1.0f;
+    }
+    std::vector<float> other(input.rbegin(), input.rend());
+    std::vector<float> out(count * 3);
+    float t = 0.25f;
+
+    // Keeps the optimizer from dropping the loops
+    volatile float sink = 0.0f;
+    auto measure = [&](auto&& kernel) {
+        auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            kernel();
+            sink = sink + out[i % out.size()];
+        }
+        return ElapsedUs(start, Clock::now()) * 1000.0 / iterations;
+    };
+
+    Napi::Object nsPerFrame = Napi::Object::New(env);
+    nsPerFrame.Set("lerpColors", Napi::Number::New(env, measure([&]() {
+        BatchLerp(input.data(), 3, other.data(), 3, &t, 0, out.data(), count);
+    })));
+    nsPerFrame.Set("hsvToRgb", Napi::Number::New(env, measure([&]() {
+        BatchHsvToRgb(hsv.data(), out.data(), count);
+    })));
+    nsPerFrame.Set("rgbToXy", Napi::Number::New(env, measure([&]() {
+        BatchRgbToXy(input.data(), out.data(), count);
+    })));
+    nsPerFrame.Set("applyGamma", Napi::Number::New(env, measure([&]() {
+        BatchGamma(input.data(), out.data(), input.size(), 2.2f);
+    })));
+    nsPerFrame.Set("scaleBrightness", Napi::Number::New(env, measure([&]() {
+        BatchScale(input.data(), out.data(), input.size(), 0.8f);
+    })));
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("isa", Napi::String::New(env, ColorKernelIsa()));
+    result.Set("lights", Napi::Number::New(env, lights));
+    result.Set("iterations", Napi::Number::New(env, iterations));
+    result.Set("nsPerFrame", nsPerFrame);
+    return result;
+}
+
+// ============= Native Effects =============
+
+// effectRender({ lights = 50, iterations = 20000 })
+//
+// Render-thread cost of one frame of each native effect, rendered live and
+// played from the frame cache (periodic effects only)
+static Napi::Value EffectRenderCost(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    int lights = ReadOption(info, "lights", 50);
+    int iterations = ReadOption(info, "iterations", 20000);
+
+    EffectParams params;
+    params.colors = {{255, 0, 0}, {0, 0, 255}};
+    params.period = 2000;
+    params.rate = 250;
+
+    static const char* const kEffects[] = {
+        "gradientWave", "rippleGradient", "breathingGradient", "chaseGradient", "rainbowWave",
+        "pulseWave", "bouncingWave", "strobeLight", "spiralVortex", "shockwave", "energyBurst",
+    };
+
+    std::vector<Rgb> out(static_cast<size_t>(lights));
+    Napi::Object nsPerFrame = Napi::Object::New(env);
+    Napi::Object cachedNsPerFrame = Napi::Object::New(env);
+    for (const char* name : kEffects) {
+        std::unique_ptr<NativeEffect> effect = CreateNativeEffect(name, params);
+        if (!effect) {
+            continue;
+        }
+        auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            effect->Render(i * (1000.0 / 60.0), out.data(), out.size());
+        }
+        nsPerFrame.Set(name, Napi::Number::New(env, ElapsedUs(start, Clock::now()) * 1000.0 / iterations));
+
+        if (effect->CycleMs() <= 0) {
+            continue;
+        }
+        effect = CacheNativeEffect(name, std::move(effect), out.size());
+        start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            effect->Render(i * (1000.0 / 60.0), out.data(), out.size());
+        }
+        cachedNsPerFrame.Set(name, Napi::Number::New(env, ElapsedUs(start, Clock::now()) * 1000.0 / iterations));
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("lights", Napi::Number::New(env, lights));
+    result.Set("iterations", Napi::Number::New(env, iterations));
+    result.Set("nsPerFrame", nsPerFrame);
+    result.Set("cachedNsPerFrame", cachedNsPerFrame);
+    return result;
+}
+
+// ============= Output Correction =============
+
+// outputLut({ samples = 100000 })
+//
+// Per gamut: cost of one color through the exact correction and through the
+// lookup table, and the table's error against the exact result (largest
+// channel difference, in the bridge's 16-bit units) over random colors
+static Napi::Value OutputLutCost(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    int samples = ReadOption(info, "samples", 100000);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> input(static_cast<size_t>(samples) * 3);
+    for (double& value : input) {
+        value = unit(random);
+    }
+    std::vector<double> exact(input.size());
+    std::vector<double> table(input.size());
+
+    Napi::Object gamuts = Napi::Object::New(env);
+    for (Gamut gamut : {Gamut::A, Gamut::B, Gamut::C}) {
+        auto start = Clock::now();
+        std::shared_ptr<const OutputLut> lut = AcquireOutputLut(gamut, 0);
+        double buildUs = ElapsedUs(start, Clock::now());
+
+        start = Clock::now();
+        for (size_t i = 0; i < input.size(); i += 3) {
+            CorrectColorExact(gamut, 0, &input[i], &exact[i]);
+        }
+        double exactNs = ElapsedUs(start, Clock::now()) * 1000.0 / samples;
+
+        start = Clock::now();
+        for (size_t i = 0; i < input.size(); i += 3) {
+            lut->Apply(&input[i], &table[i]);
+        }
+        double lutNs = ElapsedUs(start, Clock::now()) * 1000.0 / samples;
+
+        Samples error;
+        error.Reserve(static_cast<size_t>(samples));
+        for (size_t i = 0; i < input.size(); i += 3) {
+            double worst = 0.0;
+            for (size_t c = 0; c < 3; ++c) {
+                worst = std::max(worst, std::fabs(exact[i + c] - table[i + c]) * 65535.0);
+            }
+            error.Add(worst);
+        }
+
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("buildUs", Napi::Number::New(env, buildUs));
+        entry.Set("exactNsPerColor", Napi::Number::New(env, exactNs));
+        entry.Set("lutNsPerColor", Napi::Number::New(env, lutNs));
+        entry.Set("error", error.Summary(env));
+        gamuts.Set(GamutName(gamut), entry);
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("samples", Napi::Number::New(env, samples));
+    result.Set("gridSize", Napi::Number::New(env, OutputLut::kSize));
+    result.Set("gamuts", gamuts);
+    return result;
+}
+
+Napi::Object InitBench(Napi::Env env, Napi::Object exports) {
+    exports.Set("mixerLock", Napi::Function::New(env, MixerLock));
+    exports.Set("tripleBuffer", Napi::Function::New(env, TripleBufferStress));
+    exports.Set("colorKernels", Napi::Function::New(env, ColorKernelCost));
+    exports.Set("effectRender", Napi::Function::New(env, EffectRenderCost));
+    exports.Set("outputLut", Napi::Function::New(env, OutputLutCost));
+    return exports;
+}
+
+NODE_API_MODULE(hue_edk_bench, InitBench)
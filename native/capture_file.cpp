@@ -0,0 +1,392 @@
+#include "capture_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Buffered bytes that wake the writer thread; about 2 s of a busy 60 Hz show
+static const size_t kFlushBytes = 64 * 1024;
+// Buffered bytes beyond which frames are dropped; minutes of output
+static const size_t kMaxPendingBytes = 16 * 1024 * 1024;
+
+static void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void PutU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static void StoreLe(uint8_t* out, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint64_t LoadLe(const uint8_t* data, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+static void EncodeHeader(const CaptureHeader& header, uint8_t out[sizeof(CaptureHeader)]) {
+    std::memset(out, 0, sizeof(CaptureHeader));
+    std::memcpy(out, header.magic, 4);
+    StoreLe(out + 4, header.version, 4);
+    StoreLe(out + 8, header.lightCount, 4);
+    StoreLe(out + 12, header.idBytes, 4);
+    StoreLe(out + 16, static_cast<uint64_t>(header.startNs), 8);
+    StoreLe(out + 24, header.frameCount, 8);
+    StoreLe(out + 32, header.durationUs, 8);
+    std::memcpy(out + 40, header.reserved, sizeof(header.reserved));
+}
+
+static void DecodeHeader(const uint8_t* data, CaptureHeader& header) {
+    std::memcpy(header.magic, data, 4);
+    header.version = static_cast<uint32_t>(LoadLe(data + 4, 4));
+    header.lightCount = static_cast<uint32_t>(LoadLe(data + 8, 4));
+    header.idBytes = static_cast<uint32_t>(LoadLe(data + 12, 4));
+    header.startNs = static_cast<int64_t>(LoadLe(data + 16, 8));
+    header.frameCount = LoadLe(data + 24, 8);
+    header.durationUs = LoadLe(data + 32, 8);
+    std::memcpy(header.reserved, data + 40, sizeof(header.reserved));
+}
+
+// False if the varint runs past end
+static bool GetVarint(const uint8_t* data, size_t end, size_t& offset, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < end; shift += 7) {
+        uint8_t byte = data[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============= CaptureWriter =============
+
+CaptureWriter::CaptureWriter(const std::string& path, const std::vector<std::string>& lightIds)
+    : file_(std::fopen(path.c_str(), "wb")),
+      lightCount_(lightIds.size()) {
+    if (!file_) {
+        throw std::runtime_error("cannot create " + path);
+    }
+
+    std::vector<uint8_t> ids;
+    for (const std::string& id : lightIds) {
+        size_t length = std::min<size_t>(id.size(), 255);
+        ids.push_back(static_cast<uint8_t>(length));
+        ids.insert(ids.end(), id.begin(), id.begin() + length);
+    }
+
+    std::memset(&header_, 0, sizeof(header_));
+    std::memcpy(header_.magic, "HCAP", 4);
+    header_.version = kCaptureVersion;
+    header_.lightCount = static_cast<uint32_t>(lightCount_);
+    header_.idBytes = static_cast<uint32_t>(ids.size());
+    uint8_t encoded[sizeof(CaptureHeader)];
+    EncodeHeader(header_, encoded);
+    if (std::fwrite(encoded, sizeof(encoded), 1, file_) != 1 ||
+        (!ids.empty() && std::fwrite(ids.data(), ids.size(), 1, file_) != 1)) {
+        std::fclose(file_);
+        throw std::runtime_error("cannot write " + path);
+    }
+    bytes_ = sizeof(header_) + ids.size();
+
+    previous_.assign(lightCount_ * 3, 0);
+    // Worst case: two varints, and a full frame of entries
+    record_.reserve(20);
+    entries_.reserve(lightCount_ * 16);
+    pending_.reserve(kFlushBytes * 2);
+    writer_ = std::thread(&CaptureWriter::RunWriter, this);
+}
+
+CaptureWriter::~CaptureWriter() {
+    Close();
+}
+
+void CaptureWriter::Record(int64_t timeNs, const float* rgb, size_t lightCount) {
+    if (lightCount != lightCount_) {
+        skippedFrames_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Dropped before encoding, so previous_ still holds the last recorded
+    // frame and the next one is diffed against what the file has
+    if (pendingBytes_.load(std::memory_order_relaxed) >= kMaxPendingBytes) {
+        droppedFrames_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    bool first = frames_.load(std::memory_order_relaxed) == 0;
+    if (first) {
+        header_.startNs = timeNs;
+    }
+    // Deltas come from absolute times so rounding never accumulates
+    int64_t us = std::max<int64_t>((timeNs - header_.startNs) / 1000, lastUs_);
+
+    // Entries first: the record starts with their count
+    entries_.clear();
+    size_t changed = 0;
+    size_t previousSlot = 0;
+    for (size_t slot = 0; slot < lightCount_; ++slot) {
+        uint16_t value[3];
+        bool differs = first;
+        for (size_t c = 0; c < 3; ++c) {
+            value[c] = CaptureQuantize(rgb[slot * 3 + c]);
+            differs = differs || value[c] != previous_[slot * 3 + c];
+        }
+        if (!differs) {
+            continue;
+        }
+        PutVarint(entries_, changed == 0 ? slot : slot - previousSlot - 1);
+        for (size_t c = 0; c < 3; ++c) {
+            PutU16(entries_, value[c]);
+            previous_[slot * 3 + c] = value[c];
+        }
+        previousSlot = slot;
+        ++changed;
+    }
+
+    record_.clear();
+    PutVarint(record_, static_cast<uint64_t>(us - lastUs_));
+    PutVarint(record_, changed);
+    lastUs_ = us;
+    header_.durationUs = static_cast<uint64_t>(us);
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.insert(pending_.end(), record_.begin(), record_.end());
+        pending_.insert(pending_.end(), entries_.begin(), entries_.end());
+        pendingBytes_.store(pending_.size(), std::memory_order_relaxed);
+        wake = pending_.size() >= kFlushBytes;
+    }
+    if (wake) {
+        cv_.notify_one();
+    }
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    changedLights_.fetch_add(changed, std::memory_order_relaxed);
+}
+
+// Swaps the pending buffer out and writes it, so the render thread only
+// ever waits for a memcpy
+void CaptureWriter::RunWriter() {
+    std::vector<uint8_t> writing;
+    writing.reserve(kFlushBytes * 2);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait_for(lock, std::chrono::seconds(1),
+                     [this]() { return stop_ || pending_.size() >= kFlushBytes; });
+        writing.swap(pending_);
+        pendingBytes_.store(0, std::memory_order_relaxed);
+        bool stopping = stop_;
+        lock.unlock();
+
+        if (!writing.empty()) {
+            if (std::fwrite(writing.data(), writing.size(), 1, file_) != 1) {
+                writeError_ = true;
+            }
+            bytes_.fetch_add(writing.size(), std::memory_order_relaxed);
+            writing.clear();
+        }
+
+        lock.lock();
+        if (stopping && pending_.empty()) {
+            return;
+        }
+    }
+}
+
+bool CaptureWriter::Close() {
+    if (closed_) {
+        return !writeError_;
+    }
+    closed_ = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    writer_.join();
+
+    header_.frameCount = frames_.load();
+    uint8_t encoded[sizeof(CaptureHeader)];
+    EncodeHeader(header_, encoded);
+    if (std::fseek(file_, 0, SEEK_SET) != 0 || std::fwrite(encoded, sizeof(encoded), 1, file_) != 1) {
+        writeError_ = true;
+    }
+    if (std::fclose(file_) != 0) {
+        writeError_ = true;
+    }
+    file_ = nullptr;
+    return !writeError_;
+}
+
+CaptureWriter::Summary CaptureWriter::GetSummary() const {
+    Summary summary;
+    summary.frames = frames_.load(std::memory_order_relaxed);
+    summary.skippedFrames = skippedFrames_.load(std::memory_order_relaxed);
+    summary.droppedFrames = droppedFrames_.load(std::memory_order_relaxed);
+    summary.changedLights = changedLights_.load(std::memory_order_relaxed);
+    summary.bytes = bytes_.load(std::memory_order_relaxed);
+    summary.writeError = writeError_.load(std::memory_order_relaxed);
+    return summary;
+}
+
+// ============= CaptureFile =============
+
+CaptureFile::CaptureFile(const std::string& path) {
+#ifdef _WIN32
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    std::fseek(file, 0, SEEK_END);
+    long length = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    owned_.resize(length > 0 ? static_cast<size_t>(length) : 0);
+    size_t read = owned_.empty() ? 0 : std::fread(owned_.data(), 1, owned_.size(), file);
+    std::fclose(file);
+    data_ = owned_.data();
+    size_ = read;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("cannot map " + path);
+        }
+        // Replay reads front to back
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const uint8_t*>(mapping);
+    }
+    close(fd);
+#endif
+
+    if (size_ < sizeof(CaptureHeader) || std::memcmp(data_, "HCAP", 4) != 0) {
+        Unmap();
+        throw std::runtime_error(path + " is not a capture file");
+    }
+    DecodeHeader(data_, header_);
+    if (header_.version != kCaptureVersion || sizeof(CaptureHeader) + header_.idBytes > size_) {
+        Unmap();
+        throw std::runtime_error(path + " has an unsupported capture version");
+    }
+
+    size_t offset = sizeof(CaptureHeader);
+    size_t idsEnd = offset + header_.idBytes;
+    while (lightIds_.size() < header_.lightCount && offset < idsEnd) {
+        size_t length = data_[offset++];
+        length = std::min(length, idsEnd - offset);
+        lightIds_.emplace_back(reinterpret_cast<const char*>(data_ + offset), length);
+        offset += length;
+    }
+    if (lightIds_.size() != header_.lightCount) {
+        Unmap();
+        throw std::runtime_error(path + " has a damaged light table");
+    }
+    framesOffset_ = idsEnd;
+}
+
+CaptureFile::~CaptureFile() {
+    Unmap();
+}
+
+void CaptureFile::Unmap() {
+#ifndef _WIN32
+    if (data_ && size_ > 0) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+// ============= CaptureReader =============
+
+CaptureReader::CaptureReader(const CaptureFile& file)
+    : file_(file),
+      colors_(file.Header().lightCount * 3, 0) {
+    Rewind();
+}
+
+void CaptureReader::Rewind() {
+    offset_ = 0;
+    nextUs_ = 0;
+    frame_ = 0;
+    Peek();
+}
+
+void CaptureReader::Peek() {
+    uint64_t delta = 0;
+    size_t offset = offset_;
+    hasNext_ = GetVarint(file_.Frames(), file_.FrameBytes(), offset, delta);
+    if (hasNext_) {
+        nextUs_ += delta;
+        recordOffset_ = offset;
+    }
+}
+
+bool CaptureReader::Next() {
+    if (!hasNext_) {
+        return false;
+    }
+    const uint8_t* data = file_.Frames();
+    size_t end = file_.FrameBytes();
+    size_t offset = recordOffset_;
+    size_t lightCount = file_.Header().lightCount;
+
+    uint64_t changed = 0;
+    if (!GetVarint(data, end, offset, changed)) {
+        hasNext_ = false;
+        return false;
+    }
+    uint64_t slot = 0;
+    for (uint64_t i = 0; i < changed; ++i) {
+        uint64_t gap = 0;
+        if (!GetVarint(data, end, offset, gap) || end - offset < 6) {
+            hasNext_ = false;
+            return false;
+        }
+        slot = i == 0 ? gap : slot + gap + 1;
+        if (slot >= lightCount) {
+            hasNext_ = false;
+            return false;
+        }
+        for (size_t c = 0; c < 3; ++c) {
+            colors_[slot * 3 + c] = static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+            offset += 2;
+        }
+    }
+
+    offset_ = offset;
+    ++frame_;
+    Peek();
+    return true;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Binary capture of the streamed output, compact enough for hours of 60 Hz
+// and laid out so it can be replayed straight from a memory mapping. All
+// integers are little-endian.
+//
+//   Header      64 bytes, see CaptureHeader
+//   Light ids   lightCount x { uint8 length, length bytes }
+//   Frames      one record per rendered frame:
+//                 varint  microseconds since the previous frame
+//                 varint  number of lights that changed
+//                 changed x { varint slot gap, uint16 r, g, b }
+//
+// A slot gap is the distance to the previous changed slot minus one (the
+// first one is the slot itself). Colors are 0-65535 fixed point, the
+// resolution the bridge receives. The first frame lists every light.
+// frameCount and durationUs are filled in when the capture is closed; a
+// capture cut short by a crash is read up to its last complete frame.
+//
+// The header is stored field by field at the offsets of CaptureHeader's
+// members (4, 8, 12, 16, 24, 32, reserved from 40), not copied as a struct.
+struct CaptureHeader {
+    char magic[4];        // "HCAP"
+    uint32_t version;
+    uint32_t lightCount;
+    uint32_t idBytes;     // size of the light id table
+    int64_t startNs;      // StatsNowNs() of the first frame
+    uint64_t frameCount;
+    uint64_t durationUs;  // time of the last frame after the first
+    uint8_t reserved[24];
+};
+static_assert(sizeof(CaptureHeader) == 64, "capture header layout");
+
+const uint32_t kCaptureVersion = 1;
+
+// 0-1 to capture fixed point
+inline uint16_t CaptureQuantize(double value) {
+    return static_cast<uint16_t>((value <= 0.0 ? 0.0 : value >= 1.0 ? 1.0 : value) * 65535.0 + 0.5);
+}
+
+// Writes a capture from the render thread. Record() only encodes into a
+// memory buffer; a writer thread hands full buffers to the file, so disk
+// latency never reaches the render tick. If the disk falls so far behind
+// that kMaxPendingBytes are waiting, frames are dropped (and counted) until
+// it catches up; the next recorded frame carries every change since.
+class CaptureWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created
+    CaptureWriter(const std::string& path, const std::vector<std::string>& lightIds);
+    ~CaptureWriter();
+
+    // Render thread. rgb holds 3 values (0-1) per light, in constructor
+    // order; frames with another light count are skipped.
+    void Record(int64_t timeNs, const float* rgb, size_t lightCount);
+    // Flushes everything and completes the header; false on a write error
+    bool Close();
+
+    struct Summary {
+        uint64_t frames = 0;
+        uint64_t skippedFrames = 0;
+        uint64_t droppedFrames = 0;  // not recorded while the disk was behind
+        uint64_t changedLights = 0;  // light entries written
+        uint64_t bytes = 0;          // file size so far
+        bool writeError = false;
+    };
+    Summary GetSummary() const;
+
+private:
+    void RunWriter();
+
+    std::FILE* file_;
+    size_t lightCount_;
+    CaptureHeader header_;
+
+    // Render thread only
+    std::vector<uint16_t> previous_;
+    std::vector<uint8_t> record_;   // time and count of the current frame
+    std::vector<uint8_t> entries_;  // its changed lights
+    int64_t lastUs_ = 0;
+
+    std::mutex mutex_;  // guards pending_ and stop_
+    std::condition_variable cv_;
+    std::vector<uint8_t> pending_;
+    std::atomic<size_t> pendingBytes_{0};  // pending_.size(), read without the lock
+    bool stop_ = false;
+    std::thread writer_;
+    bool closed_ = false;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> skippedFrames_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::atomic<uint64_t> changedLights_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<bool> writeError_{false};
+};
+
+// Read-only view of a capture file, memory-mapped where the platform allows
+class CaptureFile {
+public:
+    // Throws std::runtime_error if the file is missing or not a capture
+    explicit CaptureFile(const std::string& path);
+    ~CaptureFile();
+    CaptureFile(const CaptureFile&) = delete;
+    CaptureFile& operator=(const CaptureFile&) = delete;
+
+    const CaptureHeader& Header() const { return header_; }
+    const std::vector<std::string>& LightIds() const { return lightIds_; }
+    const uint8_t* Frames() const { return data_ + framesOffset_; }
+    size_t FrameBytes() const { return size_ - framesOffset_; }
+
+private:
+    void Unmap();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<uint8_t> owned_;  // file contents where mmap is not available
+    CaptureHeader header_;
+    std::vector<std::string> lightIds_;
+    size_t framesOffset_ = 0;
+};
+
+// Decodes the frame records of a CaptureFile in order
+class CaptureReader {
+public:
+    explicit CaptureReader(const CaptureFile& file);
+
+    // Back to before the first frame. Colors() keeps its values until the
+    // first frame, which lists every light, replaces them.
+    void Rewind();
+    bool AtEnd() const { return !hasNext_; }
+    // Time of the next frame after the first, valid unless AtEnd()
+    uint64_t NextTimeUs() const { return nextUs_; }
+    // Applies the next frame to Colors(); false at the end
+    bool Next();
+    // 3 fixed-point values per light, in the file's light order
+    const std::vector<uint16_t>& Colors() const { return colors_; }
+    uint64_t FrameIndex() const { return frame_; }
+
+private:
+    // Reads the next record's time; clears hasNext_ on a truncated record
+    void Peek();
+
+    const CaptureFile& file_;
+    size_t offset_ = 0;
+    size_t recordOffset_ = 0;  // start of the record after the time field
+    uint64_t nextUs_ = 0;
+    uint64_t frame_ = 0;
+    bool hasNext_ = false;
+    std::vector<uint16_t> colors_;
+};
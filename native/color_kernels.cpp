@@ -0,0 +1,346 @@
+#include "color_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HUE_KERNELS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HUE_KERNELS_SSE2 1
+#endif
+
+namespace {
+
+// ============= Vector Types =============
+// Each type wraps one register of floats behind the same small set of
+// operations, so the kernels below are written once as templates and
+// instantiated for the SIMD width and for the scalar tail.
+
+struct Scalar {
+    static const size_t kWidth = 1;
+    float v;
+    Scalar(float x) : v(x) {}
+};
+
+inline Scalar operator+(Scalar a, Scalar b) { return a.v + b.v; }
+inline Scalar operator-(Scalar a, Scalar b) { return a.v - b.v; }
+inline Scalar operator*(Scalar a, Scalar b) { return a.v * b.v; }
+inline Scalar operator/(Scalar a, Scalar b) { return a.v / b.v; }
+inline Scalar Min(Scalar a, Scalar b) { return std::min(a.v, b.v); }
+inline Scalar Max(Scalar a, Scalar b) { return std::max(a.v, b.v); }
+inline Scalar Floor(Scalar a) { return std::floor(a.v); }
+inline bool Less(Scalar a, Scalar b) { return a.v < b.v; }
+inline bool And(bool a, bool b) { return a && b; }
+inline Scalar Select(bool mask, Scalar a, Scalar b) { return mask ? a : b; }
+inline Scalar Log2(Scalar a) { return std::log2(a.v); }
+inline Scalar Exp2(Scalar a) { return std::exp2(a.v); }
+inline Scalar Load(const float* p, Scalar*) { return *p; }
+inline void Store(float* p, Scalar a) { *p = a.v; }
+
+// log2(1 + x) / x and 2^x on [0, 1); least-squares fits, error < 5e-6
+template <typename V>
+V Log2Mantissa(V x) {
+    V p = -0.026061798f;
+    p = p * x + 0.121902014f;
+    p = p * x - 0.277352926f;
+    p = p * x + 0.456888664f;
+    p = p * x - 0.717897279f;
+    p = p * x + 1.442516960f;
+    return p * x;
+}
+
+template <typename V>
+V Exp2Fraction(V x) {
+    V p = 0.001894384f;
+    p = p * x + 0.008940602f;
+    p = p * x + 0.055876507f;
+    p = p * x + 0.240131728f;
+    p = p * x + 0.693156767f;
+    return p * x + 0.999999770f;
+}
+
+#if defined(HUE_KERNELS_AVX2)
+
+const char* const kIsa = "avx2";
+
+struct Simd {
+    static const size_t kWidth = 8;
+    __m256 v;
+    Simd(__m256 x) : v(x) {}
+    Simd(float x) : v(_mm256_set1_ps(x)) {}
+};
+
+inline Simd operator+(Simd a, Simd b) { return _mm256_add_ps(a.v, b.v); }
+inline Simd operator-(Simd a, Simd b) { return _mm256_sub_ps(a.v, b.v); }
+inline Simd operator*(Simd a, Simd b) { return _mm256_mul_ps(a.v, b.v); }
+inline Simd operator/(Simd a, Simd b) { return _mm256_div_ps(a.v, b.v); }
+inline Simd Min(Simd a, Simd b) { return _mm256_min_ps(a.v, b.v); }
+inline Simd Max(Simd a, Simd b) { return _mm256_max_ps(a.v, b.v); }
+inline Simd Floor(Simd a) { return _mm256_floor_ps(a.v); }
+inline Simd Less(Simd a, Simd b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline Simd And(Simd a, Simd b) { return _mm256_and_ps(a.v, b.v); }
+inline Simd Select(Simd mask, Simd a, Simd b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+inline Simd Load(const float* p, Simd*) { return _mm256_loadu_ps(p); }
+inline void Store(float* p, Simd a) { _mm256_storeu_ps(p, a.v); }
+
+inline Simd Log2(Simd a) {
+    __m256i bits = _mm256_castps_si256(a.v);
+    __m256 exponent = _mm256_cvtepi32_ps(
+        _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+    __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFF)), _mm256_set1_epi32(0x3F800000)));
+    return Simd(exponent) + Log2Mantissa(Simd(mantissa) - 1.0f);
+}
+
+inline Simd Exp2(Simd a) {
+    Simd x = Min(Max(a, -126.0f), 127.0f);
+    Simd whole = Floor(x);
+    __m256i scale = _mm256_slli_epi32(
+        _mm256_add_epi32(_mm256_cvtps_epi32(whole.v), _mm256_set1_epi32(127)), 23);
+    return Exp2Fraction(x - whole) * Simd(_mm256_castsi256_ps(scale));
+}
+
+#elif defined(HUE_KERNELS_SSE2)
+
+const char* const kIsa = "sse2";
+
+struct Simd {
+    static const size_t kWidth = 4;
+    __m128 v;
+    Simd(__m128 x) : v(x) {}
+    Simd(float x) : v(_mm_set1_ps(x)) {}
+};
+
+inline Simd operator+(Simd a, Simd b) { return _mm_add_ps(a.v, b.v); }
+inline Simd operator-(Simd a, Simd b) { return _mm_sub_ps(a.v, b.v); }
+inline Simd operator*(Simd a, Simd b) { return _mm_mul_ps(a.v, b.v); }
+inline Simd operator/(Simd a, Simd b) { return _mm_div_ps(a.v, b.v); }
+inline Simd Min(Simd a, Simd b) { return _mm_min_ps(a.v, b.v); }
+inline Simd Max(Simd a, Simd b) { return _mm_max_ps(a.v, b.v); }
+inline Simd Less(Simd a, Simd b) { return _mm_cmplt_ps(a.v, b.v); }
+inline Simd And(Simd a, Simd b) { return _mm_and_ps(a.v, b.v); }
+inline Simd Select(Simd mask, Simd a, Simd b) {
+    return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+inline Simd Load(const float* p, Simd*) { return _mm_loadu_ps(p); }
+inline void Store(float* p, Simd a) { _mm_storeu_ps(p, a.v); }
+
+// SSE2 has no round-down; truncate and step back where that rounded up
+inline Simd Floor(Simd a) {
+    Simd truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return truncated - And(Less(a, truncated), 1.0f);
+}
+
+inline Simd Log2(Simd a) {
+    __m128i bits = _mm_castps_si128(a.v);
+    __m128 exponent = _mm_cvtepi32_ps(
+        _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(
+        _mm_and_si128(bits, _mm_set1_epi32(0x7FFFFF)), _mm_set1_epi32(0x3F800000)));
+    return Simd(exponent) + Log2Mantissa(Simd(mantissa) - 1.0f);
+}
+
+inline Simd Exp2(Simd a) {
+    Simd x = Min(Max(a, -126.0f), 127.0f);
+    Simd whole = Floor(x);
+    __m128i scale = _mm_slli_epi32(
+        _mm_add_epi32(_mm_cvtps_epi32(whole.v), _mm_set1_epi32(127)), 23);
+    return Exp2Fraction(x - whole) * Simd(_mm_castsi128_ps(scale));
+}
+
+#else
+
+const char* const kIsa = "scalar";
+
+typedef Scalar Simd;
+
+#endif
+
+// Strided access for interleaved channels; a stride of 0 broadcasts p[0]
+template <typename V>
+V Gather(const float* p, size_t stride) {
+    alignas(32) float lanes[V::kWidth];
+    for (size_t i = 0; i < V::kWidth; ++i) {
+        lanes[i] = p[i * stride];
+    }
+    return Load(lanes, static_cast<V*>(nullptr));
+}
+
+template <typename V>
+void Scatter(float* p, size_t stride, V value) {
+    alignas(32) float lanes[V::kWidth];
+    Store(lanes, value);
+    for (size_t i = 0; i < V::kWidth; ++i) {
+        p[i * stride] = lanes[i];
+    }
+}
+
+template <typename V>
+V Clamp(V x, float lo, float hi) {
+    return Min(Max(x, lo), hi);
+}
+
+template <typename V>
+V Pow(V base, V exponent) {
+    return Exp2(exponent * Log2(Max(base, 1e-30f)));
+}
+
+// ============= Kernels =============
+// Each processes whole vectors from index i and returns where it stopped,
+// so the caller can finish the remainder with the Scalar instantiation.
+
+template <typename V>
+size_t Lerp(const float* a, size_t aStride, const float* b, size_t bStride,
+            const float* t, size_t tStride, float* out, size_t i, size_t count) {
+    for (; i + V::kWidth <= count; i += V::kWidth) {
+        V factor = Gather<V>(t + i * tStride, tStride);
+        for (size_t c = 0; c < 3; ++c) {
+            V from = Gather<V>(a + i * aStride + c, aStride);
+            V to = Gather<V>(b + i * bStride + c, bStride);
+            Scatter(out + i * 3 + c, 3, from + (to - from) * factor);
+        }
+    }
+    return i;
+}
+
+// Branch-free form of the sector switch in hsvToRgb(): channel n (5, 3, 1
+// for r, g, b) is v - v * s * clamp(min(k, 4 - k), 0, 1), k = (n + 6h) mod 6
+template <typename V>
+size_t HsvToRgb(const float* hsv, float* rgb, size_t i, size_t count) {
+    static const float kOffsets[3] = {5.0f, 3.0f, 1.0f};
+    for (; i + V::kWidth <= count; i += V::kWidth) {
+        V h = Gather<V>(hsv + i * 3, 3);
+        V s = Gather<V>(hsv + i * 3 + 1, 3);
+        V v = Gather<V>(hsv + i * 3 + 2, 3);
+        V h6 = (h - Floor(h)) * 6.0f;
+        for (size_t c = 0; c < 3; ++c) {
+            V k = h6 + kOffsets[c];
+            k = k - Floor(k * (1.0f / 6.0f)) * 6.0f;
+            V ramp = Clamp(Min(k, V(4.0f) - k), 0.0f, 1.0f);
+            Scatter(rgb + i * 3 + c, 3, (v - v * s * ramp) * 255.0f);
+        }
+    }
+    return i;
+}
+
+// Hue gamut C corners, counter-clockwise
+const float kRedX = 0.6915f, kRedY = 0.3083f;
+const float kGreenX = 0.17f, kGreenY = 0.7f;
+const float kBlueX = 0.1532f, kBlueY = 0.0475f;
+
+// Which side of edge A->B the point is on; >= 0 means inside for CCW edges
+template <typename V>
+V EdgeSide(V x, V y, float ax, float ay, float bx, float by) {
+    return (y - ay) * (bx - ax) - (x - ax) * (by - ay);
+}
+
+// Closest point to (x, y) on segment A->B; dist2 receives the squared distance
+template <typename V>
+void ClosestOnEdge(V x, V y, float ax, float ay, float bx, float by, V& outX, V& outY, V& dist2) {
+    float dx = bx - ax;
+    float dy = by - ay;
+    V t = Clamp(((x - ax) * dx + (y - ay) * dy) * (1.0f / (dx * dx + dy * dy)), 0.0f, 1.0f);
+    outX = t * dx + ax;
+    outY = t * dy + ay;
+    V ex = x - outX;
+    V ey = y - outY;
+    dist2 = ex * ex + ey * ey;
+}
+
+template <typename V>
+V Linearize(V c) {
+    return Select(Less(V(0.04045f), c), Pow((c + 0.055f) * (1.0f / 1.055f), V(2.4f)), c * (1.0f / 12.92f));
+}
+
+template <typename V>
+size_t RgbToXy(const float* rgb, float* xyb, size_t i, size_t count) {
+    for (; i + V::kWidth <= count; i += V::kWidth) {
+        V r = Linearize(Clamp(Gather<V>(rgb + i * 3, 3) * (1.0f / 255.0f), 0.0f, 1.0f));
+        V g = Linearize(Clamp(Gather<V>(rgb + i * 3 + 1, 3) * (1.0f / 255.0f), 0.0f, 1.0f));
+        V b = Linearize(Clamp(Gather<V>(rgb + i * 3 + 2, 3) * (1.0f / 255.0f), 0.0f, 1.0f));
+
+        // Wide gamut D65 conversion used by the Hue API
+        V X = r * 0.664511f + g * 0.154324f + b * 0.162028f;
+        V Y = r * 0.283881f + g * 0.668433f + b * 0.047685f;
+        V Z = r * 0.000088f + g * 0.072310f + b * 0.986039f;
+        V sum = X + Y + Z;
+        // Black has no chromaticity; use the D65 white point
+        auto lit = Less(V(1e-6f), sum);
+        V x = Select(lit, X / Max(sum, 1e-6f), V(0.3127f));
+        V y = Select(lit, Y / Max(sum, 1e-6f), V(0.3290f));
+
+        auto inside = And(And(Less(V(-1e-7f), EdgeSide(x, y, kRedX, kRedY, kGreenX, kGreenY)),
+                           Less(V(-1e-7f), EdgeSide(x, y, kGreenX, kGreenY, kBlueX, kBlueY))),
+                       Less(V(-1e-7f), EdgeSide(x, y, kBlueX, kBlueY, kRedX, kRedY)));
+
+        V bestX = 0.0f, bestY = 0.0f, best = 0.0f;
+        V edgeX = 0.0f, edgeY = 0.0f, dist = 0.0f;
+        ClosestOnEdge(x, y, kRedX, kRedY, kGreenX, kGreenY, bestX, bestY, best);
+        ClosestOnEdge(x, y, kGreenX, kGreenY, kBlueX, kBlueY, edgeX, edgeY, dist);
+        auto closer = Less(dist, best);
+        bestX = Select(closer, edgeX, bestX);
+        bestY = Select(closer, edgeY, bestY);
+        best = Select(closer, dist, best);
+        ClosestOnEdge(x, y, kBlueX, kBlueY, kRedX, kRedY, edgeX, edgeY, dist);
+        closer = Less(dist, best);
+        bestX = Select(closer, edgeX, bestX);
+        bestY = Select(closer, edgeY, bestY);
+
+        Scatter(xyb + i * 3, 3, Select(inside, x, bestX));
+        Scatter(xyb + i * 3 + 1, 3, Select(inside, y, bestY));
+        Scatter(xyb + i * 3 + 2, 3, Clamp(Y, 0.0f, 1.0f));
+    }
+    return i;
+}
+
+template <typename V>
+size_t Gamma(const float* in, float* out, size_t i, size_t size, float gamma) {
+    for (; i + V::kWidth <= size; i += V::kWidth) {
+        V x = Clamp(Load(in + i, static_cast<V*>(nullptr)) * (1.0f / 255.0f), 0.0f, 1.0f);
+        Store(out + i, Pow(x, V(gamma)) * 255.0f);
+    }
+    return i;
+}
+
+template <typename V>
+size_t Scale(const float* in, float* out, size_t i, size_t size, float scale) {
+    for (; i + V::kWidth <= size; i += V::kWidth) {
+        Store(out + i, Clamp(Load(in + i, static_cast<V*>(nullptr)) * scale, 0.0f, 255.0f));
+    }
+    return i;
+}
+
+}  // namespace
+
+const char* ColorKernelIsa() {
+    return kIsa;
+}
+
+void BatchLerp(const float* a, size_t aStride, const float* b, size_t bStride,
+               const float* t, size_t tStride, float* out, size_t count) {
+    size_t i = Lerp<Simd>(a, aStride, b, bStride, t, tStride, out, 0, count);
+    Lerp<Scalar>(a, aStride, b, bStride, t, tStride, out, i, count);
+}
+
+void BatchHsvToRgb(const float* hsv, float* rgb, size_t count) {
+    size_t i = HsvToRgb<Simd>(hsv, rgb, 0, count);
+    HsvToRgb<Scalar>(hsv, rgb, i, count);
+}
+
+void BatchRgbToXy(const float* rgb, float* xyb, size_t count) {
+    size_t i = RgbToXy<Simd>(rgb, xyb, 0, count);
+    RgbToXy<Scalar>(rgb, xyb, i, count);
+}
+
+void BatchGamma(const float* in, float* out, size_t size, float gamma) {
+    size_t i = Gamma<Simd>(in, out, 0, size, gamma);
+    Gamma<Scalar>(in, out, i, size, gamma);
+}
+
+void BatchScale(const float* in, float* out, size_t size, float scale) {
+    size_t i = Scale<Simd>(in, out, 0, size, scale);
+    Scale<Scalar>(in, out, i, size, scale);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+// Batch color math over whole frames stored in float arrays. Colors are
+// interleaved per light (r, g, b, ...) in the same 0-255 units as the JS API.
+// Every kernel may run in place (out == input). The main loop uses AVX2 or
+// SSE2 when the build targets them and a scalar loop otherwise.
+
+// "avx2", "sse2" or "scalar"
+const char* ColorKernelIsa();
+
+// out = a + (b - a) * t per light. aStride and bStride are 3 for one color per
+// light or 0 to use a single color for all lights; tStride is 1 or 0 likewise.
+void BatchLerp(const float* a, size_t aStride, const float* b, size_t bStride,
+               const float* t, size_t tStride, float* out, size_t count);
+
+// hsv holds h, s, v (0-1) per light; writes r, g, b (0-255) like hsvToRgb()
+void BatchHsvToRgb(const float* hsv, float* rgb, size_t count);
+
+// sRGB (0-255) to CIE xy plus brightness (0-1), clipped to the Hue gamut C
+// triangle. The output matches the 'xy' layout of setFrame().
+void BatchRgbToXy(const float* rgb, float* xyb, size_t count);
+
+// Flat over size values in 0-255: out = 255 * (in / 255) ^ gamma
+void BatchGamma(const float* in, float* out, size_t size, float gamma);
+
+// Flat over size values: out = in * scale, clamped to 0-255
+void BatchScale(const float* in, float* out, size_t size, float scale);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// Curve used between a keyframe and the next one on its track, and by timed
+// light transitions
+enum class Easing : uint8_t {
+    Linear = 0,
+    Step = 1,       // hold the keyframe color until the next keyframe
+    EaseIn = 2,
+    EaseOut = 3,
+    EaseInOut = 4
+};
+
+// Progress along the curve for t in 0-1
+inline double Ease(Easing easing, double t) {
+    switch (easing) {
+        case Easing::Step:
+            return 0;
+        case Easing::EaseIn:
+            return t * t;
+        case Easing::EaseOut:
+            return t * (2 - t);
+        case Easing::EaseInOut:
+            return t < 0.5 ? 2 * t * t : 1 - 2 * (1 - t) * (1 - t);
+        case Easing::Linear:
+        default:
+            return t;
+    }
+}
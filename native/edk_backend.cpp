@@ -0,0 +1,187 @@
+#include "edk_backend.h"
+
+#include <chrono>
+#include <future>
+#include <utility>
+
+#include "huestream/common/data/BridgeSettings.h"
+#include "huestream/common/http/BridgeHttpClient.h"
+#include "huestream/common/http/HttpClient.h"
+
+using namespace huestream;
+
+EdkBackend::EdkBackend(const std::string& appName, const std::string& deviceName, bool externalRender) {
+    // Create HueStream config for UDP streaming
+    PersistenceEncryptionKey encKey("default_key");
+    config_ = std::make_shared<Config>(appName, deviceName, encKey);
+
+    // Use DTLS for secure streaming with valid entertainment credentials
+    config_->SetStreamingMode(STREAMING_MODE_DTLS);
+
+    // Either the EDK render thread sends at 60Hz, or the owner calls
+    // RenderFrame() from its own clock
+    config_->GetAppSettings()->SetUseRenderThread(!externalRender);
+    config_->GetStreamSettings()->SetUpdateFrequency(60);
+
+    hueStream_ = std::make_unique<HueStream>(config_);
+    hueStream_->RegisterFeedbackCallback([this](const FeedbackMessage& message) { OnFeedback(message); });
+
+    configRetriever_ = std::make_unique<FullConfigRetriever>(
+        std::make_shared<BridgeHttpClient>(std::make_shared<HttpClient>()));
+}
+
+void EdkBackend::SetEventCallback(BackendEventCallback callback) {
+    std::lock_guard<std::mutex> lock(eventMutex_);
+    eventCallback_ = std::move(callback);
+}
+
+void EdkBackend::OnFeedback(const FeedbackMessage& message) {
+    BackendEvent event;
+    switch (message.GetId()) {
+        case FeedbackMessage::ID_BRIDGE_CONNECTED: event = BackendEvent::BridgeConnected; break;
+        case FeedbackMessage::ID_BRIDGE_DISCONNECTED: event = BackendEvent::BridgeDisconnected; break;
+        case FeedbackMessage::ID_STREAMING_CONNECTED: event = BackendEvent::StreamingStarted; break;
+        case FeedbackMessage::ID_STREAMING_DISCONNECTED: event = BackendEvent::StreamingStopped; break;
+        default: return;
+    }
+    std::lock_guard<std::mutex> lock(eventMutex_);
+    if (eventCallback_) {
+        eventCallback_(event);
+    }
+}
+
+static BridgePtr MakeBridge(const BridgeCredentials& credentials) {
+    auto bridgeSettings = std::make_shared<BridgeSettings>();
+    auto bridge = std::make_shared<Bridge>(credentials.id, credentials.ip, true, bridgeSettings);
+
+    // Set credentials for UDP/DTLS streaming
+    bridge->SetUser(credentials.username);
+    bridge->SetClientKey(credentials.clientKey);
+    return bridge;
+}
+
+bool EdkBackend::Connect(const BridgeCredentials& credentials) {
+    credentials_ = credentials;
+
+    // Connect via EDK (blocking call - waits until ready)
+    hueStream_->ConnectManualBridgeInfo(MakeBridge(credentials));
+
+    // Check connection result
+    auto result = hueStream_->GetConnectionResult();
+    return result == ConnectResult::ReadyToStart || result == ConnectResult::Streaming;
+}
+
+// The bridge arrives with its capabilities, group list and selection filled
+// in, so the EDK skips discovery and group selection and auto-starts the
+// stream as soon as the connection is up
+bool EdkBackend::Resume(const BridgeCredentials& credentials, const WarmStartState& state) {
+    credentials_ = credentials;
+    BridgePtr bridge = MakeBridge(credentials);
+    bridge->SetModelId(state.modelId);
+    bridge->SetApiversion(state.apiVersion);
+    bridge->SetSwversion(state.swVersion);
+    bridge->SetName(state.bridgeName);
+    bridge->SetIsValidIp(true);
+    bridge->SetIsAuthorized(true);
+    auto groups = std::make_shared<GroupList>();
+    groups->push_back(BuildWarmStartGroup(state));
+    bridge->SetGroups(groups);
+    bridge->SetSelectedGroup(state.groupId);
+
+    hueStream_->ConnectManualBridgeInfo(bridge);
+    auto result = hueStream_->GetConnectionResult();
+    return result == ConnectResult::ReadyToStart || result == ConnectResult::Streaming;
+}
+
+// Longest wait for the bridge to answer the full config request
+static const std::chrono::seconds kFetchTimeout(10);
+
+static GroupPtr FindGroup(const BridgePtr& bridge, const std::string& groupId) {
+    auto groups = bridge ? bridge->GetGroups() : nullptr;
+    if (!groups) {
+        return nullptr;
+    }
+    for (const auto& group : *groups) {
+        if (group->GetId() == groupId) {
+            return group;
+        }
+    }
+    return nullptr;
+}
+
+// Asks the bridge itself: the EDK's copy of the configuration is whatever it
+// was handed or read at connect time, which after a warm start is the cache.
+// The config is read into a scratch bridge so the one the EDK streams with
+// is only touched through SelectGroup().
+GroupPtr EdkBackend::FetchGroup(const std::string& groupId) {
+    if (!hueStream_->GetActiveBridge()) {
+        return nullptr;
+    }
+    auto done = std::make_shared<std::promise<BridgePtr>>();
+    std::future<BridgePtr> result = done->get_future();
+    bool started = configRetriever_->Execute(
+        MakeBridge(credentials_),
+        [done](OperationResult status, BridgePtr bridge) {
+            done->set_value(status == OPERATION_SUCCESS ? bridge : nullptr);
+        },
+        [](const FeedbackMessage&) {});
+    if (!started || result.wait_for(kFetchTimeout) != std::future_status::ready) {
+        return nullptr;
+    }
+    GroupPtr fresh = FindGroup(result.get(), groupId);
+    if (!fresh) {
+        return nullptr;
+    }
+
+    GroupPtr current = ActiveGroup();
+    if (!current || !SameTopology(CaptureWarmStart(nullptr, current), CaptureWarmStart(nullptr, fresh))) {
+        // Blocks until the EDK is streaming to the new lights
+        hueStream_->SelectGroup(fresh);
+        return fresh;
+    }
+    return current;
+}
+
+void EdkBackend::SelectGroup(const std::string& groupId) {
+    // Select group via EDK (blocking call - waits until ready)
+    hueStream_->SelectGroup(groupId);
+}
+
+bool EdkBackend::IsStreaming() {
+    return hueStream_->IsBridgeStreaming();
+}
+
+BridgePtr EdkBackend::ActiveBridge() {
+    return hueStream_->GetActiveBridge();
+}
+
+GroupPtr EdkBackend::ActiveGroup() {
+    auto bridge = hueStream_->GetActiveBridge();
+    return bridge ? bridge->GetGroup() : nullptr;
+}
+
+void EdkBackend::AddEffect(const EffectPtr& effect) {
+    hueStream_->AddEffect(effect);
+}
+
+void EdkBackend::LockMixer() {
+    hueStream_->LockMixer();
+}
+
+void EdkBackend::UnlockMixer() {
+    hueStream_->UnlockMixer();
+}
+
+// Without the render thread the EDK renders and sends in two explicit steps
+void EdkBackend::RenderFrame() {
+    hueStream_->RenderSingleFrame();
+    hueStream_->SendRenderedFrame();
+}
+
+void EdkBackend::Stop() {
+    hueStream_->Stop();
+}
+
+void EdkBackend::ShutDown() {
+    hueStream_->ShutDown();
+}
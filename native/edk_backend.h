@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "huestream/HueStream.h"
+#include "huestream/config/Config.h"
+#include "huestream/connect/FullConfigRetriever.h"
+
+#include "stream_backend.h"
+
+// Streams to a real bridge over DTLS through the Hue EDK
+class EdkBackend : public StreamBackend {
+public:
+    EdkBackend(const std::string& appName, const std::string& deviceName, bool externalRender);
+
+    void SetEventCallback(BackendEventCallback callback) override;
+    bool Connect(const BridgeCredentials& credentials) override;
+    void SelectGroup(const std::string& groupId) override;
+    bool Resume(const BridgeCredentials& credentials, const WarmStartState& state) override;
+    huestream::GroupPtr FetchGroup(const std::string& groupId) override;
+    bool IsStreaming() override;
+    huestream::BridgePtr ActiveBridge() override;
+    huestream::GroupPtr ActiveGroup() override;
+    const char* Mode() const override { return "DTLS"; }
+
+    void AddEffect(const huestream::EffectPtr& effect) override;
+    void LockMixer() override;
+    void UnlockMixer() override;
+    void RenderFrame() override;
+
+    void Stop() override;
+    void ShutDown() override;
+
+private:
+    // EDK feedback thread
+    void OnFeedback(const huestream::FeedbackMessage& message);
+
+    // Declared first so they outlive the EDK threads that call into them
+    std::mutex eventMutex_;
+    BackendEventCallback eventCallback_;
+
+    std::shared_ptr<huestream::Config> config_;
+    std::unique_ptr<huestream::HueStream> hueStream_;
+    // Reads the bridge's full config over CLIP for FetchGroup()
+    std::unique_ptr<huestream::FullConfigRetriever> configRetriever_;
+    BridgeCredentials credentials_;
+};
@@ -0,0 +1,582 @@
+#include "effect_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+
+using namespace huestream;
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const Rgb kBlack = {0, 0, 0};
+const Rgb kWhite = {255, 255, 255};
+const Rgb kCountdownMid = {255, 200, 0};  // Yellow/orange transition color
+
+// Matches interpolateColor() in hue-light-control.ts
+Rgb Lerp(const Rgb& a, const Rgb& b, double t) {
+    return {
+        std::round(a.r + (b.r - a.r) * t),
+        std::round(a.g + (b.g - a.g) * t),
+        std::round(a.b + (b.b - a.b) * t)
+    };
+}
+
+Rgb Dim(const Rgb& c, double brightness) {
+    return {
+        std::round(c.r * brightness),
+        std::round(c.g * brightness),
+        std::round(c.b * brightness)
+    };
+}
+
+// Matches hsvToRgb() in hue-light-control.ts
+Rgb HsvToRgb(double h, double s, double v) {
+    int i = static_cast<int>(std::floor(h * 6));
+    double f = h * 6 - i;
+    double p = v * (1 - s);
+    double q = v * (1 - f * s);
+    double t = v * (1 - (1 - f) * s);
+    double r = 0, g = 0, b = 0;
+    switch (((i % 6) + 6) % 6) {
+        case 0: r = v; g = t; b = p; break;
+        case 1: r = q; g = v; b = p; break;
+        case 2: r = p; g = v; b = t; break;
+        case 3: r = p; g = q; b = v; break;
+        case 4: r = t; g = p; b = v; break;
+        case 5: r = v; g = p; b = q; break;
+    }
+    return {std::round(r * 255), std::round(g * 255), std::round(b * 255)};
+}
+
+double Phase(double elapsedMs, double period) {
+    return period > 0 ? std::fmod(elapsedMs, period) / period : 0;
+}
+
+Color ToColor(const Rgb& c) {
+    return Color(std::clamp(c.r, 0.0, 255.0) / 255.0,
+                 std::clamp(c.g, 0.0, 255.0) / 255.0,
+                 std::clamp(c.b, 0.0, 255.0) / 255.0);
+}
+
+void Fill(Rgb* out, size_t count, const Rgb& color) {
+    std::fill(out, out + count, color);
+}
+
+// Position of the lit segment in the bouncing family: 0..3 and back
+int BounceSegment(double cyclePosition) {
+    if (cyclePosition < 0.5) {
+        return static_cast<int>(std::floor(cyclePosition * 8)) % 4;
+    }
+    return 3 - static_cast<int>(std::floor((cyclePosition - 0.5) * 8)) % 4;
+}
+
+// colors[0..1] = color1, color2; period = wave cycle
+class GradientWave : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    double CycleMs() const override { return std::max(params_.period, 0.0); }
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            return false;
+        }
+        double phase = Phase(elapsedMs, params_.period);
+        double span = std::max<double>(1, static_cast<double>(count) - 1);
+        for (size_t i = 0; i < count; ++i) {
+            double wavePos = std::fmod(i / span + phase, 1.0);
+            out[i] = Lerp(PaletteColor(0), PaletteColor(1), wavePos);
+        }
+        return true;
+    }
+};
+
+// colors[0] = ripple color; period = ripple cycle
+class RippleGradient : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    double CycleMs() const override { return std::max(params_.period, 0.0); }
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            return false;
+        }
+        double ripplePhase = Phase(elapsedMs, params_.period);
+        // Distance from the middle light, 0 there and 1 at either end
+        double center = (static_cast<double>(count) - 1) / 2;
+        double reach = std::max(center, 1.0);
+        for (size_t i = 0; i < count; ++i) {
+            double distance = std::abs(i - center) / reach;
+            double brightness = std::max(0.0, 1 - std::abs(ripplePhase - distance));
+            out[i] = Dim(PaletteColor(0), brightness);
+        }
+        return true;
+    }
+};
+
+// colors[0..1] = gradient ends; period = breath cycle
+class BreathingGradient : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    double CycleMs() const override { return std::max(params_.period, 0.0); }
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            return false;
+        }
+        double phase = Phase(elapsedMs, params_.period);
+        double brightness = 0.3 + 0.7 * (std::sin(phase * kPi * 2) * 0.5 + 0.5);
+        double span = std::max<double>(1, static_cast<double>(count) - 1);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = Dim(Lerp(PaletteColor(0), PaletteColor(1), i / span), brightness);
+        }
+        return true;
+    }
+};
+
+// colors[0] = chase color; rate = travel per 16 ms tick (JS "speed")
+class ChaseGradient : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    double CycleMs() const override { return params_.rate > 0 ? 4.0 * 16.0 * 1000.0 / params_.rate : 0; }
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            return false;
+        }
+        double position = std::fmod(elapsedMs / 16.0 * (params_.rate / 1000.0), 4.0);
+        for (size_t i = 0; i < count; ++i) {
+            double distance = std::min({std::abs(i - position),
+                                        std::abs(i - position + 4),
+                                        std::abs(i - position - 4)});
+            out[i] = Dim(PaletteColor(0), std::max(0.0, 1 - distance * 0.4));
+        }
+        return true;
+    }
+};
+
+// period = hue rotation time
+class RainbowWave : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    double CycleMs() const override { return std::max(params_.period, 0.0); }
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            return false;
+        }
+        double hueShift = Phase(elapsedMs, params_.period);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = HsvToRgb(std::fmod(hueShift + i * 0.25, 1.0), 1, 1);
+        }
+        return true;
+    }
+};
+
+// colors[0..1] = pulse ends; period = pulse cycle
+class PulseWave : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    double CycleMs() const override { return std::max(params_.period, 0.0); }
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            return false;
+        }
+        double phase = Phase(elapsedMs, params_.period);
+        for (size_t i = 0; i < count; ++i) {
+            double segPhase = std::fmod(phase + i * 0.25, 1.0);
+            double pulseFactor = std::pow(std::sin(segPhase * kPi), 2);
+            out[i] = Lerp(PaletteColor(0), PaletteColor(1), pulseFactor);
+        }
+        return true;
+    }
+};
+
+// Shared countdown logic: three color stages, quickening pulse, then a
+// 200 ms white flash before settling on the end color
+class CountdownBase : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        double totalMs = params_.period;
+        if (elapsedMs > totalMs) {
+            if (elapsedMs <= totalMs + 200) {
+                Fill(out, count, kWhite);
+                return true;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = EndColor(i);
+            }
+            return false;
+        }
+
+        double timeLeft = 1 - (elapsedMs / totalMs);
+        for (size_t i = 0; i < count; ++i) {
+            Rgb color;
+            if (timeLeft > 0.66) {
+                color = StartColor(i);
+            } else if (timeLeft > 0.33) {
+                color = Lerp(StartColor(i), kCountdownMid, (0.66 - timeLeft) * 3);
+            } else {
+                color = Lerp(kCountdownMid, EndColor(i), (0.33 - timeLeft) * 3);
+            }
+            out[i] = Dim(color, Brightness(elapsedMs, timeLeft, i));
+        }
+        return true;
+    }
+
+protected:
+    virtual Rgb StartColor(size_t index) const = 0;
+    virtual Rgb EndColor(size_t index) const = 0;
+    virtual double Brightness(double elapsedMs, double timeLeft, size_t index) const = 0;
+};
+
+// colors[0..1] = start, end; period = total countdown in ms
+class CountdownPulse : public CountdownBase {
+public:
+    using CountdownBase::CountdownBase;
+
+protected:
+    Rgb StartColor(size_t) const override { return PaletteColor(0); }
+    Rgb EndColor(size_t) const override { return PaletteColor(1); }
+    double Brightness(double elapsedMs, double timeLeft, size_t) const override {
+        double pulseSpeed = 2000 * timeLeft + 200;
+        return 0.2 + 0.8 * std::sin(Phase(elapsedMs, pulseSpeed) * kPi);
+    }
+};
+
+// colors = start/end pairs per segment; period = total countdown in ms
+class SegmentedCountdownPulse : public CountdownBase {
+public:
+    using CountdownBase::CountdownBase;
+
+protected:
+    Rgb StartColor(size_t index) const override { return PaletteColor(index * 2); }
+    Rgb EndColor(size_t index) const override { return PaletteColor(index * 2 + 1); }
+    double Brightness(double elapsedMs, double timeLeft, size_t index) const override {
+        double phaseOffset = (index * 0.33) * kPi;
+        double pulseSpeed = 2000 * timeLeft + 200;
+        return 0.2 + 0.8 * std::sin((Phase(elapsedMs, pulseSpeed) + phaseOffset) * kPi);
+    }
+};
+
+// colors[0] = flash color; period = fade duration
+class FlashColor : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        double steps = std::floor(params_.period / 16);
+        double step = std::floor(elapsedMs / 16);
+        if (step >= steps) {
+            Fill(out, count, kBlack);
+            return false;
+        }
+        double brightness = std::pow(1 - step / steps, 2);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = Dim(PaletteColor(0), std::max(0.0, brightness - i * 0.1));
+        }
+        return true;
+    }
+};
+
+// colors[0] = starting color; period = fade duration
+class FadeToBlack : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (elapsedMs >= params_.period) {
+            Fill(out, count, kBlack);
+            return false;
+        }
+        Fill(out, count, Dim(PaletteColor(0), 1 - elapsedMs / params_.period));
+        return true;
+    }
+};
+
+// colors[0..1] = color by position; period = bounce cycle; rate = pulse
+// cycle (0 = steady brightness)
+class BouncingWave : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            Fill(out, count, kBlack);
+            return false;
+        }
+        int activeSegment = BounceSegment(Phase(elapsedMs, params_.period));
+        double brightness = params_.rate > 0
+            ? 0.5 + 0.5 * std::sin(Phase(elapsedMs, params_.rate) * kPi * 2)
+            : 1.0;
+        double span = std::max<double>(1, static_cast<double>(count) - 1);
+        for (size_t i = 0; i < count; ++i) {
+            if (static_cast<int>(i) == activeSegment) {
+                out[i] = Dim(Lerp(PaletteColor(0), PaletteColor(1), i / span), brightness);
+            } else {
+                out[i] = kBlack;
+            }
+        }
+        return true;
+    }
+};
+
+// colors[0..1] = first and second wave; period = bounce cycle
+class DoubleBounce : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (Expired(elapsedMs)) {
+            Fill(out, count, kBlack);
+            return false;
+        }
+        double cyclePosition = Phase(elapsedMs, params_.period);
+        int wave1 = BounceSegment(cyclePosition);
+        int wave2 = cyclePosition < 0.5
+            ? 3 - static_cast<int>(std::floor(cyclePosition * 8)) % 4
+            : static_cast<int>(std::floor((cyclePosition - 0.5) * 8)) % 4;
+        for (size_t i = 0; i < count; ++i) {
+            int index = static_cast<int>(i);
+            if (index == wave2) {
+                out[i] = Dim(PaletteColor(1), index == wave1 ? 1.0 : 0.8);
+            } else if (index == wave1) {
+                out[i] = PaletteColor(0);
+            } else {
+                out[i] = kBlack;
+            }
+        }
+        return true;
+    }
+};
+
+// colors[0] = strobe color; period = total duration; rate = toggle interval
+class StrobeLight : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (elapsedMs >= params_.period) {
+            Fill(out, count, kBlack);
+            return false;
+        }
+        double interval = params_.rate > 0 ? params_.rate : 50;
+        bool on = static_cast<long long>(std::floor(elapsedMs / interval)) % 2 == 0;
+        Fill(out, count, on ? PaletteColor(0) : kBlack);
+        return true;
+    }
+};
+
+// colors[0..1] = spiral ends; period = duration (three rotations)
+class SpiralVortex : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (elapsedMs > params_.period) {
+            return false;
+        }
+        double rotation = (elapsedMs / params_.period) * 3 * kPi * 2;
+        double depthFactor = std::sin(elapsedMs * 0.003) * 0.3 + 0.7;
+        for (size_t i = 0; i < count; ++i) {
+            double angle = rotation + (i * kPi * 2 / count);
+            double intensity = (std::sin(angle) + 1) / 2;
+            Rgb color = Lerp(PaletteColor(0), PaletteColor(1), intensity);
+            out[i] = {color.r * depthFactor, color.g * depthFactor, color.b * depthFactor};
+        }
+        return true;
+    }
+};
+
+// colors[0] = wave color; period = duration
+class Shockwave : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (elapsedMs > params_.period) {
+            return false;
+        }
+        double progress = elapsedMs / params_.period;
+        double wavePosition = progress * (count + 1);
+        for (size_t i = 0; i < count; ++i) {
+            double distance = std::abs(i - wavePosition);
+            double intensity = distance < 1 ? (1 - distance) * (1 - progress) : 0;
+            Rgb color = PaletteColor(0);
+            out[i] = {color.r * intensity, color.g * intensity, color.b * intensity};
+        }
+        return true;
+    }
+};
+
+// colors[0] = burst color; period = duration
+class EnergyBurst : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (elapsedMs > params_.period) {
+            return false;
+        }
+        double progress = elapsedMs / params_.period;
+        double intensity;
+        if (progress < 0.1) {
+            intensity = 1.3;  // Over-brightness for the initial burst
+        } else if (progress < 0.3) {
+            intensity = 0.9;
+        } else {
+            intensity = std::max(0.0, 1 - ((progress - 0.3) / 0.7) * 1.5);
+        }
+        Rgb color = PaletteColor(0);
+        Fill(out, count, {std::min(255.0, color.r * intensity),
+                          std::min(255.0, color.g * intensity),
+                          std::min(255.0, color.b * intensity)});
+        return true;
+    }
+};
+
+typedef std::function<std::unique_ptr<NativeEffect>(const EffectParams&)> EffectFactory;
+
+template <typename T>
+EffectFactory Factory() {
+    return [](const EffectParams& params) { return std::unique_ptr<NativeEffect>(new T(params)); };
+}
+
+const std::map<std::string, EffectFactory>& Registry() {
+    static const std::map<std::string, EffectFactory> registry = {
+        {"gradientWave", Factory<GradientWave>()},
+        {"rippleGradient", Factory<RippleGradient>()},
+        {"breathingGradient", Factory<BreathingGradient>()},
+        {"chaseGradient", Factory<ChaseGradient>()},
+        {"rainbowWave", Factory<RainbowWave>()},
+        {"pulseWave", Factory<PulseWave>()},
+        {"countdownPulse", Factory<CountdownPulse>()},
+        {"segmentedCountdownPulse", Factory<SegmentedCountdownPulse>()},
+        {"flashColor", Factory<FlashColor>()},
+        {"fadeToBlack", Factory<FadeToBlack>()},
+        {"bouncingWave", Factory<BouncingWave>()},
+        {"doubleBounce", Factory<DoubleBounce>()},
+        {"strobeLight", Factory<StrobeLight>()},
+        {"spiralVortex", Factory<SpiralVortex>()},
+        {"shockwave", Factory<Shockwave>()},
+        {"energyBurst", Factory<EnergyBurst>()},
+    };
+    return registry;
+}
+
+}  // namespace
+
+Rgb NativeEffect::PaletteColor(size_t index) const {
+    if (index < params_.colors.size()) {
+        return params_.colors[index];
+    }
+    return params_.colors.empty() ? kBlack : params_.colors.back();
+}
+
+std::unique_ptr<NativeEffect> CreateNativeEffect(const std::string& name, const EffectParams& params) {
+    auto it = Registry().find(name);
+    if (it == Registry().end()) {
+        return nullptr;
+    }
+    return it->second(params);
+}
+
+// ============= EngineEffect =============
+
+EngineEffect::EngineEffect(const std::string& name, unsigned int layer, std::shared_ptr<FrameEffect> baseLayer,
+                           StreamStats* stats)
+    : Effect(name, layer),
+      baseLayer_(std::move(baseLayer)),
+      stats_(stats) {
+}
+
+void EngineEffect::Run(std::unique_ptr<NativeEffect> effect, const std::vector<int>& lightIds, double startMs) {
+    effect_ = std::move(effect);
+    lightIds_.clear();
+    for (int id : lightIds) {
+        lightIds_.push_back(std::to_string(id));
+    }
+    frame_.assign(lightIds_.size(), kBlack);
+    slotCache_.Clear();
+    ResolveLuts();
+    std::chrono::duration<double, std::milli> offset(std::max(startMs, 0.0));
+    startTime_ = std::chrono::steady_clock::now() -
+                 std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+    active_.store(true, std::memory_order_release);
+    Enable();
+}
+
+bool EngineEffect::GetParams(EffectParams& params) const {
+    if (!effect_) {
+        return false;
+    }
+    params = effect_->GetParams();
+    return true;
+}
+
+bool EngineEffect::SetParams(const EffectParams& params) {
+    if (!effect_) {
+        return false;
+    }
+    effect_->SetParams(params);
+    return true;
+}
+
+void EngineEffect::SetCorrector(std::shared_ptr<const OutputCorrector> corrector) {
+    corrector_ = std::move(corrector);
+    ResolveLuts();
+}
+
+void EngineEffect::ResolveLuts() {
+    luts_.assign(lightIds_.size(), nullptr);
+    if (corrector_) {
+        for (size_t i = 0; i < lightIds_.size(); ++i) {
+            luts_[i] = corrector_->ForId(lightIds_[i]);
+        }
+    }
+}
+
+void EngineEffect::Halt() {
+    if (effect_) {
+        HandOff();
+    }
+}
+
+bool EngineEffect::Seek(double timeMs) {
+    if (!effect_) {
+        return false;
+    }
+    std::chrono::duration<double, std::milli> offset(std::max(timeMs, 0.0));
+    startTime_ = std::chrono::steady_clock::now() -
+                 std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+    return true;
+}
+
+void EngineEffect::Render() {
+    if (!effect_) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - startTime_).count();
+    if (!effect_->Render(elapsedMs, frame_.data(), frame_.size())) {
+        HandOff();
+    }
+    if (stats_) {
+        stats_->OnLayerRender(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - now).count()));
+    }
+}
+
+Color EngineEffect::GetColor(LightPtr light) {
+    int slot = slotCache_.Find(light, lightIds_);
+    if (slot >= 0) {
+        return OutputCorrector::Apply(luts_[slot], ToColor(frame_[slot]));
+    }
+    // Lights outside the effect are left to the layers below
+    return Color(0, 0, 0, 0);
+}
+
+std::string EngineEffect::GetTypeName() const {
+    return "hue_edk.EngineEffect";
+}
+
+// Leaves the last frame on the manual layer and steps out of the mix
+void EngineEffect::HandOff() {
+    if (baseLayer_) {
+        for (size_t i = 0; i < lightIds_.size(); ++i) {
+            baseLayer_->Hold(lightIds_[i], ToColor(frame_[i]));
+        }
+    }
+    effect_.reset();
+    active_.store(false, std::memory_order_release);
+    Disable();
+}
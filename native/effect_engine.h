@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "huestream/common/data/Color.h"
+#include "huestream/common/data/Light.h"
+#include "huestream/effect/effects/base/Effect.h"
+
+#include "frame_effect.h"
+#include "light_table.h"
+#include "output_lut.h"
+
+// Color in the same 0-255 units the JS API uses
+struct Rgb {
+    double r;
+    double g;
+    double b;
+};
+
+// Parameters shared by all native effects. Each effect documents how it
+// reads them; unused fields are ignored.
+struct EffectParams {
+    std::vector<Rgb> colors;  // effect palette (color1, color2, ...)
+    double period = 1000;     // cycle / total duration in ms
+    double rate = 0;          // secondary timing (pulse or strobe speed) in ms
+    double runTime = 0;       // total run time in ms, 0 = until stopped
+};
+
+// An effect computed natively, one color per light per render tick
+class NativeEffect {
+public:
+    explicit NativeEffect(const EffectParams& params) : params_(params) {}
+    virtual ~NativeEffect() = default;
+
+    // Fills out[0..count) for the given time since start. Returns false once
+    // the effect has finished; out then holds the frame to leave on the lights.
+    virtual bool Render(double elapsedMs, Rgb* out, size_t count) = 0;
+
+    const EffectParams& GetParams() const { return params_; }
+    virtual void SetParams(const EffectParams& params) { params_ = params; }
+
+    // Length in ms after which Render() repeats exactly (ignoring runTime),
+    // or 0 if the effect is not periodic
+    virtual double CycleMs() const { return 0; }
+
+    // Effect name of the cycle table it plays from (see frame_cache.h), or
+    // empty if it renders every frame itself
+    virtual std::string CacheName() const { return std::string(); }
+
+protected:
+    bool Expired(double elapsedMs) const {
+        return params_.runTime > 0 && elapsedMs > params_.runTime;
+    }
+    Rgb PaletteColor(size_t index) const;
+
+    EffectParams params_;
+};
+
+// Returns nullptr for unknown effect names
+std::unique_ptr<NativeEffect> CreateNativeEffect(const std::string& name, const EffectParams& params);
+
+// EDK effect that evaluates a NativeEffect on the render thread. Render() and
+// GetColor() run with the mixer locked; callers must hold LockMixer() while
+// calling Run(), SetParams(), Seek() or Halt().
+class EngineEffect : public huestream::Effect {
+public:
+    // baseLayer holds the last frame when an effect finishes or is halted,
+    // so the lights keep their colors and later manual updates stay visible
+    EngineEffect(const std::string& name, unsigned int layer, std::shared_ptr<FrameEffect> baseLayer,
+                 StreamStats* stats = nullptr);
+
+    // The first frame shows the effect startMs into its run
+    void Run(std::unique_ptr<NativeEffect> effect, const std::vector<int>& lightIds, double startMs = 0);
+    bool GetParams(EffectParams& params) const;
+    bool SetParams(const EffectParams& params);
+    // The running effect's CacheName() and light count, for building its
+    // next cycle table before taking the mixer lock for SetParams()
+    std::string CacheName() const { return effect_ ? effect_->CacheName() : std::string(); }
+    size_t LightCount() const { return lightIds_.size(); }
+    void Halt();
+    // Moves playback to timeMs since the effect started
+    bool Seek(double timeMs);
+    bool IsRunning() const { return effect_ != nullptr; }
+    // Same as IsRunning() but safe without the mixer lock
+    bool IsActive() const { return active_.load(std::memory_order_acquire); }
+    // Output correction for the effect's lights, or nullptr for none
+    void SetCorrector(std::shared_ptr<const OutputCorrector> corrector);
+
+    void Render() override;
+    huestream::Color GetColor(huestream::LightPtr light) override;
+    std::string GetTypeName() const override;
+
+private:
+    void HandOff();
+    void ResolveLuts();
+
+    std::shared_ptr<FrameEffect> baseLayer_;
+    StreamStats* stats_;
+    std::unique_ptr<NativeEffect> effect_;
+    std::atomic<bool> active_{false};
+    std::vector<std::string> lightIds_;
+    std::vector<Rgb> frame_;
+    LightSlotCache slotCache_;  // light -> frame index
+    std::chrono::steady_clock::time_point startTime_;
+    std::shared_ptr<const OutputCorrector> corrector_;
+    std::vector<const OutputLut*> luts_;  // per frame index, owned by corrector_
+};
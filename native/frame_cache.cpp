@@ -0,0 +1,217 @@
+#include "frame_cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kTableFps = 60.0;
+
+void AppendBytes(std::string& key, const void* data, size_t size) {
+    key.append(static_cast<const char*>(data), size);
+}
+
+// Exact binary key; runTime only decides when the effect ends, not its frames
+std::string TableKey(const std::string& name, const EffectParams& params, size_t lightCount) {
+    std::string key = name;
+    key.push_back('\0');
+    AppendBytes(key, &lightCount, sizeof(lightCount));
+    AppendBytes(key, &params.period, sizeof(params.period));
+    AppendBytes(key, &params.rate, sizeof(params.rate));
+    for (const Rgb& color : params.colors) {
+        AppendBytes(key, &color, sizeof(color));
+    }
+    return key;
+}
+
+uint16_t PackChannel(double value) {
+    // NaN compares false, so it lands on 0 like a negative value
+    double clamped = value > 0 ? std::min(value, 255.0) : 0.0;
+    return static_cast<uint16_t>(std::lround(clamped * CycleTable::kScale));
+}
+
+// Plays a cycle table, falling back to the wrapped effect when the table
+// does not match the light count or the parameters change to an uncacheable
+// set
+class CachedEffect : public NativeEffect {
+public:
+    CachedEffect(std::string name, std::unique_ptr<NativeEffect> source, std::shared_ptr<const CycleTable> table)
+        : NativeEffect(source->GetParams()),
+          name_(std::move(name)),
+          source_(std::move(source)),
+          table_(std::move(table)),
+          lightCount_(table_->lightCount) {
+    }
+
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        if (!table_ || count != table_->lightCount) {
+            return source_->Render(elapsedMs, out, count);
+        }
+        if (Expired(elapsedMs)) {
+            return false;
+        }
+        double phase = std::fmod(std::max(elapsedMs, 0.0), table_->cycleMs) / table_->cycleMs;
+        size_t index = static_cast<size_t>(std::lround(phase * table_->frameCount)) % table_->frameCount;
+        table_->GetFrame(index, out);
+        return true;
+    }
+
+    // Called with the mixer lock held, so a changed look is only looked up;
+    // without a prepared table the source renders every frame
+    void SetParams(const EffectParams& params) override {
+        NativeEffect::SetParams(params);
+        source_->SetParams(params);
+        table_ = FrameCache::Instance().Find(name_, params, lightCount_);
+    }
+
+    double CycleMs() const override { return source_->CycleMs(); }
+    std::string CacheName() const override { return name_; }
+
+private:
+    std::string name_;
+    std::unique_ptr<NativeEffect> source_;
+    std::shared_ptr<const CycleTable> table_;
+    size_t lightCount_;
+};
+
+}  // namespace
+
+void CycleTable::SetFrame(size_t index, const Rgb* colors) {
+    uint16_t* packed = channels.data() + index * lightCount * 3;
+    for (size_t i = 0; i < lightCount; ++i) {
+        packed[i * 3] = PackChannel(colors[i].r);
+        packed[i * 3 + 1] = PackChannel(colors[i].g);
+        packed[i * 3 + 2] = PackChannel(colors[i].b);
+    }
+}
+
+void CycleTable::GetFrame(size_t index, Rgb* out) const {
+    const uint16_t* packed = channels.data() + index * lightCount * 3;
+    for (size_t i = 0; i < lightCount; ++i) {
+        out[i] = {packed[i * 3] / kScale, packed[i * 3 + 1] / kScale, packed[i * 3 + 2] / kScale};
+    }
+}
+
+FrameCache& FrameCache::Instance() {
+    static FrameCache cache;
+    return cache;
+}
+
+void FrameCache::SetLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    limit_ = bytes;
+    EvictTo(limit_);
+}
+
+void FrameCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EvictTo(0);
+}
+
+FrameCache::Stats FrameCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.limitBytes = limit_;
+    stats.bytes = bytes_;
+    stats.tables = lru_.size();
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    return stats;
+}
+
+std::shared_ptr<const CycleTable> FrameCache::Acquire(const std::string& name, const NativeEffect& effect,
+                                                      size_t lightCount) {
+    double cycleMs = effect.CycleMs();
+    if (!(cycleMs > 0) || lightCount == 0) {
+        return nullptr;
+    }
+    size_t frameCount = std::max<size_t>(1, static_cast<size_t>(std::lround(cycleMs * kTableFps / 1000.0)));
+    size_t bytes = frameCount * lightCount * 3 * sizeof(uint16_t);
+
+    std::string key = TableKey(name, effect.GetParams(), lightCount);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(key);
+        if (found != index_.end()) {
+            ++hits_;
+            lru_.splice(lru_.begin(), lru_, found->second);
+            return found->second->table;
+        }
+        ++misses_;
+        if (bytes > limit_) {
+            return nullptr;
+        }
+    }
+
+    // Rendered outside the lock from a copy, so the caller's effect keeps its state
+    auto table = std::make_shared<CycleTable>();
+    table->cycleMs = cycleMs;
+    table->frameCount = frameCount;
+    table->lightCount = lightCount;
+    table->channels.resize(frameCount * lightCount * 3);
+    EffectParams params = effect.GetParams();
+    params.runTime = 0;
+    std::unique_ptr<NativeEffect> renderer = CreateNativeEffect(name, params);
+    if (!renderer) {
+        return nullptr;
+    }
+    std::vector<Rgb> colors(lightCount);
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        renderer->Render(cycleMs * frame / frameCount, colors.data(), lightCount);
+        table->SetFrame(frame, colors.data());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        // Built concurrently by another caller
+        return found->second->table;
+    }
+    if (bytes > limit_) {
+        return nullptr;
+    }
+    EvictTo(limit_ - bytes);
+    lru_.push_front(Entry{key, table});
+    index_[key] = lru_.begin();
+    bytes_ += bytes;
+    return table;
+}
+
+std::shared_ptr<const CycleTable> FrameCache::Find(const std::string& name, const EffectParams& params,
+                                                   size_t lightCount) const {
+    std::string key = TableKey(name, params, lightCount);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    return found == index_.end() ? nullptr : found->second->table;
+}
+
+void FrameCache::EvictTo(size_t bytes) {
+    while (bytes_ > bytes && !lru_.empty()) {
+        bytes_ -= lru_.back().table->Bytes();
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+        ++evictions_;
+    }
+}
+
+std::unique_ptr<NativeEffect> CacheNativeEffect(const std::string& name, std::unique_ptr<NativeEffect> effect,
+                                                size_t lightCount) {
+    if (!effect) {
+        return effect;
+    }
+    std::shared_ptr<const CycleTable> table = FrameCache::Instance().Acquire(name, *effect, lightCount);
+    if (!table) {
+        return effect;
+    }
+    return std::unique_ptr<NativeEffect>(new CachedEffect(name, std::move(effect), std::move(table)));
+}
+
+std::shared_ptr<const CycleTable> PrepareCycleTable(const std::string& name, const EffectParams& params,
+                                                    size_t lightCount) {
+    if (name.empty()) {
+        return nullptr;
+    }
+    std::unique_ptr<NativeEffect> effect = CreateNativeEffect(name, params);
+    return effect ? FrameCache::Instance().Acquire(name, *effect, lightCount) : nullptr;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "effect_engine.h"
+
+// One rendered cycle of a periodic effect: frameCount frames of lightCount
+// colors, packed frame after frame as 16-bit r, g, b (0-255 scaled by 257),
+// a quarter of the size of Rgb. Immutable once built.
+struct CycleTable {
+    static constexpr double kScale = 65535.0 / 255.0;
+
+    double cycleMs;
+    size_t frameCount;
+    size_t lightCount;
+    std::vector<uint16_t> channels;
+
+    // Stores one frame of colors, clamped to 0-255
+    void SetFrame(size_t index, const Rgb* colors);
+    // Expands one frame back into colors
+    void GetFrame(size_t index, Rgb* out) const;
+    size_t Bytes() const { return channels.size() * sizeof(uint16_t); }
+};
+
+// Process-wide cache of cycle tables, keyed by effect name, parameters (other
+// than runTime) and light count. Tables are sampled at 60 Hz. Least recently
+// used tables are evicted to stay under the byte limit; effects that still
+// play an evicted table keep it alive until they stop. Thread-safe, but meant
+// for the JS thread: building a table renders a whole cycle.
+class FrameCache {
+public:
+    static FrameCache& Instance();
+
+    struct Stats {
+        size_t limitBytes = 0;
+        size_t bytes = 0;
+        size_t tables = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    // 0 disables the cache; shrinking evicts right away
+    void SetLimit(size_t bytes);
+    void Clear();
+    Stats GetStats() const;
+
+    // The table for one cycle of effect over lightCount lights, built on a
+    // miss. nullptr if the effect is not periodic or the table would not fit.
+    std::shared_ptr<const CycleTable> Acquire(const std::string& name, const NativeEffect& effect, size_t lightCount);
+    // The cached table for these parameters, or nullptr; never builds one,
+    // so it is safe under the mixer lock
+    std::shared_ptr<const CycleTable> Find(const std::string& name, const EffectParams& params,
+                                           size_t lightCount) const;
+
+private:
+    FrameCache() = default;
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CycleTable> table;
+    };
+
+    void EvictTo(size_t bytes);
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t limit_ = 16 * 1024 * 1024;
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+};
+
+// Wraps a periodic effect so steady-state rendering copies frames out of its
+// cycle table. Returns the effect unchanged if it cannot be cached.
+// SetParams() on the wrapper only looks the new table up: build it first
+// with PrepareCycleTable(), off the mixer lock, or the effect renders
+// uncached until the next change.
+std::unique_ptr<NativeEffect> CacheNativeEffect(const std::string& name, std::unique_ptr<NativeEffect> effect,
+                                                size_t lightCount);
+// Builds (or finds) the table for name with params; no-op for an empty
+// name. Keep the result until SetParams() so it is not evicted first.
+std::shared_ptr<const CycleTable> PrepareCycleTable(const std::string& name, const EffectParams& params,
+                                                    size_t lightCount);
@@ -0,0 +1,241 @@
+#include "frame_effect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace huestream;
+
+FrameEffect::FrameEffect(const std::string& name, unsigned int layer, StreamStats* stats)
+    : Effect(name, layer),
+      stats_(stats),
+      publishCount_(0),
+      dirty_(false),
+      skippedWrites_(0),
+      seenHolds_(0),
+      stagedTransitionMs_(0),
+      publishedTransitionMs_(0),
+      holds_(0),
+      fading_(0),
+      currentStamp_(0) {
+}
+
+void FrameEffect::Resize(const LightTable& table) {
+    Frame empty;
+    empty.slots.resize(table.Size());
+    buffer_.Reset(empty);
+    staging_ = empty;
+    publishCount_ = 0;
+    wire_.assign(table.Size(), WireColor());
+    dirty_ = false;
+
+    current_ = empty.slots;
+    fades_.assign(table.Size(), Fade());
+    fading_ = 0;
+    currentStamp_ = 0;
+    ids_.clear();
+    lights_.clear();
+    slotByLight_.clear();
+    for (size_t slot = 0; slot < table.Size(); ++slot) {
+        ids_.push_back(table.Id(slot));
+        lights_.push_back(table.Light(slot));
+        slotByLight_.emplace_back(table.Light(slot).get(), static_cast<int>(slot));
+    }
+    std::sort(slotByLight_.begin(), slotByLight_.end());
+}
+
+void FrameEffect::SetCorrector(std::shared_ptr<const OutputCorrector> corrector) {
+    corrector_ = std::move(corrector);
+    // The same input may now go out differently
+    std::fill(wire_.begin(), wire_.end(), WireColor());
+}
+
+FrameEffect::WireColor FrameEffect::Quantize(const Color& color) {
+    // std::max(NaN, 0.0) is NaN, and lround(NaN) is undefined for the cast
+    auto channel = [](double value) {
+        double unit = std::isfinite(value) ? std::min(std::max(value, 0.0), 1.0) : 0.0;
+        return static_cast<uint16_t>(std::lround(unit * 65535.0));
+    };
+    WireColor wire;
+    wire.r = channel(color.GetR());
+    wire.g = channel(color.GetG());
+    wire.b = channel(color.GetB());
+    wire.alpha = channel(color.GetAlpha());
+    wire.valid = true;
+    return wire;
+}
+
+void FrameEffect::SetColor(size_t slot, const Color& color, const Transition& transition) {
+    uint64_t holds = holds_.load(std::memory_order_acquire);
+    if (holds != seenHolds_) {
+        seenHolds_ = holds;
+        std::fill(wire_.begin(), wire_.end(), WireColor());
+    }
+
+    const Color corrected = corrector_ ? corrector_->ApplySlot(slot, color) : color;
+    WireColor wire = Quantize(corrected);
+    wire.transition = transition;
+    if (wire == wire_[slot]) {
+        ++skippedWrites_;
+        return;
+    }
+    wire_[slot] = wire;
+    dirty_ = true;
+
+    staging_.slots[slot].color = corrected;
+    staging_.slots[slot].stamp = publishCount_ + 1;
+    staging_.slots[slot].set = true;
+    staging_.slots[slot].transition = transition;
+    stagedTransitionMs_ = std::max(stagedTransitionMs_, transition.durationMs);
+}
+
+void FrameEffect::SetAll(const Color& color) {
+    for (size_t slot = 0; slot < staging_.slots.size(); ++slot) {
+        SetColor(slot, color);
+    }
+}
+
+bool FrameEffect::Publish() {
+    if (stats_) {
+        stats_->OnPublish(skippedWrites_);
+    }
+    skippedWrites_ = 0;
+    if (!dirty_) {
+        if (stats_) {
+            stats_->OnPublishSkipped();
+        }
+        return false;
+    }
+    dirty_ = false;
+    publishedTransitionMs_ = stagedTransitionMs_;
+    stagedTransitionMs_ = 0;
+
+    staging_.stamp = ++publishCount_;
+    Frame& back = buffer_.Back();
+    // Same-sized vectors: element-wise copy, no allocation
+    back.slots = staging_.slots;
+    back.stamp = staging_.stamp;
+    back.publishedAtNs = StatsNowNs();
+    buffer_.Publish();
+    return true;
+}
+
+void FrameEffect::Hold(const std::string& lightId, const Color& color) {
+    auto it = std::find(ids_.begin(), ids_.end(), lightId);
+    if (it == ids_.end()) {
+        return;
+    }
+    size_t index = it - ids_.begin();
+    Slot& slot = current_[index];
+    slot.color = corrector_ ? corrector_->ApplySlot(index, color) : color;
+    slot.set = true;
+    // Any later write from the producer has a higher stamp and wins
+    slot.stamp = currentStamp_;
+    StopFade(index);
+    holds_.fetch_add(1, std::memory_order_release);
+}
+
+// Starts from what the light shows now; a light that was never set keeps
+// the target color and fades its alpha in, so the layers below show through
+void FrameEffect::StartFade(size_t slot, const Slot& next, int64_t startNs) {
+    if (next.transition.durationMs <= 0) {
+        StopFade(slot);
+        return;
+    }
+    Fade& fade = fades_[slot];
+    const Color& target = next.color;
+    if (fade.active) {
+        fade.from = fade.shown;
+    } else if (current_[slot].set) {
+        fade.from = current_[slot].color;
+        ++fading_;
+    } else {
+        fade.from = Color(target.GetR(), target.GetG(), target.GetB(), 0.0);
+        ++fading_;
+    }
+    fade.shown = fade.from;
+    fade.startNs = startNs;
+    fade.durationNs = static_cast<int64_t>(next.transition.durationMs * 1e6);
+    fade.easing = next.transition.easing;
+    fade.active = true;
+}
+
+void FrameEffect::StopFade(size_t slot) {
+    if (fades_[slot].active) {
+        fades_[slot].active = false;
+        --fading_;
+    }
+}
+
+void FrameEffect::Render() {
+    int64_t start = stats_ ? StatsNowNs() : 0;
+    if (stats_) {
+        stats_->OnFrameStart(start);
+    }
+
+    // Nothing new since the last frame: the current colors stand as they are
+    if (buffer_.Acquire()) {
+        const Frame& frame = buffer_.Front();
+        for (size_t i = 0; i < current_.size() && i < frame.slots.size(); ++i) {
+            if (frame.slots[i].stamp > current_[i].stamp) {
+                StartFade(i, frame.slots[i], frame.publishedAtNs);
+                current_[i] = frame.slots[i];
+            }
+        }
+        currentStamp_ = frame.stamp;
+        if (stats_) {
+            stats_->OnFrameAcquired(frame.publishedAtNs, start);
+        }
+    } else if (stats_) {
+        stats_->OnFrameUnchanged();
+    }
+
+    if (fading_ > 0) {
+        int64_t now = stats_ ? start : StatsNowNs();
+        for (size_t i = 0; i < fades_.size(); ++i) {
+            Fade& fade = fades_[i];
+            if (!fade.active) {
+                continue;
+            }
+            double t = static_cast<double>(now - fade.startNs) / fade.durationNs;
+            if (t >= 1.0) {
+                StopFade(i);
+                continue;
+            }
+            double eased = Ease(fade.easing, std::max(t, 0.0));
+            const Color& to = current_[i].color;
+            fade.shown = Color(fade.from.GetR() + (to.GetR() - fade.from.GetR()) * eased,
+                               fade.from.GetG() + (to.GetG() - fade.from.GetG()) * eased,
+                               fade.from.GetB() + (to.GetB() - fade.from.GetB()) * eased,
+                               fade.from.GetAlpha() + (to.GetAlpha() - fade.from.GetAlpha()) * eased);
+        }
+    }
+
+    if (stats_) {
+        stats_->OnLayerRender(static_cast<uint64_t>(StatsNowNs() - start));
+    }
+}
+
+Color FrameEffect::GetColor(LightPtr light) {
+    int slot = SlotForLight(light.get());
+    if (slot < 0 || !current_[slot].set) {
+        return Color(0, 0, 0, 0);
+    }
+    return fades_[slot].active ? fades_[slot].shown : current_[slot].color;
+}
+
+std::string FrameEffect::GetTypeName() const {
+    return "hue_edk.FrameEffect";
+}
+
+// The mixer passes the group's own lights, which lights_ keeps alive, so
+// their addresses stay unique until the next Resize()
+int FrameEffect::SlotForLight(const Light* light) const {
+    auto it = std::lower_bound(slotByLight_.begin(), slotByLight_.end(), std::make_pair(light, -1));
+    if (it != slotByLight_.end() && it->first == light) {
+        return it->second;
+    }
+    // A light object from a newer copy of the group, before the next Resize()
+    auto id = std::find(ids_.begin(), ids_.end(), light->GetId());
+    return id == ids_.end() ? -1 : static_cast<int>(id - ids_.begin());
+}
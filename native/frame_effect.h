@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "huestream/common/data/Color.h"
+#include "huestream/common/data/Light.h"
+#include "huestream/effect/effects/base/Effect.h"
+
+#include "easing.h"
+#include "light_table.h"
+#include "output_lut.h"
+#include "stream_stats.h"
+#include "triple_buffer.h"
+
+// How a write reaches its light: at once, or faded on the render thread
+// from whatever the light shows when the write is picked up
+struct Transition {
+    double durationMs = 0;
+    Easing easing = Easing::Linear;
+};
+
+// Manual color layer fed through a triple buffer instead of the mixer lock.
+// The JS thread writes colors into a staging frame and publishes it; the
+// render thread picks up the newest complete frame in Render() without
+// blocking the writer. Each light carries the number of the publish that
+// last wrote it, so only real updates replace what the render thread shows.
+//
+// Writes are compared at wire precision (16 bits per channel) with the last
+// value written to the light; unchanged writes are dropped, and a publish
+// with no changed light is skipped, leaving the render thread nothing to
+// pick up.
+//
+// With an output corrector set, colors are corrected for their light's
+// gamut as they are written, before the comparison.
+//
+// A write with a transition is interpolated by Render() once per tick,
+// starting at its publish time, so sparse writes still fade smoothly. A
+// light that was never set fades in from transparent.
+class FrameEffect : public huestream::Effect {
+public:
+    // stats, if given, receives publish counts, frame timing and the
+    // publish-to-render latency
+    FrameEffect(const std::string& name, unsigned int layer, StreamStats* stats = nullptr);
+
+    // Rebuilds all buffers for the table's lights. Caller holds LockMixer().
+    void Resize(const LightTable& table);
+    // Corrector built for the same table, or nullptr to write colors as
+    // given. Caller holds LockMixer(), on the producer thread.
+    void SetCorrector(std::shared_ptr<const OutputCorrector> corrector);
+
+    // Producer side (JS thread only)
+    size_t Size() const { return staging_.slots.size(); }
+    void SetColor(size_t slot, const huestream::Color& color, const Transition& transition = Transition());
+    void SetAll(const huestream::Color& color);
+    // Returns false if nothing changed since the last publish
+    bool Publish();
+    // Longest transition in the last publish, in ms
+    double PublishedTransitionMs() const { return publishedTransitionMs_; }
+
+    // Render thread, or any thread holding LockMixer(): shows color on the light until the producer next
+    // writes to it (used to leave the last frame of a native effect)
+    void Hold(const std::string& lightId, const huestream::Color& color);
+
+    void Render() override;
+    huestream::Color GetColor(huestream::LightPtr light) override;
+    std::string GetTypeName() const override;
+
+private:
+    struct Slot {
+        huestream::Color color;
+        uint64_t stamp = 0;  // publish that last wrote this light
+        bool set = false;    // never-set lights stay transparent
+        Transition transition;
+    };
+    struct Frame {
+        std::vector<Slot> slots;
+        uint64_t stamp = 0;
+        int64_t publishedAtNs = 0;
+    };
+
+    // Color as sent to the bridge, and how it gets there
+    struct WireColor {
+        uint16_t r = 0;
+        uint16_t g = 0;
+        uint16_t b = 0;
+        uint16_t alpha = 0;
+        bool valid = false;
+        Transition transition;
+
+        bool operator==(const WireColor& other) const {
+            return valid && other.valid && r == other.r && g == other.g && b == other.b && alpha == other.alpha &&
+                   transition.durationMs == other.transition.durationMs &&
+                   transition.easing == other.transition.easing;
+        }
+    };
+    static WireColor Quantize(const huestream::Color& color);
+
+    // A light on its way to current_[slot].color
+    struct Fade {
+        huestream::Color from;
+        huestream::Color shown;  // this tick's color
+        int64_t startNs = 0;
+        int64_t durationNs = 0;
+        Easing easing = Easing::Linear;
+        bool active = false;
+    };
+    void StartFade(size_t slot, const Slot& next, int64_t startNs);
+    void StopFade(size_t slot);
+
+    int SlotForLight(const huestream::Light* light) const;
+
+    TripleBuffer<Frame> buffer_;
+    StreamStats* stats_;
+    std::shared_ptr<const OutputCorrector> corrector_;
+
+    // Producer state
+    Frame staging_;
+    uint64_t publishCount_;
+    std::vector<WireColor> wire_;  // last value written per light
+    bool dirty_;                   // a light changed since the last publish
+    uint64_t skippedWrites_;       // flushed to stats on publish
+    uint64_t seenHolds_;
+    double stagedTransitionMs_;    // longest transition since the last publish
+    double publishedTransitionMs_;
+
+    // Bumped by Hold(): the render thread then shows colors the producer did
+    // not write, so its wire_ cache no longer describes the lights
+    std::atomic<uint64_t> holds_;
+
+    // Render thread state
+    std::vector<Slot> current_;
+    std::vector<Fade> fades_;
+    size_t fading_;  // active fades
+    uint64_t currentStamp_;
+    std::vector<std::string> ids_;
+    std::vector<huestream::LightPtr> lights_;
+    std::vector<std::pair<const huestream::Light*, int>> slotByLight_;  // by address
+};
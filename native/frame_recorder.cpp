@@ -0,0 +1,57 @@
+#include "frame_recorder.h"
+
+#include <algorithm>
+
+FrameRecorder::FrameRecorder(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)),
+      recorded_(0) {
+}
+
+void FrameRecorder::Reset(const std::vector<std::string>& lightIds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lightIds_ = lightIds;
+    recorded_ = 0;
+    times_.assign(capacity_, 0);
+    colors_.assign(capacity_ * lightIds.size() * 3, 0.0f);
+}
+
+void FrameRecorder::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    recorded_ = 0;
+}
+
+void FrameRecorder::Record(int64_t timeNs, const float* rgb) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (times_.empty()) {
+        return;
+    }
+    size_t slot = recorded_ % capacity_;
+    size_t stride = lightIds_.size() * 3;
+    times_[slot] = timeNs;
+    std::copy(rgb, rgb + stride, colors_.begin() + slot * stride);
+    ++recorded_;
+}
+
+void FrameRecorder::ReadSince(uint64_t sinceSeq, Capture& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t oldest = recorded_ > capacity_ ? recorded_ - capacity_ + 1 : 1;
+    uint64_t first = std::max(sinceSeq + 1, oldest);
+    size_t count = first <= recorded_ ? static_cast<size_t>(recorded_ - first + 1) : 0;
+    size_t stride = lightIds_.size() * 3;
+
+    out.lightIds = lightIds_;
+    out.firstSeq = first;
+    out.times.resize(count);
+    out.colors.resize(count * stride);
+    for (size_t i = 0; i < count; ++i) {
+        size_t slot = (first - 1 + i) % capacity_;
+        out.times[i] = times_[slot];
+        std::copy(colors_.begin() + slot * stride, colors_.begin() + (slot + 1) * stride,
+                  out.colors.begin() + i * stride);
+    }
+}
+
+uint64_t FrameRecorder::Recorded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return recorded_;
+}
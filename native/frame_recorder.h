@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Fixed-capacity ring of output frames (r, g, b per light, 0-1) with their
+// steady_clock timestamps. Written once per rendered frame, read by tests
+// and benchmarks; storage is allocated up front so recording never
+// allocates. Frames are numbered from 1 in recording order.
+class FrameRecorder {
+public:
+    explicit FrameRecorder(size_t capacity);
+
+    // Drops all frames and sizes the ring for the given lights
+    void Reset(const std::vector<std::string>& lightIds);
+    // Drops all frames, keeping the lights
+    void Clear();
+    // rgb holds 3 values per light, in Reset() order
+    void Record(int64_t timeNs, const float* rgb);
+
+    struct Capture {
+        std::vector<std::string> lightIds;
+        uint64_t firstSeq = 0;   // number of the first frame in times/colors
+        std::vector<int64_t> times;
+        std::vector<float> colors;
+    };
+    // Copies the frames numbered above sinceSeq that are still in the ring,
+    // oldest first
+    void ReadSince(uint64_t sinceSeq, Capture& out) const;
+
+    size_t Capacity() const { return capacity_; }
+    uint64_t Recorded() const;
+
+private:
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    std::vector<std::string> lightIds_;
+    uint64_t recorded_;
+    std::vector<int64_t> times_;
+    std::vector<float> colors_;
+};
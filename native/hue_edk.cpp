@@ -1,22 +1,120 @@
 #include <napi.h>
+#include <atomic>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <functional>
+#include <map>
+#include <set>
 
 // Include EDK headers for real UDP streaming
 #include "huestream/HueStream.h"
-#include "huestream/config/Config.h"
 #include "huestream/common/data/Bridge.h"
-#include "huestream/common/data/BridgeSettings.h"
-#include "huestream/common/data/Group.h"
-#include "huestream/common/data/Light.h"
 #include "huestream/common/data/Color.h"
-#include "huestream/effect/effects/ManualEffect.h"
+
+#include "alloc_counter.h"
+#include "color_kernels.h"
+#include "effect_engine.h"
+#include "frame_cache.h"
+#include "render_scheduler.h"
+#include "sequencer.h"
+#include "spatial_field.h"
+#include "stream_session.h"
+#include "timeline.h"
 
 using namespace huestream;
 
+class HueWrapper;
+class HueSessionManager;
+
+// Per-environment addon state. The addon can be loaded by the main thread
+// and by any number of worker_threads, each with its own environment, so
+// nothing that holds JS values lives in a static. Owned by the environment
+// through SetInstanceData.
+struct AddonData {
+    Napi::FunctionReference hueWrapper;
+    Napi::FunctionReference sessionManager;
+    // Live native objects of this environment. A worker can exit before they
+    // are collected; the cleanup hook then stops their render threads while
+    // the environment can still take the thread-safe function releases.
+    std::set<HueWrapper*> wrappers;
+    std::set<HueSessionManager*> managers;
+
+    void CloseAll();
+};
+
+// Publish count at the previous getStats() call, for the setter call rate
+struct StatsWindow {
+    int64_t atNs = 0;
+    uint64_t publishes = 0;
+};
+
+// Calls a JS function once per render tick through a thread-safe function.
+// At most one call waits in the queue: a tick that arrives before JS ran the
+// previous one is counted as missed and folded into it, so JS always computes
+// the frame for the newest tick. Owned by its thread-safe function and deleted
+// by the finalizer once the queued calls have run.
+class FrameClock {
+public:
+    static void CallJs(Napi::Env env, Napi::Function callback, FrameClock* clock, void* data);
+    static void Finalize(Napi::Env env, void* data, FrameClock* clock) { delete clock; }
+
+    // Render thread, from the scheduler's tick listener
+    void OnTick(const RenderScheduler::Tick& tick) {
+        {
+            std::lock_guard<std::mutex> lock(tickMutex_);
+            latest_ = tick;
+        }
+        if (pending_.exchange(true, std::memory_order_acq_rel)) {
+            missedTicks.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (tsfn.NonBlockingCall() != napi_ok) {
+            pending_.store(false, std::memory_order_release);
+        }
+    }
+
+    Napi::TypedThreadSafeFunction<FrameClock, void, &FrameClock::CallJs> tsfn;
+    std::atomic<uint64_t> callbacks{0};
+    // Ticks JS did not get to before the next one
+    std::atomic<uint64_t> missedTicks{0};
+    // Callbacks that returned after the next tick's deadline
+    std::atomic<uint64_t> lateCallbacks{0};
+
+private:
+    std::mutex tickMutex_;
+    RenderScheduler::Tick latest_{};
+    std::atomic<bool> pending_{false};
+};
+
+// Queues session state changes to a JS function through a thread-safe
+// function. Unlike the frame clock nothing is folded: every event is
+// delivered, in order. Unreferenced, so a listener alone does not keep the
+// process alive. Owned by its thread-safe function like FrameClock.
+class StateEvents {
+public:
+    struct Event {
+        SessionEvent event;
+        int64_t timeNs;
+    };
+
+    static void CallJs(Napi::Env env, Napi::Function callback, StateEvents* events, Event* event);
+    static void Finalize(Napi::Env env, void* data, StateEvents* events) { delete events; }
+
+    // Any thread, from the session's state listener
+    void Post(SessionEvent event) {
+        auto* queued = new Event{event, StatsNowNs()};
+        if (tsfn.NonBlockingCall(queued) != napi_ok) {
+            delete queued;
+        }
+    }
+
+    Napi::TypedThreadSafeFunction<StateEvents, Event, &StateEvents::CallJs> tsfn;
+};
+
 // Real HueStream wrapper with actual EDK calls
 class HueWrapper : public Napi::ObjectWrap<HueWrapper> {
 public:
@@ -24,9 +122,14 @@ public:
     HueWrapper(const Napi::CallbackInfo& info);
     ~HueWrapper();
 
+    // Stops the frame clock and scheduler and ends the stream. State events
+    // keep going to the listener, which hears the stream end.
+    void Close();
+    // Releases the state listener; after Close() on environment teardown
+    void StopStateEvents();
+
 private:
-    static Napi::FunctionReference constructor;
-    
+
     // Native methods that call EDK
     Napi::Value Initialize(const Napi::CallbackInfo& info);
     Napi::Value ConnectManual(const Napi::CallbackInfo& info);
@@ -34,6 +137,11 @@ private:
     Napi::Value Start(const Napi::CallbackInfo& info);
     Napi::Value Stop(const Napi::CallbackInfo& info);
 
+    // Promise-based variants that run the blocking EDK calls off the JS thread
+    Napi::Value ConnectManualAsync(const Napi::CallbackInfo& info);
+    Napi::Value SelectGroupAsync(const Napi::CallbackInfo& info);
+    Napi::Value StartAsync(const Napi::CallbackInfo& info);
+
     // RGB color methods
     Napi::Value SetColorRGB(const Napi::CallbackInfo& info);
     Napi::Value SetColorRGBA(const Napi::CallbackInfo& info);
@@ -52,27 +160,169 @@ private:
     Napi::Value SetBrightness(const Napi::CallbackInfo& info);
     Napi::Value SetLightBrightness(const Napi::CallbackInfo& info);
 
+    // Whole-frame submission
+    Napi::Value SetFrame(const Napi::CallbackInfo& info);
+
+    // Timed fades interpolated by the render thread
+    Napi::Value SetLightTransition(const Napi::CallbackInfo& info);
+    Napi::Value SetLightTransitions(const Napi::CallbackInfo& info);
+
+    // Named layers with priorities, opacity and blend modes
+    Napi::Value CreateLayer(const Napi::CallbackInfo& info);
+    Napi::Value SetLayerOptions(const Napi::CallbackInfo& info);
+    Napi::Value SetLayerFrame(const Napi::CallbackInfo& info);
+    Napi::Value ClearLayer(const Napi::CallbackInfo& info);
+    Napi::Value RemoveLayer(const Napi::CallbackInfo& info);
+    Napi::Value GetLayers(const Napi::CallbackInfo& info);
+
+    // Frames from another process through a shared-memory ring
+    Napi::Value AttachSharedFrames(const Napi::CallbackInfo& info);
+    Napi::Value DetachSharedFrames(const Napi::CallbackInfo& info);
+
+    // Native effects rendered on the EDK render thread
+    Napi::Value StartEffect(const Napi::CallbackInfo& info);
+    Napi::Value SetEffectParams(const Napi::CallbackInfo& info);
+    Napi::Value StopEffect(const Napi::CallbackInfo& info);
+    Napi::Value IsEffectRunning(const Napi::CallbackInfo& info);
+    Napi::Value SeekEffect(const Napi::CallbackInfo& info);
+
+    // Compiled keyframe timelines, played through the native effect layer
+    Napi::Value LoadTimeline(const Napi::CallbackInfo& info);
+    Napi::Value PlayTimeline(const Napi::CallbackInfo& info);
+    Napi::Value UnloadTimeline(const Napi::CallbackInfo& info);
+
+    // Playlists of effects, timelines and scenes switched on the render thread
+    Napi::Value PlaySequence(const Napi::CallbackInfo& info);
+
+    // Spatial fields evaluated at the lights' entertainment-area positions
+    Napi::Value SetField(const Napi::CallbackInfo& info);
+    Napi::Value GetLightPositions(const Napi::CallbackInfo& info);
+
+    // Output frames recorded by the simulated backend
+    Napi::Value GetCapturedFrames(const Napi::CallbackInfo& info);
+    Napi::Value ClearCapturedFrames(const Napi::CallbackInfo& info);
+
+    // Output capture to a file, and native replay of one
+    Napi::Value StartCapture(const Napi::CallbackInfo& info);
+    Napi::Value StopCapture(const Napi::CallbackInfo& info);
+    Napi::Value StartReplay(const Napi::CallbackInfo& info);
+    Napi::Value StopReplay(const Napi::CallbackInfo& info);
+
     Napi::Value GetLightIds(const Napi::CallbackInfo& info);
+    Napi::Value GetAllocationCount(const Napi::CallbackInfo& info);
     Napi::Value Update(const Napi::CallbackInfo& info);
     Napi::Value GetStatus(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
     Napi::Value Shutdown(const Napi::CallbackInfo& info);
 
-    // EDK objects
+    // Fixed or adaptive stream rate
+    Napi::Value SetRatePolicy(const Napi::CallbackInfo& info);
+    Napi::Value GetRatePolicy(const Napi::CallbackInfo& info);
+
+    // Per-light gamut correction of the output colors
+    Napi::Value SetOutputCorrection(const Napi::CallbackInfo& info);
+    Napi::Value GetOutputCorrection(const Napi::CallbackInfo& info);
+
+    // Cached bridge state for fast restarts
+    Napi::Value SetWarmStart(const Napi::CallbackInfo& info);
+    Napi::Value GetWarmStart(const Napi::CallbackInfo& info);
+    // After a warm connect, on the JS thread
+    void FinishWarmStart(Napi::Env env);
+
+    // JS callback once per render tick
+    Napi::Value SetFrameCallback(const Napi::CallbackInfo& info);
+    Napi::Value ClearFrameCallback(const Napi::CallbackInfo& info);
+    void StopFrameClock();
+
+    // JS callback on connection and stream state changes
+    Napi::Value SetStateCallback(const Napi::CallbackInfo& info);
+    Napi::Value ClearStateCallback(const Napi::CallbackInfo& info);
+
+    AddonData* addon_;  // this object's environment
+
+    // EDK stream, layers and light table; null until initialize()
     std::string appName_;
     std::string deviceName_;
-    std::shared_ptr<Config> config_;
-    std::unique_ptr<HueStream> hueStream_;
-    std::shared_ptr<ManualEffect> manualEffect_;
+    BackendOptions backendOptions_;
+    RatePolicy ratePolicy_;
+    OutputCorrection correction_;
+    std::string warmStartPath_;
+    std::shared_ptr<StreamSession> session_;
+    std::vector<float> fieldFrame_;  // setField() output, 4 floats per light
+    // Renders the session; replaces the EDK render thread so idle ticks can be skipped
+    std::unique_ptr<RenderScheduler> scheduler_;
+    FrameClock* frameClock_ = nullptr;  // owned by its thread-safe function
+    StateEvents* stateEvents_ = nullptr;  // likewise; kept across shutdown()
+    StatsWindow statsWindow_;
+    std::map<int, std::shared_ptr<const Timeline>> timelines_;
+    int nextTimelineId_ = 1;
     
-    // State tracking
+    // JS thread: serializes the synchronous entry points with shutdown
     std::mutex mutex_;
-    bool initialized_;
-    bool connected_;
-    bool streaming_;
-    std::string selectedGroupId_;
+    // Held for the blocking connection steps, on the pool thread for the
+    // async ones; the JS thread never waits for it outside the sync API
+    std::mutex connectMutex_;
 };
 
-Napi::FunctionReference HueWrapper::constructor;
+// Runs a blocking EDK call on the libuv thread pool and settles a promise
+// with its boolean result. The owning wrapper object is referenced until the
+// work is done so it cannot be collected mid-handshake.
+class EdkWorker : public Napi::AsyncWorker {
+public:
+    // finish runs on the JS thread once work returned true, and its result
+    // settles the promise
+    EdkWorker(Napi::Env env, Napi::Reference<Napi::Object>* owner, const char* errorPrefix,
+              std::function<bool()> work, std::function<bool()> finish = nullptr)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          owner_(owner),
+          errorPrefix_(errorPrefix),
+          work_(std::move(work)),
+          finish_(std::move(finish)),
+          result_(false) {
+        owner_->Ref();
+    }
+
+    ~EdkWorker() override {
+        owner_->Unref();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        try {
+            result_ = work_();
+        } catch (const std::exception& e) {
+            SetError(errorPrefix_ + e.what());
+        }
+    }
+
+    // Runs on the JS thread
+    void OnOK() override {
+        if (result_ && finish_) {
+            try {
+                result_ = finish_();
+            } catch (const std::exception& e) {
+                deferred_.Reject(Napi::Error::New(Env(), errorPrefix_ + e.what()).Value());
+                return;
+            }
+        }
+        deferred_.Resolve(Napi::Boolean::New(Env(), result_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    Napi::Reference<Napi::Object>* owner_;
+    std::string errorPrefix_;
+    std::function<bool()> work_;
+    std::function<bool()> finish_;
+    bool result_;
+};
 
 Napi::Object HueWrapper::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "HueWrapper", {
@@ -81,6 +331,9 @@ Napi::Object HueWrapper::Init(Napi::Env env, Napi::Object exports) {
         InstanceMethod("selectGroup", &HueWrapper::SelectGroup),
         InstanceMethod("start", &HueWrapper::Start),
         InstanceMethod("stop", &HueWrapper::Stop),
+        InstanceMethod("connectManualAsync", &HueWrapper::ConnectManualAsync),
+        InstanceMethod("selectGroupAsync", &HueWrapper::SelectGroupAsync),
+        InstanceMethod("startAsync", &HueWrapper::StartAsync),
         // RGB methods
         InstanceMethod("setColorRGB", &HueWrapper::SetColorRGB),
         InstanceMethod("setColorRGBA", &HueWrapper::SetColorRGBA),
@@ -95,26 +348,118 @@ Napi::Object HueWrapper::Init(Napi::Env env, Napi::Object exports) {
         // Brightness control
         InstanceMethod("setBrightness", &HueWrapper::SetBrightness),
         InstanceMethod("setLightBrightness", &HueWrapper::SetLightBrightness),
+        // Whole-frame submission
+        InstanceMethod("setFrame", &HueWrapper::SetFrame),
+        InstanceMethod("setLightTransition", &HueWrapper::SetLightTransition),
+        InstanceMethod("setLightTransitions", &HueWrapper::SetLightTransitions),
+        // Named blend layers
+        InstanceMethod("createLayer", &HueWrapper::CreateLayer),
+        InstanceMethod("setLayerOptions", &HueWrapper::SetLayerOptions),
+        InstanceMethod("setLayerFrame", &HueWrapper::SetLayerFrame),
+        InstanceMethod("clearLayer", &HueWrapper::ClearLayer),
+        InstanceMethod("removeLayer", &HueWrapper::RemoveLayer),
+        InstanceMethod("getLayers", &HueWrapper::GetLayers),
+        InstanceMethod("attachSharedFrames", &HueWrapper::AttachSharedFrames),
+        InstanceMethod("detachSharedFrames", &HueWrapper::DetachSharedFrames),
+        // Native effects
+        InstanceMethod("startEffect", &HueWrapper::StartEffect),
+        InstanceMethod("setEffectParams", &HueWrapper::SetEffectParams),
+        InstanceMethod("stopEffect", &HueWrapper::StopEffect),
+        InstanceMethod("isEffectRunning", &HueWrapper::IsEffectRunning),
+        InstanceMethod("seekEffect", &HueWrapper::SeekEffect),
+        InstanceMethod("loadTimeline", &HueWrapper::LoadTimeline),
+        InstanceMethod("playTimeline", &HueWrapper::PlayTimeline),
+        InstanceMethod("unloadTimeline", &HueWrapper::UnloadTimeline),
+        InstanceMethod("playSequence", &HueWrapper::PlaySequence),
+        InstanceMethod("setField", &HueWrapper::SetField),
+        InstanceMethod("getLightPositions", &HueWrapper::GetLightPositions),
+        InstanceMethod("getCapturedFrames", &HueWrapper::GetCapturedFrames),
+        InstanceMethod("clearCapturedFrames", &HueWrapper::ClearCapturedFrames),
+        InstanceMethod("startCapture", &HueWrapper::StartCapture),
+        InstanceMethod("stopCapture", &HueWrapper::StopCapture),
+        InstanceMethod("startReplay", &HueWrapper::StartReplay),
+        InstanceMethod("stopReplay", &HueWrapper::StopReplay),
         InstanceMethod("getLightIds", &HueWrapper::GetLightIds),
+        InstanceMethod("getAllocationCount", &HueWrapper::GetAllocationCount),
         InstanceMethod("update", &HueWrapper::Update),
         InstanceMethod("getStatus", &HueWrapper::GetStatus),
+        InstanceMethod("getStats", &HueWrapper::GetStats),
+        InstanceMethod("setRatePolicy", &HueWrapper::SetRatePolicy),
+        InstanceMethod("getRatePolicy", &HueWrapper::GetRatePolicy),
+        InstanceMethod("setOutputCorrection", &HueWrapper::SetOutputCorrection),
+        InstanceMethod("getOutputCorrection", &HueWrapper::GetOutputCorrection),
+        InstanceMethod("setWarmStart", &HueWrapper::SetWarmStart),
+        InstanceMethod("getWarmStart", &HueWrapper::GetWarmStart),
+        InstanceMethod("setFrameCallback", &HueWrapper::SetFrameCallback),
+        InstanceMethod("clearFrameCallback", &HueWrapper::ClearFrameCallback),
+        InstanceMethod("setStateCallback", &HueWrapper::SetStateCallback),
+        InstanceMethod("clearStateCallback", &HueWrapper::ClearStateCallback),
         InstanceMethod("shutdown", &HueWrapper::Shutdown)
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    env.GetInstanceData<AddonData>()->hueWrapper = Napi::Persistent(func);
     exports.Set("HueWrapper", func);
     return exports;
 }
 
+// Reads the optional { backend, lights, captureFrames, handshakeMs, discoveryMs } constructor options;
+// throws a JS error on failure
+static bool ReadBackendOptions(Napi::Env env, const Napi::Value& value, BackendOptions& options) {
+    if (!value.IsObject()) {
+        return true;
+    }
+
+    Napi::Object object = value.As<Napi::Object>();
+    if (object.Has("backend")) {
+        std::string backend = object.Get("backend").ToString().Utf8Value();
+        if (backend == "edk") {
+            options.kind = BackendKind::Edk;
+        } else if (backend == "simulated") {
+            options.kind = BackendKind::Simulated;
+        } else {
+            Napi::RangeError::New(env, "Unknown backend: " + backend).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    if (object.Has("lights")) {
+        int lights = object.Get("lights").ToNumber().Int32Value();
+        if (lights < 1) {
+            Napi::RangeError::New(env, "lights must be at least 1").ThrowAsJavaScriptException();
+            return false;
+        }
+        options.lights = static_cast<size_t>(lights);
+    }
+    if (object.Has("captureFrames")) {
+        int frames = object.Get("captureFrames").ToNumber().Int32Value();
+        if (frames < 1) {
+            Napi::RangeError::New(env, "captureFrames must be at least 1").ThrowAsJavaScriptException();
+            return false;
+        }
+        options.captureFrames = static_cast<size_t>(frames);
+    }
+    if (object.Has("handshakeMs")) {
+        options.handshakeMs = object.Get("handshakeMs").ToNumber().Int32Value();
+        if (options.handshakeMs < 0) {
+            Napi::RangeError::New(env, "handshakeMs must not be negative").ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    if (object.Has("discoveryMs")) {
+        options.discoveryMs = object.Get("discoveryMs").ToNumber().Int32Value();
+        if (options.discoveryMs < 0) {
+            Napi::RangeError::New(env, "discoveryMs must not be negative").ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    return true;
+}
+
 HueWrapper::HueWrapper(const Napi::CallbackInfo& info) 
-    : Napi::ObjectWrap<HueWrapper>(info), 
-      initialized_(false),
-      connected_(false),
-      streaming_(false),
-      selectedGroupId_("0") {
+    : Napi::ObjectWrap<HueWrapper>(info) {
     
     Napi::Env env = info.Env();
+    addon_ = env.GetInstanceData<AddonData>();
+    addon_->wrappers.insert(this);
     
     if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
         Napi::TypeError::New(env, "Expected appName and deviceName")
@@ -124,23 +469,28 @@ HueWrapper::HueWrapper(const Napi::CallbackInfo& info)
 
     appName_ = info[0].As<Napi::String>().Utf8Value();
     deviceName_ = info[1].As<Napi::String>().Utf8Value();
+    ReadBackendOptions(env, info.Length() > 2 ? info[2] : env.Undefined(), backendOptions_);
 }
 
 HueWrapper::~HueWrapper() {
+    addon_->wrappers.erase(this);
     std::lock_guard<std::mutex> lock(mutex_);
-    if (hueStream_) {
-        if (streaming_) {
-            hueStream_->Stop();
-        }
-        hueStream_->ShutDown();
+    StopFrameClock();
+    if (scheduler_) {
+        scheduler_->Stop();
+    }
+    if (session_) {
+        session_->SetStateListener(nullptr);
     }
+    session_.reset();
+    StopStateEvents();
 }
 
 Napi::Value HueWrapper::Initialize(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     std::lock_guard<std::mutex> lock(mutex_);
     
-    if (initialized_) {
+    if (session_) {
         Napi::Object result = Napi::Object::New(env);
         result.Set("success", Napi::Boolean::New(env, true));
         result.Set("message", Napi::String::New(env, "Already initialized"));
@@ -148,26 +498,21 @@ Napi::Value HueWrapper::Initialize(const Napi::CallbackInfo& info) {
     }
     
     try {
-        // Create HueStream config for UDP streaming
-        PersistenceEncryptionKey encKey("default_key");
-        config_ = std::make_shared<Config>(appName_, deviceName_, encKey);
-        
-        // Use DTLS for secure streaming with valid entertainment credentials
-        config_->SetStreamingMode(STREAMING_MODE_DTLS);
-        
-        // Enable render thread for automatic UDP packet sending at 60Hz
-        config_->GetAppSettings()->SetUseRenderThread(true);
-        // Let EDK auto-start streaming after group selection (default behavior)
-        // config_->GetAppSettings()->SetAutoStartAtConnection(false); // REMOVED - use default
-        config_->GetStreamSettings()->SetUpdateFrequency(60);
-        
-        // Create HueStream instance with EDK
-        hueStream_ = std::make_unique<HueStream>(config_);
-        
-        // Don't create ManualEffect here - wait until streaming is ready
-        
-        initialized_ = true;
-        
+        // Rendered at 60Hz by our own scheduler; it only starts sending once
+        // the session streams
+        session_ = std::make_shared<StreamSession>(appName_, deviceName_, true, backendOptions_);
+        session_->SetRatePolicy(ratePolicy_);
+        session_->SetOutputCorrection(correction_);
+        session_->SetWarmStartPath(warmStartPath_);
+        if (stateEvents_) {
+            StateEvents* events = stateEvents_;
+            session_->SetStateListener([events](SessionEvent event) { events->Post(event); });
+        }
+        statsWindow_ = StatsWindow();
+        scheduler_ = std::make_unique<RenderScheduler>(60);
+        scheduler_->Add(session_);
+        scheduler_->Start();
+
         Napi::Object result = Napi::Object::New(env);
         result.Set("success", Napi::Boolean::New(env, true));
         result.Set("streamingMode", Napi::String::New(env, "DTLS"));
@@ -181,47 +526,46 @@ Napi::Value HueWrapper::Initialize(const Napi::CallbackInfo& info) {
     }
 }
 
+// Reads { id, ip, username, clientKey }; throws a JS TypeError on failure
+static bool ReadBridgeCredentials(Napi::Env env, const Napi::Value& value, BridgeCredentials& credentials) {
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Expected bridge config object")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Object config = value.As<Napi::Object>();
+    credentials.id = config.Get("id").As<Napi::String>().Utf8Value();
+    credentials.ip = config.Get("ip").As<Napi::String>().Utf8Value();
+    credentials.username = config.Get("username").As<Napi::String>().Utf8Value();
+    credentials.clientKey = config.Get("clientKey").As<Napi::String>().Utf8Value();
+    return true;
+}
+
 Napi::Value HueWrapper::ConnectManual(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (!initialized_ || !hueStream_) {
+    if (!session_) {
         Napi::Error::New(env, "Not initialized").ThrowAsJavaScriptException();
         return env.Undefined();
     }
     
-    if (info.Length() < 1 || !info[0].IsObject()) {
-        Napi::TypeError::New(env, "Expected bridge config object")
-            .ThrowAsJavaScriptException();
+    BridgeCredentials credentials;
+    if (!ReadBridgeCredentials(env, info.Length() > 0 ? info[0] : env.Undefined(), credentials)) {
         return env.Undefined();
     }
     
-    Napi::Object config = info[0].As<Napi::Object>();
-    
     try {
         std::lock_guard<std::mutex> lock(mutex_);
-        
-        // Extract bridge info
-        std::string bridgeId = config.Get("id").As<Napi::String>().Utf8Value();
-        std::string ipAddress = config.Get("ip").As<Napi::String>().Utf8Value();
-        std::string username = config.Get("username").As<Napi::String>().Utf8Value();
-        std::string clientKey = config.Get("clientKey").As<Napi::String>().Utf8Value();
-        
-        // Create bridge with EDK
-        auto bridgeSettings = std::make_shared<BridgeSettings>();
-        auto bridge = std::make_shared<Bridge>(bridgeId, ipAddress, true, bridgeSettings);
-        
-        // Set credentials for UDP/DTLS streaming
-        bridge->SetUser(username);
-        bridge->SetClientKey(clientKey);
-        
-        // Connect via EDK (blocking call - waits until ready)
-        hueStream_->ConnectManualBridgeInfo(bridge);
-        
-        // Check connection result
-        auto result = hueStream_->GetConnectionResult();
-        connected_ = (result == ConnectResult::ReadyToStart || result == ConnectResult::Streaming);
-        
-        return Napi::Boolean::New(env, connected_);
+        bool connected;
+        {
+            std::lock_guard<std::mutex> connecting(connectMutex_);
+            connected = session_->Connect(credentials);
+        }
+        if (connected && session_->WarmStarted()) {
+            FinishWarmStart(env);
+        }
+        return Napi::Boolean::New(env, connected);
         
     } catch (const std::exception& e) {
         Napi::Error::New(env, std::string("Bridge connection failed: ") + e.what())
@@ -233,7 +577,7 @@ Napi::Value HueWrapper::ConnectManual(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SelectGroup(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (!initialized_ || !hueStream_) {
+    if (!session_) {
         Napi::Error::New(env, "Not initialized").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -247,10 +591,11 @@ Napi::Value HueWrapper::SelectGroup(const Napi::CallbackInfo& info) {
             groupId = info[0].As<Napi::String>().Utf8Value();
         }
         
-        selectedGroupId_ = groupId;
-        
-        // Select group via EDK (blocking call - waits until ready)
-        hueStream_->SelectGroup(groupId);
+        {
+            std::lock_guard<std::mutex> connecting(connectMutex_);
+            session_->SelectGroup(groupId);
+        }
+        session_->SyncLightTable();
         
         return Napi::Boolean::New(env, true);
         
@@ -264,41 +609,20 @@ Napi::Value HueWrapper::SelectGroup(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::Start(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (!initialized_ || !hueStream_ || !connected_) {
+    if (!session_ || !session_->IsConnected()) {
         Napi::Error::New(env, "Not connected to bridge").ThrowAsJavaScriptException();
         return env.Undefined();
     }
     
     try {
         std::lock_guard<std::mutex> lock(mutex_);
-        
-        // With auto-start enabled, streaming should already be active after group selection
-        // Check if bridge is streaming
-        streaming_ = hueStream_->IsBridgeStreaming();
-        
-        if (!streaming_) {
-            // If not streaming, it means group selection hasn't triggered auto-start yet
-            // This shouldn't happen with proper group selection, but handle it
-            return Napi::Boolean::New(env, false);
-        }
-        
-        // Create ManualEffect if not already created
-        if (!manualEffect_) {
-            manualEffect_ = std::make_shared<ManualEffect>("manual_effect", 1);
-            
-            // Add effect to mixer
-            hueStream_->LockMixer();
-            hueStream_->AddEffect(manualEffect_);
-            manualEffect_->Enable();
-            hueStream_->UnlockMixer();
-        } else {
-            // Effect already exists, just enable it
-            hueStream_->LockMixer();
-            manualEffect_->Enable();
-            hueStream_->UnlockMixer();
+
+        bool started = session_->StartStreaming();
+        if (started) {
+            // Group lights may only be resolved once streaming has started
+            session_->SyncLightTable();
         }
-        
-        return Napi::Boolean::New(env, true);
+        return Napi::Boolean::New(env, started);
         
     } catch (const std::exception& e) {
         Napi::Error::New(env, std::string("Streaming start failed: ") + e.what())
@@ -307,26 +631,125 @@ Napi::Value HueWrapper::Start(const Napi::CallbackInfo& info) {
     }
 }
 
+// ============= Async Connection Methods =============
+
+// Optional timeout argument in ms for the async methods
+static std::chrono::milliseconds ReadTimeout(const Napi::CallbackInfo& info, size_t index) {
+    if (info.Length() > index && info[index].IsNumber()) {
+        return std::chrono::milliseconds(info[index].As<Napi::Number>().Int64Value());
+    }
+    return std::chrono::milliseconds(5000);
+}
+
+Napi::Value HueWrapper::ConnectManualAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_) {
+        Napi::Error::New(env, "Not initialized").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    BridgeCredentials credentials;
+    if (!ReadBridgeCredentials(env, info.Length() > 0 ? info[0] : env.Undefined(), credentials)) {
+        return env.Undefined();
+    }
+
+    // With a warm start the stream is already up when this resolves. The
+    // worker keeps its own reference: close() may drop session_ meanwhile.
+    std::shared_ptr<StreamSession> session = session_;
+    auto* worker = new EdkWorker(env, this, "Bridge connection failed: ", [this, session, credentials]() {
+        std::lock_guard<std::mutex> connecting(connectMutex_);
+        return session->Connect(credentials);
+    }, [this, session, env]() {
+        if (session != session_) {
+            return false;
+        }
+        if (session_->WarmStarted()) {
+            FinishWarmStart(env);
+        }
+        return true;
+    });
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value HueWrapper::SelectGroupAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_) {
+        Napi::Error::New(env, "Not initialized").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string groupId = "200";
+    if (info.Length() > 0 && info[0].IsString()) {
+        groupId = info[0].As<Napi::String>().Utf8Value();
+    }
+    std::chrono::milliseconds timeout = ReadTimeout(info, 1);
+
+    // Resolves true once the bridge is streaming to the group
+    std::shared_ptr<StreamSession> session = session_;
+    auto* worker = new EdkWorker(env, this, "Group selection failed: ", [this, session, groupId, timeout]() {
+        std::lock_guard<std::mutex> connecting(connectMutex_);
+        session->SelectGroup(groupId);
+        return session->WaitForStreaming(timeout);
+    }, [this, session]() {
+        if (session != session_) {
+            return false;
+        }
+        session_->SyncLightTable();
+        return true;
+    });
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value HueWrapper::StartAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_ || !session_->IsConnected()) {
+        Napi::Error::New(env, "Not connected to bridge").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::chrono::milliseconds timeout = ReadTimeout(info, 0);
+
+    // Only the wait runs on the pool; the layers are added on the JS thread,
+    // where the setters read them
+    std::shared_ptr<StreamSession> session = session_;
+    auto* worker = new EdkWorker(env, this, "Streaming start failed: ", [this, session, timeout]() {
+        std::lock_guard<std::mutex> connecting(connectMutex_);
+        return session->WaitForStreaming(timeout);
+    }, [this, session]() {
+        if (session != session_ || !session_->StartStreaming()) {
+            return false;
+        }
+        // Group lights may only be resolved once streaming has started
+        session_->SyncLightTable();
+        return true;
+    });
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
 Napi::Value HueWrapper::GetLightIds(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (!hueStream_ || !hueStream_->GetActiveBridge()) {
+    if (!session_ || !session_->ActiveBridge()) {
         Napi::Error::New(env, "Not connected to bridge").ThrowAsJavaScriptException();
         return env.Undefined();
     }
     
     try {
-        Napi::Array lightIds = Napi::Array::New(env);
-        
-        auto bridge = hueStream_->GetActiveBridge();
-        if (bridge && bridge->GetGroup()) {
-            auto lights = bridge->GetGroup()->GetLights();
-            if (lights) {
-                uint32_t index = 0;
-                for (auto& light : *lights) {
-                    lightIds.Set(index++, Napi::String::New(env, light->GetId()));
-                }
-            }
+        session_->SyncLightTable();
+        const LightTable& lights = session_->Lights();
+
+        Napi::Array lightIds = Napi::Array::New(env, lights.Size());
+        for (size_t slot = 0; slot < lights.Size(); ++slot) {
+            lightIds.Set(static_cast<uint32_t>(slot), Napi::String::New(env, lights.Id(slot)));
         }
         
         return lightIds;
@@ -338,10 +761,16 @@ Napi::Value HueWrapper::GetLightIds(const Napi::CallbackInfo& info) {
     }
 }
 
+Napi::Value HueWrapper::GetAllocationCount(const Napi::CallbackInfo& info) {
+    // Heap allocations on the JS thread so far; compare two readings around a
+    // burst of setter calls to confirm the streaming path does not allocate
+    return Napi::Number::New(info.Env(), static_cast<double>(ThreadAllocationCount()));
+}
+
 Napi::Value HueWrapper::Update(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    // With render thread enabled, updates happen automatically
+    // The render scheduler sends frames automatically
     // This method is kept for compatibility but isn't needed
     
     return Napi::Boolean::New(env, true);
@@ -353,20 +782,12 @@ Napi::Value HueWrapper::Stop(const Napi::CallbackInfo& info) {
     try {
         std::lock_guard<std::mutex> lock(mutex_);
 
-        // Disable the effect but keep it in the mixer
-        if (manualEffect_) {
-            hueStream_->LockMixer();
-            manualEffect_->Disable();
-            hueStream_->UnlockMixer();
+        // With auto-start, we typically don't stop streaming: the effects
+        // are disabled but stay in the mixer, and streaming continues
+        if (session_) {
+            session_->Halt();
         }
 
-        // With auto-start, we typically don't stop streaming
-        // Just disable effects and let streaming continue
-        // Only stop if explicitly needed (e.g., switching groups)
-
-        // Note: We don't call hueStream_->Stop() here with auto-start
-        // Streaming continues, effects are just disabled
-
         return Napi::Boolean::New(env, true);
 
     } catch (const std::exception&) {
@@ -379,7 +800,7 @@ Napi::Value HueWrapper::Stop(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetColorRGB(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -397,18 +818,8 @@ Napi::Value HueWrapper::SetColorRGB(const Napi::CallbackInfo& info) {
         // Create color with RGB only (alpha defaults to 1.0)
         Color color(r, g, b);
 
-        auto bridge = hueStream_->GetActiveBridge();
-        if (bridge && bridge->GetGroup()) {
-            auto lights = bridge->GetGroup()->GetLights();
-            if (lights) {
-                hueStream_->LockMixer();
-                for (auto& light : *lights) {
-                    manualEffect_->SetIdToColor(light->GetId(), color);
-                }
-                manualEffect_->Enable();
-                hueStream_->UnlockMixer();
-            }
-        }
+        session_->Frame().SetAll(color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -422,7 +833,7 @@ Napi::Value HueWrapper::SetColorRGB(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetColorRGBA(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -441,18 +852,8 @@ Napi::Value HueWrapper::SetColorRGBA(const Napi::CallbackInfo& info) {
         // Create color with RGBA
         Color color(r, g, b, alpha);
 
-        auto bridge = hueStream_->GetActiveBridge();
-        if (bridge && bridge->GetGroup()) {
-            auto lights = bridge->GetGroup()->GetLights();
-            if (lights) {
-                hueStream_->LockMixer();
-                for (auto& light : *lights) {
-                    manualEffect_->SetIdToColor(light->GetId(), color);
-                }
-                manualEffect_->Enable();
-                hueStream_->UnlockMixer();
-            }
-        }
+        session_->Frame().SetAll(color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -466,7 +867,7 @@ Napi::Value HueWrapper::SetColorRGBA(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetLightColorRGB(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -485,10 +886,12 @@ Napi::Value HueWrapper::SetLightColorRGB(const Napi::CallbackInfo& info) {
         // Create color with RGB only
         Color color(r, g, b);
 
-        hueStream_->LockMixer();
-        manualEffect_->SetIdToColor(std::to_string(lightId), color);
-        manualEffect_->Enable();
-        hueStream_->UnlockMixer();
+        int slot = session_->Lights().SlotForId(lightId);
+        if (slot < 0) {
+            return Napi::Boolean::New(env, false);
+        }
+        session_->Frame().SetColor(slot, color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -502,7 +905,7 @@ Napi::Value HueWrapper::SetLightColorRGB(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetLightColorRGBA(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -522,10 +925,12 @@ Napi::Value HueWrapper::SetLightColorRGBA(const Napi::CallbackInfo& info) {
         // Create color with RGBA
         Color color(r, g, b, alpha);
 
-        hueStream_->LockMixer();
-        manualEffect_->SetIdToColor(std::to_string(lightId), color);
-        manualEffect_->Enable();
-        hueStream_->UnlockMixer();
+        int slot = session_->Lights().SlotForId(lightId);
+        if (slot < 0) {
+            return Napi::Boolean::New(env, false);
+        }
+        session_->Frame().SetColor(slot, color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -541,7 +946,7 @@ Napi::Value HueWrapper::SetLightColorRGBA(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetColorXY(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -560,18 +965,8 @@ Napi::Value HueWrapper::SetColorXY(const Napi::CallbackInfo& info) {
         double xy[2] = {x, y};
         Color color(xy, brightness);
 
-        auto bridge = hueStream_->GetActiveBridge();
-        if (bridge && bridge->GetGroup()) {
-            auto lights = bridge->GetGroup()->GetLights();
-            if (lights) {
-                hueStream_->LockMixer();
-                for (auto& light : *lights) {
-                    manualEffect_->SetIdToColor(light->GetId(), color);
-                }
-                manualEffect_->Enable();
-                hueStream_->UnlockMixer();
-            }
-        }
+        session_->Frame().SetAll(color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -585,7 +980,7 @@ Napi::Value HueWrapper::SetColorXY(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetLightColorXY(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -605,10 +1000,12 @@ Napi::Value HueWrapper::SetLightColorXY(const Napi::CallbackInfo& info) {
         double xy[2] = {x, y};
         Color color(xy, brightness);
 
-        hueStream_->LockMixer();
-        manualEffect_->SetIdToColor(std::to_string(lightId), color);
-        manualEffect_->Enable();
-        hueStream_->UnlockMixer();
+        int slot = session_->Lights().SlotForId(lightId);
+        if (slot < 0) {
+            return Napi::Boolean::New(env, false);
+        }
+        session_->Frame().SetColor(slot, color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -624,7 +1021,7 @@ Napi::Value HueWrapper::SetLightColorXY(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetColorCT(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -641,18 +1038,8 @@ Napi::Value HueWrapper::SetColorCT(const Napi::CallbackInfo& info) {
         // Create color from color temperature
         Color color(ct, brightness, 254);
 
-        auto bridge = hueStream_->GetActiveBridge();
-        if (bridge && bridge->GetGroup()) {
-            auto lights = bridge->GetGroup()->GetLights();
-            if (lights) {
-                hueStream_->LockMixer();
-                for (auto& light : *lights) {
-                    manualEffect_->SetIdToColor(light->GetId(), color);
-                }
-                manualEffect_->Enable();
-                hueStream_->UnlockMixer();
-            }
-        }
+        session_->Frame().SetAll(color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -666,7 +1053,7 @@ Napi::Value HueWrapper::SetColorCT(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetLightColorCT(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -684,10 +1071,12 @@ Napi::Value HueWrapper::SetLightColorCT(const Napi::CallbackInfo& info) {
         // Create color from color temperature
         Color color(ct, brightness, 254);
 
-        hueStream_->LockMixer();
-        manualEffect_->SetIdToColor(std::to_string(lightId), color);
-        manualEffect_->Enable();
-        hueStream_->UnlockMixer();
+        int slot = session_->Lights().SlotForId(lightId);
+        if (slot < 0) {
+            return Napi::Boolean::New(env, false);
+        }
+        session_->Frame().SetColor(slot, color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -703,7 +1092,7 @@ Napi::Value HueWrapper::SetLightColorCT(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetBrightness(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -720,18 +1109,8 @@ Napi::Value HueWrapper::SetBrightness(const Napi::CallbackInfo& info) {
         Color color(1.0, 1.0, 1.0);
         color.ApplyBrightness(brightness);
 
-        auto bridge = hueStream_->GetActiveBridge();
-        if (bridge && bridge->GetGroup()) {
-            auto lights = bridge->GetGroup()->GetLights();
-            if (lights) {
-                hueStream_->LockMixer();
-                for (auto& light : *lights) {
-                    manualEffect_->SetIdToColor(light->GetId(), color);
-                }
-                manualEffect_->Enable();
-                hueStream_->UnlockMixer();
-            }
-        }
+        session_->Frame().SetAll(color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -745,7 +1124,7 @@ Napi::Value HueWrapper::SetBrightness(const Napi::CallbackInfo& info) {
 Napi::Value HueWrapper::SetLightBrightness(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (!hueStream_ || !hueStream_->IsBridgeStreaming() || !manualEffect_) {
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
         Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
         return env.Undefined();
     }
@@ -763,10 +1142,12 @@ Napi::Value HueWrapper::SetLightBrightness(const Napi::CallbackInfo& info) {
         Color color(1.0, 1.0, 1.0);
         color.ApplyBrightness(brightness);
 
-        hueStream_->LockMixer();
-        manualEffect_->SetIdToColor(std::to_string(lightId), color);
-        manualEffect_->Enable();
-        hueStream_->UnlockMixer();
+        int slot = session_->Lights().SlotForId(lightId);
+        if (slot < 0) {
+            return Napi::Boolean::New(env, false);
+        }
+        session_->Frame().SetColor(slot, color);
+        session_->PublishFrame();
 
         return Napi::Boolean::New(env, true);
 
@@ -777,78 +1158,2207 @@ Napi::Value HueWrapper::SetLightBrightness(const Napi::CallbackInfo& info) {
     }
 }
 
-Napi::Value HueWrapper::GetStatus(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    Napi::Object status = Napi::Object::New(env);
-    status.Set("initialized", Napi::Boolean::New(env, initialized_));
-    status.Set("connected", Napi::Boolean::New(env, connected_));
-    // Check actual streaming status
-    bool isStreaming = hueStream_ ? hueStream_->IsBridgeStreaming() : false;
-    status.Set("streaming", Napi::Boolean::New(env, isStreaming));
-    status.Set("appName", Napi::String::New(env, appName_));
-    status.Set("deviceName", Napi::String::New(env, deviceName_));
-    status.Set("streamingMode", Napi::String::New(env, "DTLS"));
-    status.Set("selectedGroup", Napi::String::New(env, selectedGroupId_));
-    
-    if (initialized_ && hueStream_) {
-        auto bridge = hueStream_->GetActiveBridge();
-        if (bridge) {
-            Napi::Object bridgeInfo = Napi::Object::New(env);
-            bridgeInfo.Set("id", Napi::String::New(env, bridge->GetId()));
-            bridgeInfo.Set("ip", Napi::String::New(env, bridge->GetIpAddress()));
-            bridgeInfo.Set("connected", Napi::Boolean::New(env, bridge->IsConnected()));
-            bridgeInfo.Set("streaming", Napi::Boolean::New(env, bridge->IsStreaming()));
-            status.Set("bridge", bridgeInfo);
+// ============= Frame Methods =============
+
+enum class FrameFormat { RGB, RGBA, XY, CT };
+
+// Values per light for each frame format
+static size_t FrameStride(FrameFormat format) {
+    switch (format) {
+        case FrameFormat::RGB:  return 3;  // r, g, b (0-255)
+        case FrameFormat::RGBA: return 4;  // r, g, b (0-255), alpha (0-1, or 0-255 for Uint8Array)
+        case FrameFormat::XY:   return 3;  // x, y, brightness (0-1)
+        case FrameFormat::CT:   return 2;  // mireds, brightness (0-1)
+    }
+    return 0;
+}
+
+static bool ParseFrameFormat(const std::string& name, FrameFormat& format) {
+    if (name == "rgb") { format = FrameFormat::RGB; return true; }
+    if (name == "rgba") { format = FrameFormat::RGBA; return true; }
+    if (name == "xy") { format = FrameFormat::XY; return true; }
+    if (name == "ct") { format = FrameFormat::CT; return true; }
+    return false;
+}
+
+// Builds the EDK color for one light from its slice of the frame buffer.
+// Uint8Array frames carry every channel (including alpha) as 0-255 bytes.
+template <typename T>
+static Color FrameColor(const T* values, FrameFormat format, double channelScale) {
+    switch (format) {
+        case FrameFormat::RGB:
+            return Color(values[0] / 255.0, values[1] / 255.0, values[2] / 255.0);
+        case FrameFormat::RGBA:
+            return Color(values[0] / 255.0, values[1] / 255.0, values[2] / 255.0,
+                         values[3] / channelScale);
+        case FrameFormat::XY: {
+            double xy[2] = {static_cast<double>(values[0]), static_cast<double>(values[1])};
+            return Color(xy, static_cast<double>(values[2]));
         }
+        case FrameFormat::CT:
+            return Color(static_cast<int>(values[0]), static_cast<double>(values[1]), 254);
     }
-    
-    return status;
+    return Color();
 }
 
-Napi::Value HueWrapper::Shutdown(const Napi::CallbackInfo& info) {
+// Shared by HueWrapper::setFrame(lightIds, data, format) and
+// HueSessionManager::setFrame(sessionId, lightIds, data, format); the frame
+// arguments start at info[first]
+static Napi::Value ApplyFrame(const Napi::CallbackInfo& info, size_t first, StreamSession* session,
+                              const std::string* layerName = nullptr,
+                              const Transition& transition = Transition()) {
     Napi::Env env = info.Env();
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    try {
-        // First disable the effect
-        if (manualEffect_ && hueStream_) {
-            hueStream_->LockMixer();
-            manualEffect_->Disable();
-            // Note: Effects are cleared when ShutDown() is called
-            hueStream_->UnlockMixer();
+
+    if (!session || !session->IsStreaming() || !session->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    FrameEffect* target = layerName ? session->Layers()->Find(*layerName) : &session->Frame();
+    if (!target) {
+        Napi::Error::New(env, "Unknown layer: " + *layerName).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (info.Length() < first + 3 || !(info[first].IsTypedArray() || info[first].IsArray()) ||
+        !info[first + 1].IsTypedArray() || !info[first + 2].IsString()) {
+        Napi::TypeError::New(env, "Expected lightIds, frame data (Float32Array or Uint8Array), format")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    FrameFormat format;
+    if (!ParseFrameFormat(info[first + 2].As<Napi::String>().Utf8Value(), format)) {
+        Napi::TypeError::New(env, "Frame format must be 'rgb', 'rgba', 'xy' or 'ct'")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::TypedArray data = info[first + 1].As<Napi::TypedArray>();
+    bool isFloat = data.TypedArrayType() == napi_float32_array;
+    if (!isFloat && data.TypedArrayType() != napi_uint8_array) {
+        Napi::TypeError::New(env, "Frame data must be a Float32Array or Uint8Array")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!isFloat && (format == FrameFormat::XY || format == FrameFormat::CT)) {
+        Napi::TypeError::New(env, "XY and CT frames require a Float32Array")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Light IDs are read straight from an Int32Array when possible so a frame
+    // costs no per-light JS handles; plain arrays are accepted for convenience
+    const int32_t* idData = nullptr;
+    Napi::Array idArray;
+    size_t count = 0;
+    if (info[first].IsTypedArray()) {
+        Napi::TypedArray ids = info[first].As<Napi::TypedArray>();
+        if (ids.TypedArrayType() != napi_int32_array) {
+            Napi::TypeError::New(env, "lightIds must be an Int32Array or an array of numbers")
+                .ThrowAsJavaScriptException();
+            return env.Undefined();
         }
-        
-        // Stop streaming if active (check actual status)
-        if (hueStream_ && hueStream_->IsBridgeStreaming()) {
-            hueStream_->Stop();
+        idData = ids.As<Napi::Int32Array>().Data();
+        count = ids.ElementLength();
+    } else {
+        idArray = info[first].As<Napi::Array>();
+        count = idArray.Length();
+    }
+
+    size_t stride = FrameStride(format);
+    if (data.ElementLength() < count * stride) {
+        Napi::RangeError::New(env, "Frame data is shorter than lightIds.length * channels for format")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    const float* floatValues = isFloat ? data.As<Napi::Float32Array>().Data() : nullptr;
+    const uint8_t* byteValues = isFloat ? nullptr : data.As<Napi::Uint8Array>().Data();
+
+    try {
+        // The whole frame is published to the render thread at once
+        for (size_t i = 0; i < count; ++i) {
+            int lightId = idData ? idData[i]
+                                 : idArray.Get(static_cast<uint32_t>(i)).As<Napi::Number>().Int32Value();
+            int slot = session->Lights().SlotForId(lightId);
+            if (slot < 0) {
+                continue;
+            }
+            Color color = isFloat ? FrameColor(floatValues + i * stride, format, 1.0)
+                                  : FrameColor(byteValues + i * stride, format, 255.0);
+            target->SetColor(slot, color, transition);
         }
-        streaming_ = false;
-        
-        // Shutdown HueStream
-        if (initialized_ && hueStream_) {
-            hueStream_->ShutDown();
+        if (layerName) {
+            session->PublishLayer(*target);
+        } else {
+            session->PublishFrame();
         }
-        
-        // Clean up all resources
-        manualEffect_.reset();
-        hueStream_.reset();
-        config_.reset();
-        initialized_ = false;
-        connected_ = false;
-        
+
         return Napi::Boolean::New(env, true);
-        
+
     } catch (const std::exception& e) {
-        return Napi::Boolean::New(env, false);
+        Napi::Error::New(env, std::string("SetFrame failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
     }
 }
 
-// Module initialization
-Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
-    // Initialize main wrapper
+Napi::Value HueWrapper::SetFrame(const Napi::CallbackInfo& info) {
+    return ApplyFrame(info, 0, session_.get());
+}
+
+// ============= Transitions =============
+
+// Reads durationMs at info[index] and an optional easing name after it;
+// throws a JS error on failure
+static bool ReadTransition(const Napi::CallbackInfo& info, size_t index, Transition& transition) {
+    Napi::Env env = info.Env();
+    if (info.Length() <= index || !info[index].IsNumber()) {
+        Napi::TypeError::New(env, "Expected transition duration in ms").ThrowAsJavaScriptException();
+        return false;
+    }
+    transition.durationMs = info[index].As<Napi::Number>().DoubleValue();
+    if (!(transition.durationMs >= 0)) {
+        Napi::RangeError::New(env, "durationMs must not be negative").ThrowAsJavaScriptException();
+        return false;
+    }
+    if (info.Length() > index + 1 && !info[index + 1].IsUndefined()) {
+        std::string easing = info[index + 1].ToString().Utf8Value();
+        if (!ParseEasing(easing, transition.easing)) {
+            Napi::TypeError::New(env, "Unknown easing: " + easing).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    return true;
+}
+
+// setLightTransition(lightId, { r, g, b, a? }, durationMs, easing = 'linear'):
+// the render thread fades the light from what it shows now to the color
+// (0-255, alpha 0-1) over durationMs, so JS only sends the keyframes. 0 sets
+// the color at once.
+Napi::Value HueWrapper::SetLightTransition(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected lightId, { r, g, b }, durationMs").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Transition transition;
+    if (!ReadTransition(info, 2, transition)) {
+        return env.Undefined();
+    }
+
+    try {
+        int slot = session_->Lights().SlotForId(info[0].As<Napi::Number>().Int32Value());
+        if (slot < 0) {
+            return Napi::Boolean::New(env, false);
+        }
+        Napi::Object target = info[1].As<Napi::Object>();
+        double alpha = target.Has("a") ? target.Get("a").ToNumber().DoubleValue() : 1.0;
+        Color color(target.Get("r").ToNumber().DoubleValue() / 255.0,
+                    target.Get("g").ToNumber().DoubleValue() / 255.0,
+                    target.Get("b").ToNumber().DoubleValue() / 255.0, alpha);
+        session_->Frame().SetColor(slot, color, transition);
+        session_->PublishFrame();
+        return Napi::Boolean::New(env, true);
+
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("SetLightTransition failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+// setLightTransitions(lightIds, data, format, durationMs, easing = 'linear'):
+// setFrame() with every light in the frame fading to its new color
+Napi::Value HueWrapper::SetLightTransitions(const Napi::CallbackInfo& info) {
+    Transition transition;
+    if (!ReadTransition(info, 3, transition)) {
+        return info.Env().Undefined();
+    }
+    return ApplyFrame(info, 0, session_.get(), nullptr, transition);
+}
+
+// ============= Named Layers =============
+
+// Reads { priority?, opacity?, blend? } over options; throws a JS error on failure
+static bool ReadLayerOptions(Napi::Env env, const Napi::Value& value, LayerOptions& options) {
+    if (value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Expected layer options object").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object object = value.As<Napi::Object>();
+    if (object.Has("priority")) {
+        options.priority = object.Get("priority").ToNumber().Int32Value();
+    }
+    if (object.Has("opacity")) {
+        double opacity = object.Get("opacity").ToNumber().DoubleValue();
+        if (!(opacity >= 0 && opacity <= 1)) {
+            Napi::RangeError::New(env, "opacity must be between 0 and 1").ThrowAsJavaScriptException();
+            return false;
+        }
+        options.opacity = opacity;
+    }
+    if (object.Has("blend")) {
+        if (!ParseBlendMode(object.Get("blend").ToString().Utf8Value(), options.blend)) {
+            Napi::TypeError::New(env, "blend must be 'normal', 'add', 'multiply' or 'max'")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Layer stack of a streaming session and the layer name in info[0]; throws
+// a JS error and returns nullptr otherwise
+static LayerStack* LayerCall(const Napi::CallbackInfo& info, StreamSession* session, std::string& name) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected layer name").ThrowAsJavaScriptException();
+        return nullptr;
+    }
+    if (!session || !session->IsStreaming() || !session->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return nullptr;
+    }
+    name = info[0].As<Napi::String>().Utf8Value();
+    return session->Layers();
+}
+
+// createLayer(name, { priority = 0, opacity = 1, blend = 'normal' }): false
+// if the name is taken. New layers are transparent.
+Napi::Value HueWrapper::CreateLayer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string name;
+    LayerStack* layers = LayerCall(info, session_.get(), name);
+    LayerOptions options;
+    if (!layers || !ReadLayerOptions(env, info.Length() > 1 ? info[1] : env.Undefined(), options)) {
+        return env.Undefined();
+    }
+
+    session_->LockMixer();
+    bool created = layers->Add(name, options, session_->Lights()) != nullptr;
+    session_->UnlockMixer();
+    return Napi::Boolean::New(env, created);
+}
+
+// setLayerOptions(name, options): fields that are not present keep their value
+Napi::Value HueWrapper::SetLayerOptions(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string name;
+    LayerStack* layers = LayerCall(info, session_.get(), name);
+    LayerOptions options;
+    if (!layers) {
+        return env.Undefined();
+    }
+    if (!layers->GetOptions(name, options)) {
+        return Napi::Boolean::New(env, false);
+    }
+    if (!ReadLayerOptions(env, info.Length() > 1 ? info[1] : env.Undefined(), options)) {
+        return env.Undefined();
+    }
+
+    session_->LockMixer();
+    layers->SetOptions(name, options);
+    session_->UnlockMixer();
+    return Napi::Boolean::New(env, true);
+}
+
+// setLayerFrame(name, lightIds, data, format), same frame layout as setFrame()
+Napi::Value HueWrapper::SetLayerFrame(const Napi::CallbackInfo& info) {
+    std::string name;
+    if (!LayerCall(info, session_.get(), name)) {
+        return info.Env().Undefined();
+    }
+    return ApplyFrame(info, 1, session_.get(), &name);
+}
+
+// clearLayer(name): makes every light of the layer transparent
+Napi::Value HueWrapper::ClearLayer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string name;
+    LayerStack* layers = LayerCall(info, session_.get(), name);
+    if (!layers) {
+        return env.Undefined();
+    }
+    FrameEffect* layer = layers->Find(name);
+    if (!layer) {
+        return Napi::Boolean::New(env, false);
+    }
+    layer->SetAll(Color(0, 0, 0, 0));
+    session_->PublishLayer(*layer);
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value HueWrapper::RemoveLayer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string name;
+    LayerStack* layers = LayerCall(info, session_.get(), name);
+    if (!layers) {
+        return env.Undefined();
+    }
+
+    session_->LockMixer();
+    bool removed = layers->Remove(name);
+    session_->UnlockMixer();
+    return Napi::Boolean::New(env, removed);
+}
+
+// getLayers(): [{ name, priority, opacity, blend }], bottom first
+Napi::Value HueWrapper::GetLayers(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!session_ || !session_->Layers()) {
+        return Napi::Array::New(env, 0);
+    }
+
+    LayerStack* layers = session_->Layers();
+    std::vector<std::string> names = layers->Names();
+    Napi::Array result = Napi::Array::New(env, names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        LayerOptions options;
+        layers->GetOptions(names[i], options);
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("name", Napi::String::New(env, names[i]));
+        entry.Set("priority", Napi::Number::New(env, options.priority));
+        entry.Set("opacity", Napi::Number::New(env, options.opacity));
+        entry.Set("blend", Napi::String::New(env, BlendModeName(options.blend)));
+        result.Set(static_cast<uint32_t>(i), entry);
+    }
+    return result;
+}
+
+// ============= Shared Frame Input =============
+
+// attachSharedFrames(name, lightIds): renders the newest frame of the ring
+// a producer writes to shared memory `name`; frame light i drives lightIds[i]
+Napi::Value HueWrapper::AttachSharedFrames(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsArray()) {
+        Napi::TypeError::New(env, "Expected shared memory name, lightIds").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string name = info[0].As<Napi::String>().Utf8Value();
+    Napi::Array idArray = info[1].As<Napi::Array>();
+    std::vector<int> lightIds;
+    for (uint32_t i = 0; i < idArray.Length(); ++i) {
+        lightIds.push_back(idArray.Get(i).As<Napi::Number>().Int32Value());
+    }
+
+    try {
+        session_->AttachSharedInput(name, lightIds);
+        return Napi::Boolean::New(env, true);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("attachSharedFrames failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+Napi::Value HueWrapper::DetachSharedFrames(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!session_ || !session_->SharedInput() || !session_->SharedInput()->IsAttached()) {
+        return Napi::Boolean::New(env, false);
+    }
+    session_->DetachSharedInput();
+    return Napi::Boolean::New(env, true);
+}
+
+// ============= Native Effect Methods =============
+
+// Reads an array of { r, g, b } (0-255) into colors; throws a JS error on failure
+static bool ReadColorList(Napi::Env env, const Napi::Value& value, std::vector<Rgb>& colors) {
+    if (!value.IsArray()) {
+        Napi::TypeError::New(env, "params.colors must be an array of { r, g, b }").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Array array = value.As<Napi::Array>();
+    colors.clear();
+    for (uint32_t i = 0; i < array.Length(); ++i) {
+        Napi::Value entry = array.Get(i);
+        if (!entry.IsObject()) {
+            Napi::TypeError::New(env, "params.colors must be an array of { r, g, b }")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::Object color = entry.As<Napi::Object>();
+        colors.push_back({
+            color.Get("r").ToNumber().DoubleValue(),
+            color.Get("g").ToNumber().DoubleValue(),
+            color.Get("b").ToNumber().DoubleValue()
+        });
+    }
+    return true;
+}
+
+// Reads { colors?: Color[], period?, rate?, runTime? }, keeping the current
+// values in params for fields that are not present
+static bool ReadEffectParams(Napi::Env env, const Napi::Value& value, EffectParams& params) {
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Expected effect params object").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object object = value.As<Napi::Object>();
+
+    if (object.Has("colors") && !ReadColorList(env, object.Get("colors"), params.colors)) {
+        return false;
+    }
+
+    if (object.Has("period")) {
+        params.period = object.Get("period").ToNumber().DoubleValue();
+    }
+    if (object.Has("rate")) {
+        params.rate = object.Get("rate").ToNumber().DoubleValue();
+    }
+    if (object.Has("runTime")) {
+        params.runTime = object.Get("runTime").ToNumber().DoubleValue();
+    }
+    return true;
+}
+
+// startEffect(name, params, lightIds) on the given session, whose arguments
+// start at info[first]
+static Napi::Value StartSessionEffect(const Napi::CallbackInfo& info, size_t first, StreamSession* session) {
+    Napi::Env env = info.Env();
+
+    if (!session || !session->IsStreaming() || !session->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (info.Length() < first + 3 || !info[first].IsString() || !info[first + 2].IsArray()) {
+        Napi::TypeError::New(env, "Expected effect name, params, lightIds")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string name = info[first].As<Napi::String>().Utf8Value();
+    EffectParams params;
+    if (!ReadEffectParams(env, info[first + 1], params)) {
+        return env.Undefined();
+    }
+
+    Napi::Array idArray = info[first + 2].As<Napi::Array>();
+    std::vector<int> lightIds;
+    for (uint32_t i = 0; i < idArray.Length(); ++i) {
+        lightIds.push_back(idArray.Get(i).As<Napi::Number>().Int32Value());
+    }
+
+    std::unique_ptr<NativeEffect> effect = CreateNativeEffect(name, params);
+    if (!effect) {
+        Napi::Error::New(env, "Unknown native effect: " + name).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    // Periodic effects play one precomputed cycle
+    effect = CacheNativeEffect(name, std::move(effect), lightIds.size());
+
+    try {
+        session->RunEffect(std::move(effect), lightIds);
+        return Napi::Boolean::New(env, true);
+
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("StartEffect failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+Napi::Value HueWrapper::StartEffect(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return StartSessionEffect(info, 0, session_.get());
+}
+
+Napi::Value HueWrapper::SetEffectParams(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_ || !session_->Engine()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // Merge onto the running parameters so callers can change a single field
+    EffectParams params;
+    std::string cacheName;
+    size_t lightCount = 0;
+    session_->LockMixer();
+    bool running = session_->Engine()->GetParams(params);
+    cacheName = session_->Engine()->CacheName();
+    lightCount = session_->Engine()->LightCount();
+    session_->UnlockMixer();
+    if (!running) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    if (!ReadEffectParams(env, info.Length() > 0 ? info[0] : env.Undefined(), params)) {
+        return env.Undefined();
+    }
+
+    // A periodic effect's new cycle is rendered here, while the render
+    // thread keeps running; under the lock it is only looked up
+    std::shared_ptr<const CycleTable> table = PrepareCycleTable(cacheName, params, lightCount);
+
+    session_->LockMixer();
+    bool updated = session_->Engine()->SetParams(params);
+    session_->UnlockMixer();
+
+    return Napi::Boolean::New(env, updated);
+}
+
+Napi::Value HueWrapper::StopEffect(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_ || !session_->Engine()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    session_->LockMixer();
+    bool wasRunning = session_->Engine()->IsRunning();
+    session_->Engine()->Halt();
+    session_->UnlockMixer();
+
+    return Napi::Boolean::New(env, wasRunning);
+}
+
+// False again as soon as the render thread ends a finished effect, sequence
+// or timeline, not only after stopEffect()
+Napi::Value HueWrapper::IsEffectRunning(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    bool running = session_ && session_->Engine() && session_->Engine()->IsActive();
+    return Napi::Boolean::New(env, running);
+}
+
+Napi::Value HueWrapper::SeekEffect(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected time in ms").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!session_ || !session_->Engine()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    double timeMs = info[0].As<Napi::Number>().DoubleValue();
+    session_->LockMixer();
+    bool seeked = session_->Engine()->Seek(timeMs);
+    session_->UnlockMixer();
+
+    return Napi::Boolean::New(env, seeked);
+}
+
+// ============= Timeline Methods =============
+
+// Reads { duration?, loop?, tracks: [{ lightId, keyframes: [{ t, color, easing? }] }] }
+static bool ReadTimelineDefinition(Napi::Env env, const Napi::Object& definition,
+                                   std::vector<TimelineTrack>& tracks, double& durationMs, bool& loop) {
+    durationMs = definition.Has("duration") ? definition.Get("duration").ToNumber().DoubleValue() : 0;
+    loop = definition.Has("loop") && definition.Get("loop").ToBoolean().Value();
+
+    Napi::Value tracksValue = definition.Get("tracks");
+    if (!tracksValue.IsArray()) {
+        Napi::TypeError::New(env, "timeline.tracks must be an array").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Array trackArray = tracksValue.As<Napi::Array>();
+    for (uint32_t i = 0; i < trackArray.Length(); ++i) {
+        Napi::Value trackValue = trackArray.Get(i);
+        if (!trackValue.IsObject() || !trackValue.As<Napi::Object>().Get("keyframes").IsArray()) {
+            Napi::TypeError::New(env, "Each track needs a lightId and a keyframes array")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::Object trackObject = trackValue.As<Napi::Object>();
+        Napi::Array keyArray = trackObject.Get("keyframes").As<Napi::Array>();
+
+        TimelineTrack track;
+        track.lightId = trackObject.Get("lightId").ToNumber().Int32Value();
+        track.keyframes.reserve(keyArray.Length());
+        for (uint32_t k = 0; k < keyArray.Length(); ++k) {
+            Napi::Value keyValue = keyArray.Get(k);
+            if (!keyValue.IsObject() || !keyValue.As<Napi::Object>().Get("color").IsObject()) {
+                Napi::TypeError::New(env, "Each keyframe needs t and color { r, g, b }")
+                    .ThrowAsJavaScriptException();
+                return false;
+            }
+            Napi::Object keyObject = keyValue.As<Napi::Object>();
+            Napi::Object color = keyObject.Get("color").As<Napi::Object>();
+
+            Keyframe key;
+            key.timeMs = keyObject.Get("t").ToNumber().DoubleValue();
+            key.color = {
+                color.Get("r").ToNumber().DoubleValue(),
+                color.Get("g").ToNumber().DoubleValue(),
+                color.Get("b").ToNumber().DoubleValue()
+            };
+            if (keyObject.Has("easing")) {
+                std::string easing = keyObject.Get("easing").ToString().Utf8Value();
+                if (!ParseEasing(easing, key.easing)) {
+                    Napi::TypeError::New(env, "Unknown easing: " + easing).ThrowAsJavaScriptException();
+                    return false;
+                }
+            }
+            track.keyframes.push_back(key);
+        }
+        tracks.push_back(std::move(track));
+    }
+    return true;
+}
+
+// Compiles a timeline given as a definition object, a JSON string or a
+// binary blob (Uint8Array / ArrayBuffer) and returns its handle
+Napi::Value HueWrapper::LoadTimeline(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "Expected timeline definition, JSON string or binary blob")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    try {
+        std::shared_ptr<const Timeline> timeline;
+        Napi::Value source = info[0];
+
+        if (source.IsTypedArray() && source.As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+            Napi::Uint8Array blob = source.As<Napi::Uint8Array>();
+            timeline = Timeline::FromBlob(blob.Data(), blob.ElementLength());
+        } else if (source.IsArrayBuffer()) {
+            Napi::ArrayBuffer blob = source.As<Napi::ArrayBuffer>();
+            timeline = Timeline::FromBlob(static_cast<const uint8_t*>(blob.Data()), blob.ByteLength());
+        } else {
+            if (source.IsString()) {
+                Napi::Object json = env.Global().Get("JSON").As<Napi::Object>();
+                source = json.Get("parse").As<Napi::Function>().Call(json, {source});
+                if (env.IsExceptionPending()) {
+                    return env.Undefined();
+                }
+            }
+            if (!source.IsObject()) {
+                Napi::TypeError::New(env, "Expected timeline definition, JSON string or binary blob")
+                    .ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+
+            std::vector<TimelineTrack> tracks;
+            double durationMs = 0;
+            bool loop = false;
+            if (!ReadTimelineDefinition(env, source.As<Napi::Object>(), tracks, durationMs, loop)) {
+                return env.Undefined();
+            }
+            timeline = Timeline::Compile(std::move(tracks), durationMs, loop);
+        }
+
+        int id = nextTimelineId_++;
+        timelines_[id] = timeline;
+        return Napi::Number::New(env, id);
+
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("LoadTimeline failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+Napi::Value HueWrapper::PlayTimeline(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected timeline handle").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto found = timelines_.find(info[0].As<Napi::Number>().Int32Value());
+    if (found == timelines_.end()) {
+        Napi::Error::New(env, "Unknown timeline handle").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    double startMs = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().DoubleValue() : 0;
+
+    try {
+        std::lock_guard<std::mutex> lock(mutex_);
+        session_->RunEffect(CreateTimelineEffect(found->second), found->second->LightIds(), startMs);
+        return Napi::Boolean::New(env, true);
+
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("PlayTimeline failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+// A playing timeline keeps its compiled data alive until it stops
+Napi::Value HueWrapper::UnloadTimeline(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected timeline handle").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    bool removed = timelines_.erase(info[0].As<Napi::Number>().Int32Value()) > 0;
+    return Napi::Boolean::New(env, removed);
+}
+
+// { lightIds, firstSeq, count, timesNs: Float64Array, colors: Float32Array };
+// colors are r, g, b (0-1) per light per frame
+static Napi::Object CaptureToJs(Napi::Env env, const FrameRecorder::Capture& capture) {
+    Napi::Array lightIds = Napi::Array::New(env, capture.lightIds.size());
+    for (size_t i = 0; i < capture.lightIds.size(); ++i) {
+        lightIds.Set(static_cast<uint32_t>(i), Napi::String::New(env, capture.lightIds[i]));
+    }
+    Napi::Float64Array times = Napi::Float64Array::New(env, capture.times.size());
+    for (size_t i = 0; i < capture.times.size(); ++i) {
+        times[i] = static_cast<double>(capture.times[i]);
+    }
+    Napi::Float32Array colors = Napi::Float32Array::New(env, capture.colors.size());
+    std::copy(capture.colors.begin(), capture.colors.end(), colors.Data());
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("lightIds", lightIds);
+    result.Set("firstSeq", Napi::Number::New(env, static_cast<double>(capture.firstSeq)));
+    result.Set("count", Napi::Number::New(env, static_cast<double>(capture.times.size())));
+    result.Set("timesNs", times);
+    result.Set("colors", colors);
+    return result;
+}
+
+// The recorded frames numbered above sinceSeq; null when the session has no
+// recorder
+static Napi::Value CapturedFrames(Napi::Env env, StreamSession* session, uint64_t sinceSeq) {
+    FrameRecorder* recorder = session ? session->Recorder() : nullptr;
+    if (!recorder) {
+        return env.Null();
+    }
+
+    FrameRecorder::Capture capture;
+    recorder->ReadSince(sinceSeq, capture);
+    return CaptureToJs(env, capture);
+}
+
+static uint64_t ReadSequence(const Napi::CallbackInfo& info, size_t index) {
+    if (info.Length() > index && info[index].IsNumber()) {
+        int64_t seq = info[index].As<Napi::Number>().Int64Value();
+        return seq > 0 ? static_cast<uint64_t>(seq) : 0;
+    }
+    return 0;
+}
+
+// getCapturedFrames(sinceSeq = 0)
+Napi::Value HueWrapper::GetCapturedFrames(const Napi::CallbackInfo& info) {
+    return CapturedFrames(info.Env(), session_.get(), ReadSequence(info, 0));
+}
+
+Napi::Value HueWrapper::ClearCapturedFrames(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    FrameRecorder* recorder = session_ ? session_->Recorder() : nullptr;
+    if (!recorder) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    recorder->Clear();
+    return Napi::Boolean::New(env, true);
+}
+
+// ============= Sequences =============
+
+// Reads { at, crossfade?, easing?, lightIds?, effect + params? | timeline | scene };
+// timelines bring their own lights, effects and scenes need lightIds
+static bool ReadSequenceStep(Napi::Env env, const Napi::Value& value,
+                             const std::map<int, std::shared_ptr<const Timeline>>& timelines, SequenceStep& step) {
+    if (!value.IsObject() || !value.As<Napi::Object>().Get("at").IsNumber()) {
+        Napi::TypeError::New(env, "Each step needs at (ms) and an effect, timeline or scene")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object object = value.As<Napi::Object>();
+    step.startMs = object.Get("at").As<Napi::Number>().DoubleValue();
+    step.crossfadeMs = object.Has("crossfade") ? object.Get("crossfade").ToNumber().DoubleValue() : 0;
+    if (object.Has("easing")) {
+        std::string easing = object.Get("easing").ToString().Utf8Value();
+        if (!ParseEasing(easing, step.easing)) {
+            Napi::TypeError::New(env, "Unknown easing: " + easing).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+
+    if (object.Has("timeline")) {
+        auto found = timelines.find(object.Get("timeline").ToNumber().Int32Value());
+        if (found == timelines.end()) {
+            Napi::Error::New(env, "Unknown timeline handle").ThrowAsJavaScriptException();
+            return false;
+        }
+        step.source = CreateTimelineEffect(found->second);
+        step.lightIds = found->second->LightIds();
+        return true;
+    }
+
+    if (!object.Get("lightIds").IsArray()) {
+        Napi::TypeError::New(env, "Effect and scene steps need lightIds").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Array idArray = object.Get("lightIds").As<Napi::Array>();
+    for (uint32_t i = 0; i < idArray.Length(); ++i) {
+        step.lightIds.push_back(idArray.Get(i).ToNumber().Int32Value());
+    }
+
+    if (object.Get("effect").IsString()) {
+        std::string name = object.Get("effect").As<Napi::String>().Utf8Value();
+        EffectParams params;
+        if (object.Has("params") && !ReadEffectParams(env, object.Get("params"), params)) {
+            return false;
+        }
+        step.source = CreateNativeEffect(name, params);
+        if (!step.source) {
+            Napi::Error::New(env, "Unknown native effect: " + name).ThrowAsJavaScriptException();
+            return false;
+        }
+        step.source = CacheNativeEffect(name, std::move(step.source), step.lightIds.size());
+        return true;
+    }
+
+    if (object.Get("scene").IsArray()) {
+        Napi::Array scene = object.Get("scene").As<Napi::Array>();
+        for (uint32_t i = 0; i < scene.Length(); ++i) {
+            if (!scene.Get(i).IsObject()) {
+                Napi::TypeError::New(env, "step.scene must be an array of { r, g, b }")
+                    .ThrowAsJavaScriptException();
+                return false;
+            }
+        }
+        std::vector<Rgb> colors;
+        if (!ReadColorList(env, scene, colors)) {
+            return false;
+        }
+        step.source = CreateSceneEffect(colors);
+        return true;
+    }
+
+    Napi::TypeError::New(env, "Each step needs at (ms) and an effect, timeline or scene")
+        .ThrowAsJavaScriptException();
+    return false;
+}
+
+// playSequence(steps, { duration?, loop? }) replaces the running native
+// effect; stopEffect() and seekEffect() act on the whole sequence
+Napi::Value HueWrapper::PlaySequence(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected steps array").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array stepArray = info[0].As<Napi::Array>();
+    std::vector<SequenceStep> steps(stepArray.Length());
+    for (uint32_t i = 0; i < stepArray.Length(); ++i) {
+        if (!ReadSequenceStep(env, stepArray.Get(i), timelines_, steps[i])) {
+            return env.Undefined();
+        }
+    }
+
+    SequenceOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object object = info[1].As<Napi::Object>();
+        if (object.Has("duration")) {
+            options.durationMs = object.Get("duration").ToNumber().DoubleValue();
+        }
+        options.loop = object.Has("loop") && object.Get("loop").ToBoolean().Value();
+    }
+
+    try {
+        std::vector<int> lightIds;
+        std::unique_ptr<NativeEffect> sequence = CreateSequenceEffect(std::move(steps), options, lightIds);
+        std::lock_guard<std::mutex> lock(mutex_);
+        session_->RunEffect(std::move(sequence), lightIds);
+        return Napi::Boolean::New(env, true);
+
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("PlaySequence failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+// ============= Spatial Fields =============
+
+// Reads { x, y, z? } from object[name] if present; throws a JS error on failure
+static bool ReadPoint(Napi::Env env, const Napi::Object& object, const char* name, float point[3]) {
+    if (!object.Has(name)) {
+        return true;
+    }
+    Napi::Value value = object.Get(name);
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, std::string(name) + " must be { x, y, z? }").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object coordinates = value.As<Napi::Object>();
+    point[0] = coordinates.Get("x").ToNumber().FloatValue();
+    point[1] = coordinates.Get("y").ToNumber().FloatValue();
+    point[2] = coordinates.Has("z") ? coordinates.Get("z").ToNumber().FloatValue() : 0.0f;
+    return true;
+}
+
+// Reads { type, colors?, center?, direction?, speed?, wavelength?, width?,
+// radius?, duration?, transparent? }; throws a JS error on failure
+static bool ReadFieldParams(Napi::Env env, const Napi::Value& value, FieldParams& params) {
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Expected field object").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object object = value.As<Napi::Object>();
+    if (!object.Get("type").IsString() ||
+        !ParseFieldType(object.Get("type").As<Napi::String>().Utf8Value(), params.type)) {
+        Napi::TypeError::New(env, "type must be 'radial', 'sweep', 'falloff' or 'burst'")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    if (object.Has("colors") && !ReadColorList(env, object.Get("colors"), params.colors)) {
+        return false;
+    }
+    if (!ReadPoint(env, object, "center", params.center) || !ReadPoint(env, object, "direction", params.direction)) {
+        return false;
+    }
+
+    struct Length {
+        const char* name;
+        double* target;
+    };
+    const Length lengths[] = {
+        {"wavelength", &params.wavelength}, {"width", &params.width},
+        {"radius", &params.radius}, {"duration", &params.duration},
+    };
+    for (const Length& length : lengths) {
+        if (!object.Has(length.name)) {
+            continue;
+        }
+        double number = object.Get(length.name).ToNumber().DoubleValue();
+        if (!(number >= 0)) {
+            Napi::RangeError::New(env, std::string(length.name) + " must not be negative")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        *length.target = number;
+    }
+    if (object.Has("speed")) {
+        params.speed = object.Get("speed").ToNumber().DoubleValue();
+    }
+    if (object.Has("transparent")) {
+        params.transparent = object.Get("transparent").ToBoolean().Value();
+    }
+    return true;
+}
+
+// setField(field, timeMs, layer?): evaluates the field at every light of the
+// group and sends the result as one frame, on the frame layer or a named layer
+Napi::Value HueWrapper::SetField(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (info.Length() < 2 || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected field, timeMs").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    FieldParams params;
+    if (!ReadFieldParams(env, info[0], params)) {
+        return env.Undefined();
+    }
+
+    std::string layerName;
+    FrameEffect* target = &session_->Frame();
+    if (info.Length() > 2 && !info[2].IsUndefined()) {
+        if (!info[2].IsString()) {
+            Napi::TypeError::New(env, "layer must be a string").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        layerName = info[2].As<Napi::String>().Utf8Value();
+        target = session_->Layers()->Find(layerName);
+        if (!target) {
+            Napi::Error::New(env, "Unknown layer: " + layerName).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+    }
+
+    const LightPositions& positions = session_->Lights().Positions();
+    fieldFrame_.resize(positions.Size() * 4);
+    EvaluateField(params, info[1].As<Napi::Number>().DoubleValue(), positions, fieldFrame_.data());
+    for (size_t slot = 0; slot < positions.Size() && slot < target->Size(); ++slot) {
+        const float* rgba = fieldFrame_.data() + slot * 4;
+        target->SetColor(slot, Color(rgba[0], rgba[1], rgba[2], rgba[3]));
+    }
+    if (layerName.empty()) {
+        session_->PublishFrame();
+    } else {
+        session_->PublishLayer(*target);
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+// getLightPositions(): { ids, x, y, z }, the group's lights in slot order
+Napi::Value HueWrapper::GetLightPositions(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!session_ || !session_->ActiveBridge()) {
+        Napi::Error::New(env, "Not connected to bridge").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    session_->SyncLightTable();
+    const LightTable& lights = session_->Lights();
+    const LightPositions& positions = lights.Positions();
+    size_t count = positions.Size();
+
+    Napi::Array ids = Napi::Array::New(env, count);
+    Napi::Float32Array x = Napi::Float32Array::New(env, count);
+    Napi::Float32Array y = Napi::Float32Array::New(env, count);
+    Napi::Float32Array z = Napi::Float32Array::New(env, count);
+    for (size_t slot = 0; slot < count; ++slot) {
+        ids.Set(static_cast<uint32_t>(slot), Napi::String::New(env, lights.Id(slot)));
+        x[slot] = positions.x[slot];
+        y[slot] = positions.y[slot];
+        z[slot] = positions.z[slot];
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("x", x);
+    result.Set("y", y);
+    result.Set("z", z);
+    return result;
+}
+
+// ============= Capture and Replay =============
+
+static Napi::Object CaptureSummaryToJs(Napi::Env env, const CaptureWriter::Summary& summary) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("frames", Napi::Number::New(env, static_cast<double>(summary.frames)));
+    result.Set("skippedFrames", Napi::Number::New(env, static_cast<double>(summary.skippedFrames)));
+    result.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(summary.droppedFrames)));
+    result.Set("changedLights", Napi::Number::New(env, static_cast<double>(summary.changedLights)));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(summary.bytes)));
+    result.Set("writeError", Napi::Boolean::New(env, summary.writeError));
+    return result;
+}
+
+// startCapture(path): records every frame sent from now on
+Napi::Value HueWrapper::StartCapture(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected capture file path").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    try {
+        session_->StartCapture(info[0].As<Napi::String>().Utf8Value());
+        return Napi::Boolean::New(env, true);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("startCapture failed: ") + e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+// stopCapture(): { frames, skippedFrames, droppedFrames, changedLights, bytes, writeError },
+// null if no capture ran
+Napi::Value HueWrapper::StopCapture(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    CaptureWriter::Summary summary;
+    if (!session_ || !session_->StopCapture(summary)) {
+        return env.Null();
+    }
+    return CaptureSummaryToJs(env, summary);
+}
+
+// startReplay(path, { loop = false })
+Napi::Value HueWrapper::StartReplay(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected capture file path").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!session_ || !session_->IsStreaming() || !session_->HasFrameLayer()) {
+        Napi::Error::New(env, "Not streaming").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    bool loop = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        loop = options.Has("loop") && options.Get("loop").ToBoolean().Value();
+    }
+
+    try {
+        session_->StartReplay(info[0].As<Napi::String>().Utf8Value(), loop);
+        return Napi::Boolean::New(env, true);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("startReplay failed: ") + e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+Napi::Value HueWrapper::StopReplay(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), session_ && session_->StopReplay());
+}
+
+// readCaptureFile(path): the whole capture in the getCapturedFrames() shape,
+// for comparing runs; throws if the file is not a capture
+static Napi::Value ReadCaptureFile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected capture file path").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    FrameRecorder::Capture capture;
+    try {
+        CaptureFile file(info[0].As<Napi::String>().Utf8Value());
+        CaptureReader reader(file);
+        capture.lightIds = file.LightIds();
+        capture.firstSeq = 1;
+        size_t stride = capture.lightIds.size() * 3;
+        while (!reader.AtEnd()) {
+            int64_t timeNs = file.Header().startNs + static_cast<int64_t>(reader.NextTimeUs()) * 1000;
+            if (!reader.Next()) {
+                break;
+            }
+            capture.times.push_back(timeNs);
+            for (size_t i = 0; i < stride; ++i) {
+                capture.colors.push_back(reader.Colors()[i] / 65535.0f);
+            }
+        }
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("readCaptureFile failed: ") + e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return CaptureToJs(env, capture);
+}
+
+// { count, mean, p50, p99, max } in microseconds plus the raw bucket counts;
+// bucket i holds durations below 2^i us (the last one everything above)
+static Napi::Object HistogramToJs(Napi::Env env, const Histogram::Snapshot& histogram) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, static_cast<double>(histogram.count)));
+    result.Set("mean", Napi::Number::New(env, histogram.MeanUs()));
+    result.Set("p50", Napi::Number::New(env, histogram.PercentileUs(0.50)));
+    result.Set("p99", Napi::Number::New(env, histogram.PercentileUs(0.99)));
+    result.Set("max", Napi::Number::New(env, histogram.maxNs / 1000.0));
+
+    Napi::Array buckets = Napi::Array::New(env, Histogram::kBuckets);
+    for (size_t i = 0; i < Histogram::kBuckets; ++i) {
+        buckets.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(histogram.buckets[i])));
+    }
+    result.Set("buckets", buckets);
+    return result;
+}
+
+// Counters are totals since the stream started; setterCallsPerSecond covers
+// the time since the previous call with the same window
+static Napi::Object StreamStatsToJs(Napi::Env env, const StreamSession& session, StatsWindow& window) {
+    StreamStats::Snapshot snapshot;
+    session.Stats().Read(snapshot);
+
+    int64_t now = StatsNowNs();
+    double rate = 0.0;
+    if (window.atNs != 0 && now > window.atNs) {
+        rate = (snapshot.publishes - window.publishes) * 1e9 / (now - window.atNs);
+    }
+    window.atNs = now;
+    window.publishes = snapshot.publishes;
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("setterCalls", Napi::Number::New(env, static_cast<double>(snapshot.publishes)));
+    result.Set("setterCallsPerSecond", Napi::Number::New(env, rate));
+    // Light writes equal to what the light already shows, and setter calls
+    // that changed nothing and were not handed to the render thread
+    result.Set("writesSkipped", Napi::Number::New(env, static_cast<double>(snapshot.writesSkipped)));
+    result.Set("publishesSkipped", Napi::Number::New(env, static_cast<double>(snapshot.publishesSkipped)));
+    result.Set("framesSent", Napi::Number::New(env, static_cast<double>(snapshot.framesSent)));
+    // Render ticks with no new manual frame to pick up
+    result.Set("framesUnchanged", Napi::Number::New(env, static_cast<double>(snapshot.framesUnchanged)));
+    // Published frames replaced by a newer one before the renderer took them
+    uint64_t published = snapshot.publishes - snapshot.publishesSkipped;
+    uint64_t coalesced = published > snapshot.framesAcquired ? published - snapshot.framesAcquired : 0;
+    result.Set("framesCoalesced", Napi::Number::New(env, static_cast<double>(coalesced)));
+    result.Set("framesDropped", Napi::Number::New(env, static_cast<double>(snapshot.framesDropped)));
+    result.Set("frameJitterUs", Napi::Number::New(env, snapshot.FrameJitterUs()));
+    result.Set("lockWaitUs", HistogramToJs(env, snapshot.lockWait));
+    result.Set("lockHoldUs", HistogramToJs(env, snapshot.lockHold));
+    result.Set("frameTimeUs", HistogramToJs(env, snapshot.frameTime));
+    result.Set("frameIntervalUs", HistogramToJs(env, snapshot.frameInterval));
+    result.Set("setterToFrameUs", HistogramToJs(env, snapshot.setterToFrame));
+
+    // Time spent rendering at the full and at the idle keep-alive rate
+    Napi::Object rateState = Napi::Object::New(env);
+    rateState.Set("mode", Napi::String::New(env, session.GetRatePolicy().adaptive ? "adaptive" : "fixed"));
+    rateState.Set("state", Napi::String::New(env, snapshot.idle ? "idle" : "full"));
+    rateState.Set("fullRateMs", Napi::Number::New(env, snapshot.fullRateNs / 1e6));
+    rateState.Set("idleRateMs", Napi::Number::New(env, snapshot.idleRateNs / 1e6));
+    rateState.Set("switches", Napi::Number::New(env, static_cast<double>(snapshot.rateSwitches)));
+    result.Set("rate", rateState);
+    return result;
+}
+
+// Lock-free counters and histograms; cheap enough to poll every second
+Napi::Value HueWrapper::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!session_) {
+        return env.Null();
+    }
+    Napi::Object stats = StreamStatsToJs(env, *session_, statsWindow_);
+    if (frameClock_) {
+        Napi::Object clock = Napi::Object::New(env);
+        clock.Set("callbacks", Napi::Number::New(env, static_cast<double>(frameClock_->callbacks.load())));
+        clock.Set("missedTicks", Napi::Number::New(env, static_cast<double>(frameClock_->missedTicks.load())));
+        clock.Set("lateCallbacks", Napi::Number::New(env, static_cast<double>(frameClock_->lateCallbacks.load())));
+        stats.Set("frameClock", clock);
+    }
+    if (const SharedFrameEffect* input = session_->SharedInput()) {
+        SharedFrameEffect::Counters counters;
+        input->ReadCounters(counters);
+        Napi::Object shared = Napi::Object::New(env);
+        shared.Set("attached", Napi::Boolean::New(env, input->IsAttached()));
+        shared.Set("frames", Napi::Number::New(env, static_cast<double>(counters.frames)));
+        shared.Set("gaps", Napi::Number::New(env, static_cast<double>(counters.gaps)));
+        shared.Set("lostFrames", Napi::Number::New(env, static_cast<double>(counters.lostFrames)));
+        shared.Set("tornReads", Napi::Number::New(env, static_cast<double>(counters.tornReads)));
+        shared.Set("staleTicks", Napi::Number::New(env, static_cast<double>(counters.staleTicks)));
+        stats.Set("sharedInput", shared);
+    }
+    CaptureWriter::Summary capture;
+    if (session_->CaptureSummary(capture)) {
+        stats.Set("capture", CaptureSummaryToJs(env, capture));
+    }
+    if (const ReplayEffect* replay = session_->Replay()) {
+        Napi::Object replayStats = Napi::Object::New(env);
+        replayStats.Set("playing", Napi::Boolean::New(env, replay->IsActive()));
+        replayStats.Set("framesPlayed", Napi::Number::New(env, static_cast<double>(replay->FramesPlayed())));
+        replayStats.Set("frameCount", Napi::Number::New(env, static_cast<double>(replay->FrameCount())));
+        stats.Set("replay", replayStats);
+    }
+    return stats;
+}
+
+// ============= Rate Policy =============
+
+// Reads { mode: 'fixed' | 'adaptive', idleAfterMs?, idleFps? } over the
+// current policy; throws a JS error on failure
+static bool ReadRatePolicy(Napi::Env env, const Napi::Value& value, RatePolicy& policy) {
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Expected rate policy object").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object object = value.As<Napi::Object>();
+    if (object.Has("mode")) {
+        std::string mode = object.Get("mode").ToString().Utf8Value();
+        if (mode != "fixed" && mode != "adaptive") {
+            Napi::TypeError::New(env, "mode must be 'fixed' or 'adaptive'").ThrowAsJavaScriptException();
+            return false;
+        }
+        policy.adaptive = mode == "adaptive";
+    }
+    if (object.Has("idleAfterMs")) {
+        double idleAfterMs = object.Get("idleAfterMs").ToNumber().DoubleValue();
+        if (!std::isfinite(idleAfterMs) || idleAfterMs < 0) {
+            Napi::RangeError::New(env, "idleAfterMs must be a finite, non-negative number")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        policy.idleAfterMs = idleAfterMs;
+    }
+    if (object.Has("idleFps")) {
+        int idleFps = object.Get("idleFps").ToNumber().Int32Value();
+        if (idleFps < 1 || idleFps > 60) {
+            Napi::RangeError::New(env, "idleFps must be between 1 and 60").ThrowAsJavaScriptException();
+            return false;
+        }
+        policy.idleFps = idleFps;
+    }
+    return true;
+}
+
+static Napi::Object RatePolicyToJs(Napi::Env env, const RatePolicy& policy) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("mode", Napi::String::New(env, policy.adaptive ? "adaptive" : "fixed"));
+    result.Set("idleAfterMs", Napi::Number::New(env, policy.idleAfterMs));
+    result.Set("idleFps", Napi::Number::New(env, policy.idleFps));
+    return result;
+}
+
+// setRatePolicy(policy): kept across shutdown() and initialize()
+Napi::Value HueWrapper::SetRatePolicy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    RatePolicy policy = ratePolicy_;
+    if (!ReadRatePolicy(env, info.Length() > 0 ? info[0] : env.Undefined(), policy)) {
+        return env.Undefined();
+    }
+    ratePolicy_ = policy;
+    if (session_) {
+        session_->SetRatePolicy(policy);
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value HueWrapper::GetRatePolicy(const Napi::CallbackInfo& info) {
+    return RatePolicyToJs(info.Env(), ratePolicy_);
+}
+
+// ============= Output Correction =============
+
+// setOutputCorrection({ enabled?, gamma? }): over the current settings; kept
+// across shutdown() and initialize(). gamma 0 keeps the sRGB curve.
+Napi::Value HueWrapper::SetOutputCorrection(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected output correction object").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Object object = info[0].As<Napi::Object>();
+    OutputCorrection correction = correction_;
+    if (object.Has("enabled")) {
+        correction.enabled = object.Get("enabled").ToBoolean().Value();
+    }
+    if (object.Has("gamma")) {
+        double gamma = object.Get("gamma").ToNumber().DoubleValue();
+        if (!(gamma == 0 || (gamma >= 1 && gamma <= 4))) {
+            Napi::RangeError::New(env, "gamma must be 0 or between 1 and 4").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        correction.gamma = gamma;
+    }
+    correction_ = correction;
+    if (session_) {
+        session_->SetOutputCorrection(correction);
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+// { enabled, gamma, gamuts: { lightId: 'A' | 'B' | 'C' } }; gamuts is empty
+// until correction is on and the group's lights are known
+Napi::Value HueWrapper::GetOutputCorrection(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("enabled", Napi::Boolean::New(env, correction_.enabled));
+    result.Set("gamma", Napi::Number::New(env, correction_.gamma));
+    Napi::Object gamuts = Napi::Object::New(env);
+    const OutputCorrector* corrector = session_ ? session_->Corrector() : nullptr;
+    if (corrector) {
+        for (size_t slot = 0; slot < corrector->Size(); ++slot) {
+            gamuts.Set(corrector->Id(slot), Napi::String::New(env, GamutName(corrector->GamutAt(slot))));
+        }
+    }
+    result.Set("gamuts", gamuts);
+    return result;
+}
+
+// ============= Warm Start =============
+
+// setWarmStart(path | null): opt-in cache of the bridge capabilities, group
+// topology and light list at path. A cold start writes it once streaming;
+// connectManual() for the same bridge then resumes straight to streaming on
+// the cached group. Kept across shutdown() and initialize().
+Napi::Value HueWrapper::SetWarmStart(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !(info[0].IsString() || info[0].IsNull())) {
+        Napi::TypeError::New(env, "Expected warm start cache path or null").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    warmStartPath_ = info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : std::string();
+    if (session_) {
+        session_->SetWarmStartPath(warmStartPath_);
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+// { path, used, startupMs, coldStartMs, savedMs, revalidated, changed } for
+// the last connection; path is null while disabled
+Napi::Value HueWrapper::GetWarmStart(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::lock_guard<std::mutex> lock(mutex_);
+    WarmStartReport report = session_ ? session_->GetWarmStart() : WarmStartReport();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("path", warmStartPath_.empty() ? env.Null() : Napi::String::New(env, warmStartPath_));
+    result.Set("used", Napi::Boolean::New(env, report.used));
+    result.Set("startupMs", Napi::Number::New(env, report.startupMs));
+    result.Set("coldStartMs", Napi::Number::New(env, report.coldStartMs));
+    result.Set("savedMs", Napi::Number::New(env, report.savedMs));
+    result.Set("revalidated", Napi::Boolean::New(env, report.revalidated));
+    result.Set("changed", Napi::Boolean::New(env, report.changed));
+    return result;
+}
+
+// The stream runs on the cached lights; the bridge is asked in the
+// background whether they still match, and a changed group is picked up
+// when the answer is back
+void HueWrapper::FinishWarmStart(Napi::Env env) {
+    // No-op while the resumed stream is still coming up; start() adds the
+    // layers then
+    session_->StartStreaming();
+    session_->SyncLightTable();
+    // The bridge query blocks for its round trip, so it runs on the pool
+    // thread like the handshake, with the JS thread free to render meanwhile
+    std::shared_ptr<StreamSession> session = session_;
+    auto* worker = new EdkWorker(env, this, "Warm start revalidation failed: ", [this, session]() {
+        std::lock_guard<std::mutex> connecting(connectMutex_);
+        // Nobody awaits the result; a failed check leaves the cache as is
+        try {
+            return session->RevalidateWarmStart();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }, [this, session]() {
+        // Shut down or re-initialized while the query ran
+        if (session == session_) {
+            session->SyncLightTable();
+        }
+        return true;
+    });
+    worker->Queue();
+}
+
+// ============= Frame Clock =============
+
+void FrameClock::CallJs(Napi::Env env, Napi::Function callback, FrameClock* clock, void* data) {
+    RenderScheduler::Tick tick;
+    {
+        std::lock_guard<std::mutex> lock(clock->tickMutex_);
+        tick = clock->latest_;
+    }
+    // Ticks from here on queue the next call
+    clock->pending_.store(false, std::memory_order_release);
+    if (env == nullptr || callback.IsEmpty()) {
+        return;
+    }
+
+    clock->callbacks.fetch_add(1, std::memory_order_relaxed);
+    callback.Call({
+        Napi::Number::New(env, static_cast<double>(tick.frame)),
+        Napi::Number::New(env, tick.timeNs / 1e6),
+        Napi::Number::New(env, tick.deadlineNs / 1e6),
+        Napi::Number::New(env, static_cast<double>(clock->missedTicks.load(std::memory_order_relaxed)))
+    });
+    if (StatsNowNs() > tick.deadlineNs) {
+        clock->lateCallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// setFrameCallback(fn): fn(frame, timeMs, deadlineMs, missedTicks) runs once
+// per render tick, right after the tick was sent. Whatever fn sets goes out
+// on the next tick at deadlineMs. Times are monotonic milliseconds on the
+// process.hrtime() clock. Replaces any previous callback.
+Napi::Value HueWrapper::SetFrameCallback(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Expected frame callback function").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!scheduler_) {
+        Napi::Error::New(env, "Not initialized").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    StopFrameClock();
+    auto* clock = new FrameClock();
+    clock->tsfn = decltype(clock->tsfn)::New(env, info[0].As<Napi::Function>(), "hue_frame_clock", 0, 1,
+                                              clock, &FrameClock::Finalize);
+    frameClock_ = clock;
+    scheduler_->SetTickListener([clock](const RenderScheduler::Tick& tick) { clock->OnTick(tick); });
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value HueWrapper::ClearFrameCallback(const Napi::CallbackInfo& info) {
+    bool wasSet = frameClock_ != nullptr;
+    StopFrameClock();
+    return Napi::Boolean::New(info.Env(), wasSet);
+}
+
+// No tick reaches the clock once the listener is gone; already queued calls
+// still run, and the finalizer then deletes the clock
+void HueWrapper::StopFrameClock() {
+    if (!frameClock_) {
+        return;
+    }
+    if (scheduler_) {
+        scheduler_->SetTickListener(nullptr);
+    }
+    frameClock_->tsfn.Release();
+    frameClock_ = nullptr;
+}
+
+// ============= State Events =============
+
+void StateEvents::CallJs(Napi::Env env, Napi::Function callback, StateEvents* events, Event* event) {
+    if (env != nullptr && !callback.IsEmpty()) {
+        callback.Call({
+            Napi::String::New(env, SessionEventName(event->event)),
+            Napi::Number::New(env, event->timeNs / 1e6)
+        });
+    }
+    delete event;
+}
+
+// setStateCallback(fn): fn(state, timeMs) runs on every session state change:
+// "connected", "disconnected", "streaming", "lost" (the stream dropped
+// without being stopped), "reconnected" (streaming again after "lost") and
+// "stopped". Kept across shutdown() and initialize(). Replaces any previous
+// callback.
+Napi::Value HueWrapper::SetStateCallback(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Expected state callback function").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    StopStateEvents();
+    auto* events = new StateEvents();
+    events->tsfn = decltype(events->tsfn)::New(env, info[0].As<Napi::Function>(), "hue_state_events", 0, 1,
+                                                events, &StateEvents::Finalize);
+    events->tsfn.Unref(env);
+    stateEvents_ = events;
+    if (session_) {
+        session_->SetStateListener([events](SessionEvent event) { events->Post(event); });
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value HueWrapper::ClearStateCallback(const Napi::CallbackInfo& info) {
+    bool wasSet = stateEvents_ != nullptr;
+    StopStateEvents();
+    return Napi::Boolean::New(info.Env(), wasSet);
+}
+
+// Like StopFrameClock: queued events still run before the finalizer
+void HueWrapper::StopStateEvents() {
+    if (!stateEvents_) {
+        return;
+    }
+    if (session_) {
+        session_->SetStateListener(nullptr);
+    }
+    stateEvents_->tsfn.Release();
+    stateEvents_ = nullptr;
+}
+
+Napi::Value HueWrapper::GetStatus(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    Napi::Object status = Napi::Object::New(env);
+    status.Set("initialized", Napi::Boolean::New(env, session_ != nullptr));
+    status.Set("connected", Napi::Boolean::New(env, session_ && session_->IsConnected()));
+    // Check actual streaming status
+    status.Set("streaming", Napi::Boolean::New(env, session_ && session_->IsStreaming()));
+    status.Set("appName", Napi::String::New(env, appName_));
+    status.Set("deviceName", Napi::String::New(env, deviceName_));
+    status.Set("streamingMode", Napi::String::New(env, session_ ? session_->Mode()
+        : backendOptions_.kind == BackendKind::Simulated ? "simulated" : "DTLS"));
+    status.Set("selectedGroup", Napi::String::New(env, session_ ? session_->GroupId() : "0"));
+    
+    if (session_) {
+        auto bridge = session_->ActiveBridge();
+        if (bridge) {
+            Napi::Object bridgeInfo = Napi::Object::New(env);
+            bridgeInfo.Set("id", Napi::String::New(env, bridge->GetId()));
+            bridgeInfo.Set("ip", Napi::String::New(env, bridge->GetIpAddress()));
+            bridgeInfo.Set("connected", Napi::Boolean::New(env, session_->IsConnected()));
+            bridgeInfo.Set("streaming", Napi::Boolean::New(env, session_->IsStreaming()));
+            status.Set("bridge", bridgeInfo);
+        }
+    }
+    
+    return status;
+}
+
+// Disables the layers, stops streaming and releases all EDK resources
+void HueWrapper::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StopFrameClock();
+    if (scheduler_) {
+        scheduler_->Stop();
+        if (session_) {
+            // ShutDown marks activity, which would wake the scheduler
+            scheduler_->Remove(session_);
+        }
+        scheduler_.reset();
+    }
+    if (session_) {
+        std::unique_lock<std::mutex> connecting(connectMutex_, std::try_to_lock);
+        if (connecting.owns_lock()) {
+            session_->ShutDown();
+        }
+        // Otherwise a connection step is still running on the pool; the
+        // stream shuts down with the worker's reference once it returns
+        session_->SetStateListener(nullptr);
+        session_.reset();
+    }
+}
+
+Napi::Value HueWrapper::Shutdown(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        Close();
+        return Napi::Boolean::New(env, true);
+        
+    } catch (const std::exception& e) {
+        return Napi::Boolean::New(env, false);
+    }
+}
+
+// ============= Session Manager =============
+
+// Streams to several bridges / entertainment groups from one process. The
+// sessions have the EDK render thread disabled and are rendered together
+// by one RenderScheduler, so every bridge gets its frame on the same tick.
+class HueSessionManager : public Napi::ObjectWrap<HueSessionManager> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    HueSessionManager(const Napi::CallbackInfo& info);
+    ~HueSessionManager();
+
+    // Stops the shared clock and ends every session
+    void Close();
+
+private:
+
+    struct Entry {
+        std::shared_ptr<StreamSession> session;
+        std::shared_ptr<std::mutex> mutex;  // serializes connection steps
+        BridgeCredentials credentials;
+        std::string groupId;
+        StatsWindow statsWindow;
+        // Set on the JS thread once connectSession() added the frame layer;
+        // until then the setters leave the session alone
+        bool live = false;
+
+        StreamSession* Live() const { return live ? session.get() : nullptr; }
+    };
+
+    Napi::Value AddSession(const Napi::CallbackInfo& info);
+    Napi::Value ConnectSession(const Napi::CallbackInfo& info);
+    Napi::Value RemoveSession(const Napi::CallbackInfo& info);
+    Napi::Value SetFrame(const Napi::CallbackInfo& info);
+    Napi::Value StartEffect(const Napi::CallbackInfo& info);
+    Napi::Value StopEffect(const Napi::CallbackInfo& info);
+    Napi::Value GetLightIds(const Napi::CallbackInfo& info);
+    Napi::Value GetCapturedFrames(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+    Napi::Value SetRatePolicy(const Napi::CallbackInfo& info);
+    Napi::Value Shutdown(const Napi::CallbackInfo& info);
+
+    // Session named by info[0]; throws a JS error and returns nullptr if unknown
+    Entry* FindSession(const Napi::CallbackInfo& info);
+
+    AddonData* addon_;  // this object's environment
+    std::string appName_;
+    std::string deviceName_;
+    BackendOptions backendOptions_;
+    RatePolicy ratePolicy_;
+    std::unique_ptr<RenderScheduler> scheduler_;
+    std::map<int, Entry> sessions_;
+    int nextSessionId_ = 1;
+};
+
+Napi::Object HueSessionManager::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "HueSessionManager", {
+        InstanceMethod("addSession", &HueSessionManager::AddSession),
+        InstanceMethod("connectSession", &HueSessionManager::ConnectSession),
+        InstanceMethod("removeSession", &HueSessionManager::RemoveSession),
+        InstanceMethod("setFrame", &HueSessionManager::SetFrame),
+        InstanceMethod("startEffect", &HueSessionManager::StartEffect),
+        InstanceMethod("stopEffect", &HueSessionManager::StopEffect),
+        InstanceMethod("getLightIds", &HueSessionManager::GetLightIds),
+        InstanceMethod("getCapturedFrames", &HueSessionManager::GetCapturedFrames),
+        InstanceMethod("getStats", &HueSessionManager::GetStats),
+        InstanceMethod("setRatePolicy", &HueSessionManager::SetRatePolicy),
+        InstanceMethod("shutdown", &HueSessionManager::Shutdown)
+    });
+
+    env.GetInstanceData<AddonData>()->sessionManager = Napi::Persistent(func);
+    exports.Set("HueSessionManager", func);
+    return exports;
+}
+
+// new HueSessionManager(appName, deviceName, { fps?, backend?, lights?, captureFrames? })
+HueSessionManager::HueSessionManager(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<HueSessionManager>(info) {
+
+    Napi::Env env = info.Env();
+    addon_ = env.GetInstanceData<AddonData>();
+    addon_->managers.insert(this);
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "Expected appName and deviceName")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    appName_ = info[0].As<Napi::String>().Utf8Value();
+    deviceName_ = info[1].As<Napi::String>().Utf8Value();
+
+    int fps = 60;
+    if (info.Length() > 2 && info[2].IsObject()) {
+        Napi::Object options = info[2].As<Napi::Object>();
+        if (options.Has("fps")) {
+            fps = options.Get("fps").ToNumber().Int32Value();
+        }
+        if (!ReadBackendOptions(env, options, backendOptions_)) {
+            return;
+        }
+    }
+    scheduler_ = std::make_unique<RenderScheduler>(fps);
+}
+
+HueSessionManager::~HueSessionManager() {
+    addon_->managers.erase(this);
+    Close();
+}
+
+// The scheduler holds its own reference to every connected session; each
+// stream shuts down with its last reference, so both are dropped here
+void HueSessionManager::Close() {
+    if (scheduler_) {
+        scheduler_->Stop();
+        for (auto& item : sessions_) {
+            scheduler_->Remove(item.second.session);
+        }
+    }
+    sessions_.clear();
+}
+
+HueSessionManager::Entry* HueSessionManager::FindSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected session id").ThrowAsJavaScriptException();
+        return nullptr;
+    }
+    auto found = sessions_.find(info[0].As<Napi::Number>().Int32Value());
+    if (found == sessions_.end()) {
+        Napi::Error::New(env, "Unknown session id").ThrowAsJavaScriptException();
+        return nullptr;
+    }
+    return &found->second;
+}
+
+// addSession(config, groupId) creates the session without touching the
+// network and returns its id; connectSession() performs the handshake
+Napi::Value HueSessionManager::AddSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Entry entry;
+    if (!ReadBridgeCredentials(env, info.Length() > 0 ? info[0] : env.Undefined(), entry.credentials)) {
+        return env.Undefined();
+    }
+    if (info.Length() < 2 || !info[1].IsString()) {
+        Napi::TypeError::New(env, "Expected entertainment group id").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    entry.groupId = info[1].As<Napi::String>().Utf8Value();
+
+    try {
+        entry.session = std::make_shared<StreamSession>(appName_, deviceName_, true, backendOptions_);
+        entry.session->SetRatePolicy(ratePolicy_);
+        entry.mutex = std::make_shared<std::mutex>();
+
+        int id = nextSessionId_++;
+        sessions_[id] = std::move(entry);
+        return Napi::Number::New(env, id);
+
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, std::string("AddSession failed: ") + e.what())
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+}
+
+// connectSession(id, timeoutMs = 5000): connects, selects the group and
+// resolves true once the bridge streams; the session then joins the shared
+// render clock
+Napi::Value HueSessionManager::ConnectSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Entry* entry = FindSession(info);
+    if (!entry) {
+        return env.Undefined();
+    }
+
+    int id = info[0].As<Napi::Number>().Int32Value();
+    std::chrono::milliseconds timeout = ReadTimeout(info, 1);
+    std::shared_ptr<StreamSession> session = entry->session;
+    std::shared_ptr<std::mutex> mutex = entry->mutex;
+    BridgeCredentials credentials = entry->credentials;
+    std::string groupId = entry->groupId;
+    // Published again once this connection is up
+    entry->live = false;
+
+    // The worker keeps its own references, so removeSession() during the
+    // handshake only drops the session once the handshake returns. Only the
+    // handshake runs on the pool; the frame layer is added and the session
+    // published on the JS thread.
+    auto* worker = new EdkWorker(env, this, "Session connection failed: ",
+        [session, mutex, credentials, groupId, timeout]() {
+            std::lock_guard<std::mutex> lock(*mutex);
+            if (!session->Connect(credentials)) {
+                return false;
+            }
+            session->SelectGroup(groupId);
+            return session->WaitForStreaming(timeout);
+        }, [this, id, session]() {
+            auto found = sessions_.find(id);
+            if (found == sessions_.end() || found->second.session != session || !session->StartStreaming()) {
+                return false;
+            }
+            session->SyncLightTable();
+            found->second.live = true;
+            scheduler_->Add(session);
+            scheduler_->Start();
+            return true;
+        });
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value HueSessionManager::RemoveSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Entry* entry = FindSession(info);
+    if (!entry) {
+        return env.Undefined();
+    }
+
+    // Waits at most for the session's own render in progress; the stream
+    // shuts down with its last reference
+    scheduler_->Remove(entry->session);
+    sessions_.erase(info[0].As<Napi::Number>().Int32Value());
+    return Napi::Boolean::New(env, true);
+}
+
+// setFrame(id, lightIds, data, format), same frame layout as HueWrapper
+Napi::Value HueSessionManager::SetFrame(const Napi::CallbackInfo& info) {
+    Entry* entry = FindSession(info);
+    if (!entry) {
+        return info.Env().Undefined();
+    }
+    return ApplyFrame(info, 1, entry->Live());
+}
+
+// startEffect(id, name, params, lightIds)
+Napi::Value HueSessionManager::StartEffect(const Napi::CallbackInfo& info) {
+    Entry* entry = FindSession(info);
+    if (!entry) {
+        return info.Env().Undefined();
+    }
+    return StartSessionEffect(info, 1, entry->Live());
+}
+
+Napi::Value HueSessionManager::StopEffect(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Entry* entry = FindSession(info);
+    if (!entry) {
+        return env.Undefined();
+    }
+
+    StreamSession* session = entry->Live();
+    if (!session || !session->Engine()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    session->LockMixer();
+    bool wasRunning = session->Engine()->IsRunning();
+    session->Engine()->Halt();
+    session->UnlockMixer();
+
+    return Napi::Boolean::New(env, wasRunning);
+}
+
+Napi::Value HueSessionManager::GetLightIds(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Entry* entry = FindSession(info);
+    if (!entry) {
+        return env.Undefined();
+    }
+
+    const LightTable& lights = entry->session->Lights();
+    Napi::Array lightIds = Napi::Array::New(env, lights.Size());
+    for (size_t slot = 0; slot < lights.Size(); ++slot) {
+        lightIds.Set(static_cast<uint32_t>(slot), Napi::String::New(env, lights.Id(slot)));
+    }
+    return lightIds;
+}
+
+// getCapturedFrames(id, sinceSeq = 0)
+Napi::Value HueSessionManager::GetCapturedFrames(const Napi::CallbackInfo& info) {
+    Entry* entry = FindSession(info);
+    if (!entry) {
+        return info.Env().Undefined();
+    }
+    return CapturedFrames(info.Env(), entry->session.get(), ReadSequence(info, 1));
+}
+
+// Scheduler totals plus the getStats() counters of every session
+Napi::Value HueSessionManager::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("fps", Napi::Number::New(env, scheduler_->Fps()));
+    stats.Set("running", Napi::Boolean::New(env, scheduler_->IsRunning()));
+    stats.Set("ticks", Napi::Number::New(env, static_cast<double>(scheduler_->Ticks())));
+    stats.Set("lateTicks", Napi::Number::New(env, static_cast<double>(scheduler_->LateTicks())));
+    stats.Set("tickSpreadUs", Napi::Number::New(env, scheduler_->LastSpreadNs() / 1000.0));
+
+    Napi::Array sessions = Napi::Array::New(env, sessions_.size());
+    uint32_t index = 0;
+    for (auto& item : sessions_) {
+        const StreamSession& session = *item.second.session;
+
+        Napi::Object entry = StreamStatsToJs(env, session, item.second.statsWindow);
+        entry.Set("id", Napi::Number::New(env, item.first));
+        entry.Set("bridgeId", Napi::String::New(env, item.second.credentials.id));
+        entry.Set("groupId", Napi::String::New(env, item.second.groupId));
+        entry.Set("streaming", Napi::Boolean::New(env, session.IsStreaming()));
+        sessions.Set(index++, entry);
+    }
+    stats.Set("sessions", sessions);
+    return stats;
+}
+
+// setRatePolicy(policy): applies to every session, including later ones. The
+// scheduler only idles while all of its sessions idle.
+Napi::Value HueSessionManager::SetRatePolicy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    RatePolicy policy = ratePolicy_;
+    if (!ReadRatePolicy(env, info.Length() > 0 ? info[0] : env.Undefined(), policy)) {
+        return env.Undefined();
+    }
+    ratePolicy_ = policy;
+    for (auto& item : sessions_) {
+        item.second.session->SetRatePolicy(policy);
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value HueSessionManager::Shutdown(const Napi::CallbackInfo& info) {
+    Close();
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+// ============= Color Kernels =============
+// Stateless batch color math over Float32Arrays. Each function writes into
+// the caller's output array (which may be the input) and returns it.
+
+static bool ReadFloats(Napi::Env env, const Napi::Value& value, const char* name, Napi::Float32Array& array) {
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, std::string(name) + " must be a Float32Array").ThrowAsJavaScriptException();
+        return false;
+    }
+    array = value.As<Napi::Float32Array>();
+    return true;
+}
+
+static bool CheckLength(Napi::Env env, const Napi::Float32Array& array, const char* name, size_t expected) {
+    if (array.ElementLength() < expected) {
+        Napi::RangeError::New(env, std::string(name) + " is too short for the output frame")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+// lerpColors(a, b, t, out): a and b hold one color or one per light, t one
+// factor (number or length-1 array) or one per light; out holds r, g, b per light
+static Napi::Value LerpColors(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 4) {
+        Napi::TypeError::New(env, "Expected a, b, t, out").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Float32Array a, b, t, out;
+    if (!ReadFloats(env, info[0], "a", a) || !ReadFloats(env, info[1], "b", b) ||
+        !ReadFloats(env, info[3], "out", out)) {
+        return env.Undefined();
+    }
+
+    size_t count = out.ElementLength() / 3;
+    size_t aStride = a.ElementLength() == 3 ? 0 : 3;
+    size_t bStride = b.ElementLength() == 3 ? 0 : 3;
+    if (!CheckLength(env, a, "a", aStride * count) || !CheckLength(env, b, "b", bStride * count) ||
+        !CheckLength(env, a, "a", 3) || !CheckLength(env, b, "b", 3)) {
+        return env.Undefined();
+    }
+
+    float factor = 0;
+    const float* factors = &factor;
+    size_t tStride = 0;
+    if (info[2].IsNumber()) {
+        factor = info[2].As<Napi::Number>().FloatValue();
+    } else {
+        if (!ReadFloats(env, info[2], "t", t)) {
+            return env.Undefined();
+        }
+        tStride = t.ElementLength() == 1 ? 0 : 1;
+        if (!CheckLength(env, t, "t", std::max<size_t>(tStride * count, 1))) {
+            return env.Undefined();
+        }
+        factors = t.Data();
+    }
+
+    BatchLerp(a.Data(), aStride, b.Data(), bStride, factors, tStride, out.Data(), count);
+    return out;
+}
+
+// hsvToRgb(hsv, out): h, s, v (0-1) per light to r, g, b (0-255)
+static Napi::Value HsvToRgbFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected hsv, out").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Float32Array hsv, out;
+    if (!ReadFloats(env, info[0], "hsv", hsv) || !ReadFloats(env, info[1], "out", out)) {
+        return env.Undefined();
+    }
+    size_t count = out.ElementLength() / 3;
+    if (!CheckLength(env, hsv, "hsv", count * 3)) {
+        return env.Undefined();
+    }
+    BatchHsvToRgb(hsv.Data(), out.Data(), count);
+    return out;
+}
+
+// rgbToXy(rgb, out): r, g, b (0-255) per light to x, y, brightness
+static Napi::Value RgbToXyFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected rgb, out").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Float32Array rgb, out;
+    if (!ReadFloats(env, info[0], "rgb", rgb) || !ReadFloats(env, info[1], "out", out)) {
+        return env.Undefined();
+    }
+    size_t count = out.ElementLength() / 3;
+    if (!CheckLength(env, rgb, "rgb", count * 3)) {
+        return env.Undefined();
+    }
+    BatchRgbToXy(rgb.Data(), out.Data(), count);
+    return out;
+}
+
+// applyGamma(data, gamma, out) and scaleBrightness(data, scale, out) work on
+// every value of the array
+template <void (*Kernel)(const float*, float*, size_t, float)>
+static Napi::Value ScalarKernel(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected data, number, out").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Float32Array data, out;
+    if (!ReadFloats(env, info[0], "data", data) || !ReadFloats(env, info[2], "out", out)) {
+        return env.Undefined();
+    }
+    if (!CheckLength(env, data, "data", out.ElementLength())) {
+        return env.Undefined();
+    }
+    Kernel(data.Data(), out.Data(), out.ElementLength(), info[1].As<Napi::Number>().FloatValue());
+    return out;
+}
+
+// ============= Frame Cache =============
+// One precomputed cycle per periodic effect look, shared by every session
+
+// setLimit(bytes): 0 disables caching for effects started afterwards
+static Napi::Value SetFrameCacheLimit(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().DoubleValue() < 0) {
+        Napi::TypeError::New(env, "Expected byte limit").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    FrameCache::Instance().SetLimit(static_cast<size_t>(info[0].As<Napi::Number>().DoubleValue()));
+    return Napi::Boolean::New(env, true);
+}
+
+static Napi::Value ClearFrameCache(const Napi::CallbackInfo& info) {
+    FrameCache::Instance().Clear();
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+static Napi::Value FrameCacheStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    FrameCache::Stats stats = FrameCache::Instance().GetStats();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("limitBytes", Napi::Number::New(env, static_cast<double>(stats.limitBytes)));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(stats.bytes)));
+    result.Set("tables", Napi::Number::New(env, static_cast<double>(stats.tables)));
+    result.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+    result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    result.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+    return result;
+}
+
+// ============= Module =============
+
+void AddonData::CloseAll() {
+    for (HueWrapper* wrapper : wrappers) {
+        wrapper->Close();
+        wrapper->StopStateEvents();
+    }
+    for (HueSessionManager* manager : managers) {
+        manager->Close();
+    }
+}
+
+// Runs once per environment that loads the addon
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    AddonData* data = new AddonData();
+    env.SetInstanceData(data);
+    // Hooks run before the environment finalizes its objects and instance data
+    env.AddCleanupHook([data]() { data->CloseAll(); });
+
     HueWrapper::Init(env, exports);
+    HueSessionManager::Init(env, exports);
+
+    Napi::Object kernels = Napi::Object::New(env);
+    kernels.Set("isa", Napi::String::New(env, ColorKernelIsa()));
+    kernels.Set("lerpColors", Napi::Function::New(env, LerpColors, "lerpColors"));
+    kernels.Set("hsvToRgb", Napi::Function::New(env, HsvToRgbFrame, "hsvToRgb"));
+    kernels.Set("rgbToXy", Napi::Function::New(env, RgbToXyFrame, "rgbToXy"));
+    kernels.Set("applyGamma", Napi::Function::New(env, ScalarKernel<BatchGamma>, "applyGamma"));
+    kernels.Set("scaleBrightness", Napi::Function::New(env, ScalarKernel<BatchScale>, "scaleBrightness"));
+    exports.Set("colorKernels", kernels);
+
+    Napi::Object frameCache = Napi::Object::New(env);
+    frameCache.Set("setLimit", Napi::Function::New(env, SetFrameCacheLimit, "setLimit"));
+    frameCache.Set("clear", Napi::Function::New(env, ClearFrameCache, "clear"));
+    frameCache.Set("stats", Napi::Function::New(env, FrameCacheStats, "stats"));
+    exports.Set("frameCache", frameCache);
+
+    exports.Set("readCaptureFile", Napi::Function::New(env, ReadCaptureFile, "readCaptureFile"));
     return exports;
 }
 
@@ -0,0 +1,167 @@
+#include "layer_stack.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace huestream;
+
+namespace {
+
+double BlendChannel(BlendMode mode, double below, double above) {
+    switch (mode) {
+        case BlendMode::Add:
+            return std::min(below + above, 1.0);
+        case BlendMode::Multiply:
+            return below * above;
+        case BlendMode::Max:
+            return std::max(below, above);
+        case BlendMode::Normal:
+        default:
+            return above;
+    }
+}
+
+}  // namespace
+
+bool ParseBlendMode(const std::string& name, BlendMode& mode) {
+    if (name == "normal") {
+        mode = BlendMode::Normal;
+    } else if (name == "add") {
+        mode = BlendMode::Add;
+    } else if (name == "multiply") {
+        mode = BlendMode::Multiply;
+    } else if (name == "max") {
+        mode = BlendMode::Max;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* BlendModeName(BlendMode mode) {
+    switch (mode) {
+        case BlendMode::Add: return "add";
+        case BlendMode::Multiply: return "multiply";
+        case BlendMode::Max: return "max";
+        case BlendMode::Normal:
+        default: return "normal";
+    }
+}
+
+LayerStack::LayerStack(const std::string& name, unsigned int layer)
+    : Effect(name, layer) {
+}
+
+FrameEffect* LayerStack::Add(const std::string& name, const LayerOptions& options, const LightTable& table) {
+    if (Find(name)) {
+        return nullptr;
+    }
+    auto frame = std::make_shared<FrameEffect>(name, 0);
+    frame->Resize(table);
+    frame->SetCorrector(corrector_);
+    layers_.push_back(Layer{name, options, frame});
+    Sort();
+    return frame.get();
+}
+
+bool LayerStack::Remove(const std::string& name) {
+    auto it = std::find_if(layers_.begin(), layers_.end(), [&](const Layer& layer) { return layer.name == name; });
+    if (it == layers_.end()) {
+        return false;
+    }
+    layers_.erase(it);
+    return true;
+}
+
+bool LayerStack::SetOptions(const std::string& name, const LayerOptions& options) {
+    for (Layer& layer : layers_) {
+        if (layer.name == name) {
+            layer.options = options;
+            Sort();
+            return true;
+        }
+    }
+    return false;
+}
+
+void LayerStack::Resize(const LightTable& table) {
+    for (Layer& layer : layers_) {
+        layer.frame->Resize(table);
+    }
+}
+
+void LayerStack::SetCorrector(std::shared_ptr<const OutputCorrector> corrector) {
+    corrector_ = std::move(corrector);
+    for (Layer& layer : layers_) {
+        layer.frame->SetCorrector(corrector_);
+    }
+}
+
+FrameEffect* LayerStack::Find(const std::string& name) const {
+    for (const Layer& layer : layers_) {
+        if (layer.name == name) {
+            return layer.frame.get();
+        }
+    }
+    return nullptr;
+}
+
+bool LayerStack::GetOptions(const std::string& name, LayerOptions& options) const {
+    for (const Layer& layer : layers_) {
+        if (layer.name == name) {
+            options = layer.options;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> LayerStack::Names() const {
+    std::vector<std::string> names;
+    for (const Layer& layer : layers_) {
+        names.push_back(layer.name);
+    }
+    return names;
+}
+
+void LayerStack::Sort() {
+    std::stable_sort(layers_.begin(), layers_.end(), [](const Layer& a, const Layer& b) {
+        return a.options.priority < b.options.priority;
+    });
+}
+
+void LayerStack::Render() {
+    for (Layer& layer : layers_) {
+        layer.frame->Render();
+    }
+}
+
+// Separable blending over a possibly transparent backdrop: where nothing
+// is below, a layer shows its own color whatever its mode; the blended
+// color is then composited with alpha-over
+Color LayerStack::GetColor(LightPtr light) {
+    double r = 0, g = 0, b = 0, alpha = 0;
+    for (Layer& layer : layers_) {
+        Color color = layer.frame->GetColor(light);
+        double layerAlpha = color.GetAlpha() * layer.options.opacity;
+        if (layerAlpha <= 0) {
+            continue;
+        }
+        BlendMode mode = layer.options.blend;
+        double lr = (1 - alpha) * color.GetR() + alpha * BlendChannel(mode, r, color.GetR());
+        double lg = (1 - alpha) * color.GetG() + alpha * BlendChannel(mode, g, color.GetG());
+        double lb = (1 - alpha) * color.GetB() + alpha * BlendChannel(mode, b, color.GetB());
+
+        double outAlpha = layerAlpha + alpha * (1 - layerAlpha);
+        double below = alpha * (1 - layerAlpha);
+        r = (lr * layerAlpha + r * below) / outAlpha;
+        g = (lg * layerAlpha + g * below) / outAlpha;
+        b = (lb * layerAlpha + b * below) / outAlpha;
+        alpha = outAlpha;
+    }
+    return Color(r, g, b, alpha);
+}
+
+std::string LayerStack::GetTypeName() const {
+    return "hue_edk.LayerStack";
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "huestream/common/data/Color.h"
+#include "huestream/common/data/Light.h"
+#include "huestream/effect/effects/base/Effect.h"
+
+#include "frame_effect.h"
+#include "light_table.h"
+#include "output_lut.h"
+
+// How a layer combines with the layers below it
+enum class BlendMode : uint8_t {
+    Normal = 0,
+    Add = 1,
+    Multiply = 2,
+    Max = 3
+};
+
+// "normal", "add", "multiply", "max"
+bool ParseBlendMode(const std::string& name, BlendMode& mode);
+const char* BlendModeName(BlendMode mode);
+
+struct LayerOptions {
+    int priority = 0;      // higher priorities are drawn on top
+    double opacity = 1;    // 0-1, multiplies each light's alpha
+    BlendMode blend = BlendMode::Normal;
+};
+
+// Named color layers composited natively into one mixer effect. The EDK
+// mixer can only stack effects with alpha-over, so the blend modes are
+// applied here; the result is mixed over the layers below like any effect.
+//
+// Each layer is a FrameEffect used as a buffer (it is not added to the
+// mixer): its producer writes and publishes without the mixer lock, and
+// Render() picks up every layer's newest frame. Adding, removing and
+// reconfiguring layers requires LockMixer(); Find() and List() run on the
+// JS thread, which is the only thread that changes the set.
+class LayerStack : public huestream::Effect {
+public:
+    LayerStack(const std::string& name, unsigned int layer);
+
+    // Returns nullptr if a layer of that name exists
+    FrameEffect* Add(const std::string& name, const LayerOptions& options, const LightTable& table);
+    bool Remove(const std::string& name);
+    bool SetOptions(const std::string& name, const LayerOptions& options);
+    // Resizes every layer for the table's lights; their colors are cleared
+    void Resize(const LightTable& table);
+    // Output correction for every layer, including ones added later
+    void SetCorrector(std::shared_ptr<const OutputCorrector> corrector);
+
+    FrameEffect* Find(const std::string& name) const;
+    bool GetOptions(const std::string& name, LayerOptions& options) const;
+    std::vector<std::string> Names() const;
+    bool Empty() const { return layers_.empty(); }
+
+    void Render() override;
+    huestream::Color GetColor(huestream::LightPtr light) override;
+    std::string GetTypeName() const override;
+
+private:
+    struct Layer {
+        std::string name;
+        LayerOptions options;
+        std::shared_ptr<FrameEffect> frame;
+    };
+
+    // Bottom first; stable, so equal priorities keep their creation order
+    void Sort();
+
+    std::vector<Layer> layers_;
+    std::shared_ptr<const OutputCorrector> corrector_;
+};
@@ -0,0 +1,71 @@
+#include "light_table.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace huestream;
+
+bool LightTable::Sync(const GroupPtr& group) {
+    LightListPtr lights = group ? group->GetLights() : nullptr;
+    if (group == group_ && lights == lightList_ && (!lights || lights->size() == ids_.size())) {
+        return false;
+    }
+
+    Clear();
+    group_ = group;
+    lightList_ = lights;
+    if (!lights) {
+        return true;
+    }
+
+    for (auto& light : *lights) {
+        int slot = static_cast<int>(ids_.size());
+        ids_.push_back(light->GetId());
+        lights_.push_back(light);
+        Location position = light->GetPosition();
+        positions_.x.push_back(static_cast<float>(position.GetX()));
+        positions_.y.push_back(static_cast<float>(position.GetY()));
+        positions_.z.push_back(static_cast<float>(position.GetZ()));
+
+        // Entertainment light IDs are small integers; anything else is only
+        // reachable through its slot
+        const std::string& id = ids_.back();
+        char* end = nullptr;
+        long numericId = std::strtol(id.c_str(), &end, 10);
+        if (!id.empty() && *end == '\0' && numericId >= 0 && numericId < 4096) {
+            if (static_cast<size_t>(numericId) >= slotById_.size()) {
+                slotById_.resize(numericId + 1, -1);
+            }
+            slotById_[numericId] = slot;
+        }
+    }
+    return true;
+}
+
+void LightTable::Clear() {
+    group_.reset();
+    lightList_.reset();
+    ids_.clear();
+    lights_.clear();
+    positions_ = LightPositions();
+    slotById_.clear();
+}
+
+int LightSlotCache::Find(const LightPtr& light, const std::vector<std::string>& ids) {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), light.get(),
+                               [](const Entry& entry, const Light* address) { return entry.address < address; });
+    if (it != entries_.end() && it->address == light.get()) {
+        return it->slot;
+    }
+
+    // Group refreshes bring new light objects; forget the old ones rather
+    // than grow without bound
+    if (entries_.size() >= std::max<size_t>(ids.size(), 16) * 2) {
+        entries_.clear();
+        it = entries_.end();
+    }
+    auto id = std::find(ids.begin(), ids.end(), light->GetId());
+    int slot = id == ids.end() ? -1 : static_cast<int>(id - ids.begin());
+    entries_.insert(it, Entry{light.get(), light, slot});
+    return slot;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "huestream/common/data/Group.h"
+#include "huestream/common/data/Light.h"
+
+// Entertainment-area positions of a light table's lights, one array per axis
+// in slot order (x left to right, y back to front, z floor to ceiling, each
+// about -1 to 1), so spatial math runs over contiguous floats
+struct LightPositions {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    size_t Size() const { return x.size(); }
+};
+
+// Dense snapshot of the selected group's lights, built once per group
+// selection so the per-frame setters never walk the EDK group or format
+// light IDs. Slots are positions in the group's light list; JS light IDs
+// (small integers) map to slots through a direct lookup table.
+class LightTable {
+public:
+    // Rebuilds the table if the group (or its light list) differs from the
+    // one it was built from. Returns true when the table changed.
+    bool Sync(const huestream::GroupPtr& group);
+    void Clear();
+
+    size_t Size() const { return ids_.size(); }
+    const std::string& Id(size_t slot) const { return ids_[slot]; }
+    const huestream::LightPtr& Light(size_t slot) const { return lights_[slot]; }
+    const LightPositions& Positions() const { return positions_; }
+
+    // Slot for a numeric JS light ID, or -1 if the light is not in the group
+    int SlotForId(int lightId) const {
+        return lightId >= 0 && static_cast<size_t>(lightId) < slotById_.size() ? slotById_[lightId] : -1;
+    }
+
+private:
+    huestream::GroupPtr group_;
+    huestream::LightListPtr lightList_;
+    std::vector<std::string> ids_;
+    std::vector<huestream::LightPtr> lights_;
+    LightPositions positions_;
+    std::vector<int> slotById_;
+};
+
+// Light -> slot lookup for effects that only see the EDK's light objects,
+// learned the first time each one is rendered so GetColor() does not compare
+// ID strings every frame. Keeps the lights alive, so a freed light's address
+// can never come back as a different light, and is sorted by address.
+class LightSlotCache {
+public:
+    void Clear() { entries_.clear(); }
+    // Slot of light's ID in ids, or -1
+    int Find(const huestream::LightPtr& light, const std::vector<std::string>& ids);
+
+private:
+    struct Entry {
+        const huestream::Light* address;
+        huestream::LightPtr light;
+        int slot;
+    };
+    std::vector<Entry> entries_;
+};
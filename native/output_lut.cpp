@@ -0,0 +1,224 @@
+#include "output_lut.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+using namespace huestream;
+
+namespace {
+
+struct Point {
+    double x;
+    double y;
+};
+
+// Red, green, blue corners of each gamut, counter-clockwise
+const Point kGamuts[3][3] = {
+    {{0.704, 0.296}, {0.2151, 0.7106}, {0.138, 0.08}},
+    {{0.675, 0.322}, {0.409, 0.518}, {0.167, 0.04}},
+    {{0.6915, 0.3083}, {0.17, 0.7}, {0.1532, 0.0475}},
+};
+
+// Wide gamut D65 conversion used by the Hue API, and its inverse
+const double kToXyz[3][3] = {
+    {0.664511, 0.154324, 0.162028},
+    {0.283881, 0.668433, 0.047685},
+    {0.000088, 0.072310, 0.986039},
+};
+const double kFromXyz[3][3] = {
+    {1.656494, -0.354852, -0.255038},
+    {-0.707196, 1.655399, 0.036153},
+    {0.051714, -0.121365, 1.011530},
+};
+
+double Linearize(double c) {
+    return c > 0.04045 ? std::pow((c + 0.055) / 1.055, 2.4) : c / 12.92;
+}
+
+double Encode(double c, double gamma) {
+    if (gamma > 0) {
+        return std::pow(c, 1.0 / gamma);
+    }
+    return c > 0.0031308 ? 1.055 * std::pow(c, 1.0 / 2.4) - 0.055 : c * 12.92;
+}
+
+double Cross(const Point& a, const Point& b, const Point& p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+Point ClosestOnEdge(const Point& a, const Point& b, const Point& p) {
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double t = std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / (dx * dx + dy * dy), 0.0, 1.0);
+    return {a.x + t * dx, a.y + t * dy};
+}
+
+double Distance2(const Point& a, const Point& b) {
+    return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+}
+
+Point ClipToGamut(const Point* corners, const Point& p) {
+    if (Cross(corners[0], corners[1], p) >= 0 && Cross(corners[1], corners[2], p) >= 0 &&
+        Cross(corners[2], corners[0], p) >= 0) {
+        return p;
+    }
+    Point best = ClosestOnEdge(corners[0], corners[1], p);
+    for (int edge = 1; edge < 3; ++edge) {
+        Point candidate = ClosestOnEdge(corners[edge], corners[(edge + 1) % 3], p);
+        if (Distance2(candidate, p) < Distance2(best, p)) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+}  // namespace
+
+Gamut GamutForModel(const std::string& modelId) {
+    static const char* const kGamutA[] = {
+        "LST001", "LLC005", "LLC006", "LLC007", "LLC010", "LLC011", "LLC012", "LLC013", "LLC014",
+    };
+    static const char* const kGamutB[] = {"LCT001", "LCT002", "LCT003", "LCT007", "LLM001"};
+    for (const char* model : kGamutA) {
+        if (modelId == model) {
+            return Gamut::A;
+        }
+    }
+    for (const char* model : kGamutB) {
+        if (modelId == model) {
+            return Gamut::B;
+        }
+    }
+    return Gamut::C;
+}
+
+const char* GamutName(Gamut gamut) {
+    switch (gamut) {
+        case Gamut::A: return "A";
+        case Gamut::B: return "B";
+        case Gamut::C: return "C";
+    }
+    return "C";
+}
+
+void CorrectColorExact(Gamut gamut, double gamma, const double in[3], double out[3]) {
+    double linear[3];
+    for (int c = 0; c < 3; ++c) {
+        linear[c] = Linearize(std::clamp(in[c], 0.0, 1.0));
+    }
+    double xyz[3];
+    for (int row = 0; row < 3; ++row) {
+        xyz[row] = kToXyz[row][0] * linear[0] + kToXyz[row][1] * linear[1] + kToXyz[row][2] * linear[2];
+    }
+    double sum = xyz[0] + xyz[1] + xyz[2];
+    if (sum < 1e-9) {
+        out[0] = out[1] = out[2] = 0.0;
+        return;
+    }
+
+    // Same luminance at the nearest chromaticity the light can show
+    Point xy = ClipToGamut(kGamuts[static_cast<int>(gamut)], {xyz[0] / sum, xyz[1] / sum});
+    double Y = xyz[1];
+    double clipped[3] = {xy.x * Y / xy.y, Y, (1.0 - xy.x - xy.y) * Y / xy.y};
+
+    double peak = 0.0;
+    for (int row = 0; row < 3; ++row) {
+        linear[row] = std::max(0.0, kFromXyz[row][0] * clipped[0] + kFromXyz[row][1] * clipped[1] +
+                                    kFromXyz[row][2] * clipped[2]);
+        peak = std::max(peak, linear[row]);
+    }
+    // Out of range after clipping: scale down, keeping the chromaticity
+    double scale = peak > 1.0 ? 1.0 / peak : 1.0;
+    for (int c = 0; c < 3; ++c) {
+        out[c] = Encode(linear[c] * scale, gamma);
+    }
+}
+
+// ============= OutputLut =============
+
+OutputLut::OutputLut(Gamut gamut, double gamma)
+    : gamut_(gamut),
+      gamma_(gamma),
+      table_(kSize * kSize * kSize * 3) {
+    size_t index = 0;
+    for (int r = 0; r < kSize; ++r) {
+        for (int g = 0; g < kSize; ++g) {
+            for (int b = 0; b < kSize; ++b) {
+                double in[3] = {r / (kSize - 1.0), g / (kSize - 1.0), b / (kSize - 1.0)};
+                double out[3];
+                CorrectColorExact(gamut, gamma, in, out);
+                for (int c = 0; c < 3; ++c) {
+                    table_[index++] = static_cast<uint16_t>(std::lround(std::clamp(out[c], 0.0, 1.0) * 65535.0));
+                }
+            }
+        }
+    }
+}
+
+void OutputLut::Apply(const double in[3], double out[3]) const {
+    int base[3];
+    double frac[3];
+    for (int c = 0; c < 3; ++c) {
+        double position = std::clamp(in[c], 0.0, 1.0) * (kSize - 1);
+        base[c] = std::min(static_cast<int>(position), kSize - 2);
+        frac[c] = position - base[c];
+    }
+
+    const size_t strideR = kSize * kSize * 3;
+    const size_t strideG = kSize * 3;
+    const uint16_t* p = table_.data() + base[0] * strideR + base[1] * strideG + base[2] * 3;
+    for (int c = 0; c < 3; ++c) {
+        double c00 = p[c] + (p[c + 3] - p[c]) * frac[2];
+        double c01 = p[c + strideG] + (p[c + strideG + 3] - p[c + strideG]) * frac[2];
+        double c10 = p[c + strideR] + (p[c + strideR + 3] - p[c + strideR]) * frac[2];
+        double c11 = p[c + strideR + strideG] + (p[c + strideR + strideG + 3] - p[c + strideR + strideG]) * frac[2];
+        double c0 = c00 + (c01 - c00) * frac[1];
+        double c1 = c10 + (c11 - c10) * frac[1];
+        out[c] = (c0 + (c1 - c0) * frac[0]) * (1.0 / 65535.0);
+    }
+}
+
+std::shared_ptr<const OutputLut> AcquireOutputLut(Gamut gamut, double gamma) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, double>, std::weak_ptr<const OutputLut>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = tables[{static_cast<int>(gamut), gamma}];
+    std::shared_ptr<const OutputLut> lut = entry.lock();
+    if (!lut) {
+        lut = std::make_shared<OutputLut>(gamut, gamma);
+        entry = lut;
+    }
+    return lut;
+}
+
+// ============= OutputCorrector =============
+
+OutputCorrector::OutputCorrector(const LightTable& table, const OutputCorrection& correction) {
+    for (size_t slot = 0; slot < table.Size(); ++slot) {
+        ids_.push_back(table.Id(slot));
+        luts_.push_back(AcquireOutputLut(GamutForModel(table.Light(slot)->GetModel()), correction.gamma));
+    }
+}
+
+Color OutputCorrector::ApplySlot(size_t slot, const Color& color) const {
+    return Apply(slot < luts_.size() ? luts_[slot].get() : nullptr, color);
+}
+
+const OutputLut* OutputCorrector::ForId(const std::string& id) const {
+    auto it = std::find(ids_.begin(), ids_.end(), id);
+    return it == ids_.end() ? nullptr : luts_[it - ids_.begin()].get();
+}
+
+Color OutputCorrector::Apply(const OutputLut* lut, const Color& color) {
+    if (!lut) {
+        return color;
+    }
+    double in[3] = {color.GetR(), color.GetG(), color.GetB()};
+    double out[3];
+    lut->Apply(in, out);
+    return Color(out[0], out[1], out[2], color.GetAlpha());
+}
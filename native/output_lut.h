@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "huestream/common/data/Color.h"
+
+#include "light_table.h"
+
+// Color gamut of a Hue light, from its model id
+enum class Gamut : uint8_t {
+    A = 0,  // early LivingColors and LightStrips
+    B = 1,  // first generation bulbs
+    C = 2,  // everything since, and unknown models
+};
+
+Gamut GamutForModel(const std::string& modelId);
+const char* GamutName(Gamut gamut);
+
+// Opt-in correction of the colors sent to each light: sRGB input is clipped
+// to the light's gamut (keeping luminance and moving the chromaticity to
+// the nearest point the light can show) and re-encoded with gamma, or the
+// sRGB transfer curve when gamma is 0. In-gamut colors with gamma 0 pass
+// through unchanged.
+struct OutputCorrection {
+    bool enabled = false;
+    double gamma = 0;
+};
+
+// Reference conversion, rgb in 0-1. Slow: two transfer curves and a gamut
+// test per color; OutputLut tabulates it.
+void CorrectColorExact(Gamut gamut, double gamma, const double in[3], double out[3]);
+
+// CorrectColorExact sampled on a 33^3 grid over the sRGB input cube and read
+// back with trilinear interpolation: a fixed handful of loads and multiplies
+// per color whatever the gamut. Immutable once built.
+class OutputLut {
+public:
+    static const int kSize = 33;
+
+    OutputLut(Gamut gamut, double gamma);
+
+    Gamut GetGamut() const { return gamut_; }
+    double Gamma() const { return gamma_; }
+    void Apply(const double in[3], double out[3]) const;
+
+private:
+    Gamut gamut_;
+    double gamma_;
+    std::vector<uint16_t> table_;  // r, g, b per grid point; blue varies fastest
+};
+
+// Tables are shared by every light and session with the same gamut and gamma,
+// and built on first use
+std::shared_ptr<const OutputLut> AcquireOutputLut(Gamut gamut, double gamma);
+
+// The tables for one light table's lights, in slot order. Immutable; a new
+// one is built whenever the lights or the correction change, and handed to
+// the layers under the mixer lock.
+class OutputCorrector {
+public:
+    OutputCorrector(const LightTable& table, const OutputCorrection& correction);
+
+    // Correction for a slot or light id; color passes through for unknown lights
+    huestream::Color ApplySlot(size_t slot, const huestream::Color& color) const;
+    const OutputLut* ForId(const std::string& id) const;
+    static huestream::Color Apply(const OutputLut* lut, const huestream::Color& color);
+
+    size_t Size() const { return luts_.size(); }
+    const std::string& Id(size_t slot) const { return ids_[slot]; }
+    Gamut GamutAt(size_t slot) const { return luts_[slot]->GetGamut(); }
+
+private:
+    std::vector<std::string> ids_;
+    std::vector<std::shared_ptr<const OutputLut>> luts_;
+};
@@ -0,0 +1,163 @@
+#include "render_scheduler.h"
+
+#include <algorithm>
+
+RenderScheduler::RenderScheduler(int fps)
+    : fps_(std::max(fps, 1)),
+      period_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / std::max(fps, 1)))),
+      running_(false),
+      ticks_(0),
+      lateTicks_(0),
+      lastSpreadNs_(0) {
+}
+
+RenderScheduler::~RenderScheduler() {
+    Stop();
+    // Sessions can outlive the scheduler; none may wake it after this
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        entry->session->SetWakeCallback(nullptr);
+    }
+}
+
+void RenderScheduler::Add(const std::shared_ptr<StreamSession>& session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        if (entry->session == session) {
+            return;
+        }
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->session = session;
+    session->SetWakeCallback([this]() { Wake(); });
+    entries_.push_back(std::move(entry));
+}
+
+void RenderScheduler::Remove(const std::shared_ptr<StreamSession>& session) {
+    std::shared_ptr<Entry> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if ((*it)->session == session) {
+                removed = std::move(*it);
+                entries_.erase(it);
+                break;
+            }
+        }
+    }
+    if (!removed) {
+        return;
+    }
+    // The render thread may have taken the entry for the current tick; its
+    // lock waits out a render in progress, and the reference is dropped here
+    // rather than on the render thread
+    session->SetWakeCallback(nullptr);
+    std::lock_guard<std::mutex> lock(removed->mutex);
+    removed->session.reset();
+}
+
+void RenderScheduler::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&RenderScheduler::Run, this);
+}
+
+void RenderScheduler::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    Wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void RenderScheduler::SetTickListener(TickListener listener) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tickListener_ = std::move(listener);
+    }
+    Wake();
+}
+
+void RenderScheduler::Wake() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeRequested_ = true;
+    }
+    wakeCv_.notify_one();
+}
+
+void RenderScheduler::Run() {
+    auto deadline = std::chrono::steady_clock::now();
+    while (running_.load(std::memory_order_relaxed)) {
+        // Earliest keep-alive frame when every session idles, 0 otherwise
+        int64_t idleUntilNs = 0;
+        {
+            // Same capacity every tick, so this does not allocate
+            std::lock_guard<std::mutex> lock(mutex_);
+            tick_.assign(entries_.begin(), entries_.end());
+        }
+        auto first = std::chrono::steady_clock::now();
+        auto last = first;
+        int64_t nowNs = StatsNowNs();
+        bool anyActive = false;
+        for (const auto& entry : tick_) {
+            std::lock_guard<std::mutex> lock(entry->mutex);
+            StreamSession* session = entry->session.get();
+            if (!session || !session->PollStreaming(nowNs)) {
+                continue;
+            }
+            int64_t nextNs = 0;
+            if (session->RenderDue(nowNs, nextNs)) {
+                last = std::chrono::steady_clock::now();
+                session->RenderFrame();
+            }
+            if (nextNs == 0) {
+                anyActive = true;
+            } else if (idleUntilNs == 0 || nextNs < idleUntilNs) {
+                idleUntilNs = nextNs;
+            }
+        }
+        tick_.clear();
+        lastSpreadNs_.store(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(last - first).count()),
+            std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (anyActive || tickListener_) {
+                idleUntilNs = 0;
+            }
+            uint64_t frame = ticks_.fetch_add(1, std::memory_order_relaxed);
+            if (tickListener_) {
+                int64_t deadlineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    (deadline + period_).time_since_epoch()).count();
+                tickListener_(Tick{frame, nowNs, deadlineNs});
+            }
+        }
+
+        if (idleUntilNs != 0) {
+            // Nothing changes: sleep until the next keep-alive frame or a wake,
+            // then restart the frame clock from there
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeCv_.wait_for(lock, std::chrono::nanoseconds(std::max<int64_t>(idleUntilNs - StatsNowNs(), 0)),
+                             [this]() { return wakeRequested_ || !running_.load(std::memory_order_relaxed); });
+            wakeRequested_ = false;
+            deadline = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        deadline += period_;
+        auto now = std::chrono::steady_clock::now();
+        if (now > deadline + period_) {
+            // Fell behind by more than a frame: skip ahead instead of bursting
+            lateTicks_.fetch_add(1, std::memory_order_relaxed);
+            deadline = now;
+            continue;
+        }
+        std::this_thread::sleep_until(deadline);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stream_session.h"
+
+// One frame clock for several externally rendered sessions. Each tick renders
+// every streaming session back to back, so all bridges get the same frame
+// in phase. Ticks are scheduled on absolute deadlines and do not drift.
+// While every session idles under an adaptive rate policy the thread sleeps
+// until the next keep-alive frame, and a change wakes it immediately.
+class RenderScheduler {
+public:
+    // One rendered tick: its index, when it ran and when the next tick is
+    // due (StatsNowNs() clock)
+    struct Tick {
+        uint64_t frame;
+        int64_t timeNs;
+        int64_t deadlineNs;
+    };
+    using TickListener = std::function<void(const Tick&)>;
+
+    explicit RenderScheduler(int fps = 60);
+    ~RenderScheduler();
+
+    // Sessions can be added and removed while running; the change takes
+    // effect on the next tick. Remove() only waits if that session is
+    // rendering right then; afterwards the scheduler holds no reference.
+    void Add(const std::shared_ptr<StreamSession>& session);
+    void Remove(const std::shared_ptr<StreamSession>& session);
+
+    void Start();
+    void Stop();
+    bool IsRunning() const { return running_.load(std::memory_order_relaxed); }
+    int Fps() const { return fps_; }
+
+    uint64_t Ticks() const { return ticks_.load(std::memory_order_relaxed); }
+    // Ticks that started more than a full period after their deadline
+    uint64_t LateTicks() const { return lateTicks_.load(std::memory_order_relaxed); }
+    // Time from the first to the last session render within the latest tick
+    uint64_t LastSpreadNs() const { return lastSpreadNs_.load(std::memory_order_relaxed); }
+
+    // Any thread: render on the next tick without waiting out an idle sleep
+    void Wake();
+
+    // Called on the render thread after every tick; must not block. While a
+    // listener is set the clock stays at the full rate. Replacing it waits
+    // for the current tick.
+    void SetTickListener(TickListener listener);
+
+private:
+    // A session and the lock held while it renders
+    struct Entry {
+        std::mutex mutex;
+        std::shared_ptr<StreamSession> session;  // guarded by mutex; null once removed
+    };
+
+    void Run();
+
+    int fps_;
+    std::chrono::steady_clock::duration period_;
+    // Guards entries_ and tickListener_; not held while sessions render, so
+    // adding or removing a session does not wait for a whole tick
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Entry>> entries_;
+    std::vector<std::shared_ptr<Entry>> tick_;  // render thread: this tick's entries
+    TickListener tickListener_;  // guarded by mutex_
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> ticks_;
+    std::atomic<uint64_t> lateTicks_;
+    std::atomic<uint64_t> lastSpreadNs_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool wakeRequested_ = false;  // guarded by wakeMutex_
+};
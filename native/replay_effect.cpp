@@ -0,0 +1,78 @@
+#include "replay_effect.h"
+
+#include <algorithm>
+
+#include "stream_stats.h"
+
+using namespace huestream;
+
+ReplayEffect::ReplayEffect(const std::string& name, unsigned int layer)
+    : Effect(name, layer) {
+}
+
+void ReplayEffect::Play(const std::string& path, bool loop) {
+    auto file = std::make_unique<CaptureFile>(path);
+    reader_ = std::make_unique<CaptureReader>(*file);
+    file_ = std::move(file);
+    loop_ = loop;
+    startNs_ = 0;
+    slotCache_.Clear();
+    framesPlayed_.store(0, std::memory_order_relaxed);
+    frameCount_.store(file_->Header().frameCount, std::memory_order_relaxed);
+    active_.store(!reader_->AtEnd(), std::memory_order_relaxed);
+}
+
+void ReplayEffect::Stop() {
+    active_.store(false, std::memory_order_relaxed);
+    reader_.reset();
+    file_.reset();
+}
+
+void ReplayEffect::Render() {
+    if (!active_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    int64_t now = StatsNowNs();
+    if (startNs_ == 0) {
+        startNs_ = now;
+    }
+
+    if (now < startNs_) {
+        return;  // between two loop passes
+    }
+
+    uint64_t elapsedUs = static_cast<uint64_t>((now - startNs_) / 1000);
+    while (!reader_->AtEnd() && reader_->NextTimeUs() <= elapsedUs) {
+        reader_->Next();
+        framesPlayed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!reader_->AtEnd()) {
+        return;
+    }
+
+    if (loop_) {
+        // The next pass starts one average frame interval after the last
+        // frame, keeping the cadence across the seam
+        uint64_t lastUs = reader_->NextTimeUs();
+        uint64_t frames = reader_->FrameIndex();
+        uint64_t intervalUs = frames > 1 ? lastUs / (frames - 1) : 16667;
+        startNs_ += static_cast<int64_t>(lastUs + intervalUs) * 1000;
+        reader_->Rewind();
+    } else {
+        active_.store(false, std::memory_order_relaxed);
+    }
+}
+
+Color ReplayEffect::GetColor(LightPtr light) {
+    bool playing = reader_ && active_.load(std::memory_order_relaxed);
+    int slot = playing ? slotCache_.Find(light, file_->LightIds()) : -1;
+    if (slot < 0) {
+        return Color(0, 0, 0, 0);
+    }
+    const uint16_t* rgb = reader_->Colors().data() + slot * 3;
+    return Color(rgb[0] / 65535.0, rgb[1] / 65535.0, rgb[2] / 65535.0, 1.0);
+}
+
+std::string ReplayEffect::GetTypeName() const {
+    return "hue_edk.ReplayEffect";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "huestream/common/data/Color.h"
+#include "huestream/common/data/Light.h"
+#include "huestream/effect/effects/base/Effect.h"
+
+#include "capture_file.h"
+#include "light_table.h"
+
+// Plays a capture file back on the render thread. Each tick applies every
+// frame whose recorded time has passed since playback started, so the show
+// keeps its original timing at the tick resolution; at the recording's frame
+// rate that is frame for frame. Lights are matched by id: those in the file
+// are fully opaque, all others transparent.
+//
+// Play() and Stop() require the mixer lock; the progress counters can be read
+// from any thread.
+class ReplayEffect : public huestream::Effect {
+public:
+    ReplayEffect(const std::string& name, unsigned int layer);
+
+    // Throws std::runtime_error if the file is not a readable capture
+    void Play(const std::string& path, bool loop);
+    void Stop();
+    bool IsActive() const { return active_.load(std::memory_order_relaxed); }
+
+    uint64_t FramesPlayed() const { return framesPlayed_.load(std::memory_order_relaxed); }
+    uint64_t FrameCount() const { return frameCount_.load(std::memory_order_relaxed); }
+
+    void Render() override;
+    huestream::Color GetColor(huestream::LightPtr light) override;
+    std::string GetTypeName() const override;
+
+private:
+    std::unique_ptr<CaptureFile> file_;
+    std::unique_ptr<CaptureReader> reader_;
+    bool loop_ = false;
+    int64_t startNs_ = 0;  // 0 until the first rendered tick
+    LightSlotCache slotCache_;
+
+    std::atomic<bool> active_{false};
+    std::atomic<uint64_t> framesPlayed_{0};
+    std::atomic<uint64_t> frameCount_{0};
+};
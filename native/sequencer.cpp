@@ -0,0 +1,178 @@
+#include "sequencer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const size_t kNoStep = static_cast<size_t>(-1);
+
+// colors[i] = light i; the last color repeats
+class SceneEffect : public NativeEffect {
+public:
+    using NativeEffect::NativeEffect;
+    bool Render(double, Rgb* out, size_t count) override {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = PaletteColor(i);
+        }
+        return false;
+    }
+};
+
+class SequenceEffect : public NativeEffect {
+public:
+    struct Step {
+        double startMs;
+        double crossfadeMs;
+        Easing easing;
+        std::unique_ptr<NativeEffect> source;
+        std::vector<size_t> slots;  // source slot -> sequence slot
+        std::vector<Rgb> scratch;
+        bool done = false;
+    };
+
+    SequenceEffect(std::vector<Step> steps, const SequenceOptions& options, size_t lightCount)
+        : NativeEffect(EffectParams()),
+          steps_(std::move(steps)),
+          duration_(options.durationMs),
+          loop_(options.loop),
+          output_(lightCount, Rgb{0, 0, 0}),
+          from_(lightCount, Rgb{0, 0, 0}),
+          frame_(lightCount, Rgb{0, 0, 0}) {}
+
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        double t = elapsedMs;
+        bool finished = false;
+        if (duration_ > 0) {
+            if (loop_) {
+                t = std::fmod(t, duration_);
+            } else if (t >= duration_) {
+                t = duration_;
+                finished = true;
+            }
+        }
+
+        // Going back (a loop or a seek, also within the current step) plays
+        // the steps from there again, even ones that had run to their end
+        if (t < lastMs_) {
+            for (Step& step : steps_) {
+                step.done = false;
+            }
+        }
+        lastMs_ = t;
+
+        size_t index = StepAt(t);
+        if (index != current_) {
+            Switch(index);
+        }
+        if (current_ != kNoStep) {
+            Step& step = steps_[current_];
+            if (!step.done) {
+                step.done = !RenderStep(step, t, frame_);
+            }
+            double into = t - step.startMs;
+            if (step.crossfadeMs > 0 && into < step.crossfadeMs) {
+                if (current_ > 0 && !steps_[current_ - 1].done) {
+                    Step& previous = steps_[current_ - 1];
+                    previous.done = !RenderStep(previous, t, from_);
+                }
+                double w = Ease(step.easing, into / step.crossfadeMs);
+                for (size_t i = 0; i < output_.size(); ++i) {
+                    output_[i] = {from_[i].r + (frame_[i].r - from_[i].r) * w,
+                                  from_[i].g + (frame_[i].g - from_[i].g) * w,
+                                  from_[i].b + (frame_[i].b - from_[i].b) * w};
+                }
+            } else {
+                output_ = frame_;
+                // Without a duration the sequence ends with its last step
+                finished = finished || (duration_ <= 0 && current_ + 1 == steps_.size() && step.done);
+            }
+        }
+
+        std::copy(output_.begin(), output_.begin() + std::min(count, output_.size()), out);
+        return !finished;
+    }
+
+private:
+    // Last step started by t, or kNoStep before the first
+    size_t StepAt(double t) const {
+        auto next = std::upper_bound(steps_.begin(), steps_.end(), t,
+                                     [](double time, const Step& step) { return time < step.startMs; });
+        return next == steps_.begin() ? kNoStep : static_cast<size_t>(next - steps_.begin()) - 1;
+    }
+
+    void Switch(size_t index) {
+        from_ = output_;
+        frame_ = output_;
+        current_ = index;
+    }
+
+    static bool RenderStep(Step& step, double t, std::vector<Rgb>& target) {
+        bool running = step.source->Render(t - step.startMs, step.scratch.data(), step.scratch.size());
+        for (size_t i = 0; i < step.slots.size(); ++i) {
+            target[step.slots[i]] = step.scratch[i];
+        }
+        return running;
+    }
+
+    std::vector<Step> steps_;  // by startMs
+    double duration_;
+    bool loop_;
+    size_t current_ = kNoStep;
+    double lastMs_ = 0;        // sequence time of the previous frame
+    std::vector<Rgb> output_;  // last frame sent, what a crossfade starts from
+    std::vector<Rgb> from_;    // outgoing step during a crossfade
+    std::vector<Rgb> frame_;   // current step
+};
+
+}  // namespace
+
+std::unique_ptr<NativeEffect> CreateSceneEffect(const std::vector<Rgb>& colors) {
+    EffectParams params;
+    params.colors = colors;
+    return std::unique_ptr<NativeEffect>(new SceneEffect(params));
+}
+
+std::unique_ptr<NativeEffect> CreateSequenceEffect(std::vector<SequenceStep> steps, const SequenceOptions& options,
+                                                   std::vector<int>& lightIds) {
+    if (steps.empty()) {
+        throw std::invalid_argument("sequence has no steps");
+    }
+    if (!std::isfinite(options.durationMs) || (options.loop && options.durationMs <= 0)) {
+        throw std::invalid_argument("a looping sequence needs a finite duration > 0");
+    }
+    for (const SequenceStep& step : steps) {
+        if (!step.source) {
+            throw std::invalid_argument("every step needs an effect, timeline or scene");
+        }
+        if (!std::isfinite(step.startMs) || step.startMs < 0 ||
+            !std::isfinite(step.crossfadeMs) || step.crossfadeMs < 0) {
+            throw std::invalid_argument("step times must be finite and >= 0");
+        }
+    }
+    std::stable_sort(steps.begin(), steps.end(),
+                     [](const SequenceStep& a, const SequenceStep& b) { return a.startMs < b.startMs; });
+
+    lightIds.clear();
+    std::vector<SequenceEffect::Step> compiled;
+    compiled.reserve(steps.size());
+    for (SequenceStep& step : steps) {
+        SequenceEffect::Step entry;
+        entry.startMs = step.startMs;
+        entry.crossfadeMs = step.crossfadeMs;
+        entry.easing = step.easing;
+        entry.source = std::move(step.source);
+        entry.scratch.resize(step.lightIds.size());
+        for (int id : step.lightIds) {
+            auto found = std::find(lightIds.begin(), lightIds.end(), id);
+            entry.slots.push_back(static_cast<size_t>(found - lightIds.begin()));
+            if (found == lightIds.end()) {
+                lightIds.push_back(id);
+            }
+        }
+        compiled.push_back(std::move(entry));
+    }
+    return std::unique_ptr<NativeEffect>(new SequenceEffect(std::move(compiled), options, lightIds.size()));
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "easing.h"
+#include "effect_engine.h"
+
+// One entry of a sequence: a native effect, timeline or static scene that
+// takes over at startMs. With crossfadeMs > 0 it blends in from whatever was
+// showing over that time, shaped by easing; 0 cuts on the tick it starts.
+struct SequenceStep {
+    double startMs = 0;
+    double crossfadeMs = 0;
+    Easing easing = Easing::Linear;
+    std::unique_ptr<NativeEffect> source;
+    std::vector<int> lightIds;  // the source's lights, in its slot order
+};
+
+// durationMs <= 0 ends the sequence once its last step has finished (never,
+// if that step runs until stopped). loop needs a duration.
+struct SequenceOptions {
+    double durationMs = 0;
+    bool loop = false;
+};
+
+// Static colors, one per light with the last one repeating. Renders once;
+// in a sequence its frame is held until the next step.
+std::unique_ptr<NativeEffect> CreateSceneEffect(const std::vector<Rgb>& colors);
+
+// Plays steps back to back from the render thread, so every switch lands on
+// a tick and each step sees its own time from its exact start offset, not
+// from the tick that started it. The sequence's lights are the union of the
+// steps' lights in order of first appearance and are returned in lightIds;
+// lights a step does not cover keep the color they had when it started.
+// Throws std::invalid_argument for no steps, a step without a source, bad
+// times or a loop without a duration.
+std::unique_ptr<NativeEffect> CreateSequenceEffect(std::vector<SequenceStep> steps, const SequenceOptions& options,
+                                                   std::vector<int>& lightIds);
@@ -0,0 +1,188 @@
+#include "shared_frame_effect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace huestream;
+
+namespace {
+
+// The producer writes raw floats: a NaN or infinity would pass std::clamp,
+// so non-finite channels count as 0
+double UnitChannel(float value, double scale) {
+    return std::isfinite(value) ? std::clamp(value / scale, 0.0, 1.0) : 0.0;
+}
+
+}  // namespace
+
+SharedFrameEffect::SharedFrameEffect(const std::string& name, unsigned int layer)
+    : Effect(name, layer) {
+}
+
+SharedFrameEffect::~SharedFrameEffect() {
+    Detach();
+}
+
+void SharedFrameEffect::Attach(const std::string& segmentName, const std::vector<int>& lightIds) {
+#ifdef _WIN32
+    (void)segmentName;
+    (void)lightIds;
+    throw std::runtime_error("shared-memory input needs POSIX shared memory");
+#else
+    int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open shared memory " + segmentName);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(shared_frames::Header)) {
+        close(fd);
+        throw std::runtime_error("shared memory " + segmentName + " is too small");
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("cannot map shared memory " + segmentName);
+    }
+
+    // Each field is read once; the ring size is checked by division so
+    // large counts cannot overflow it
+    auto* header = static_cast<shared_frames::Header*>(mapping);
+    uint32_t magic = header->magic;
+    uint32_t version = header->version;
+    uint32_t lightCount = header->lightCount;
+    uint32_t slotCount = header->slotCount;
+    size_t stride = shared_frames::SlotStride(lightCount);
+    if (magic != shared_frames::kMagic || version != shared_frames::kVersion ||
+        lightCount == 0 || slotCount == 0 ||
+        slotCount > (bytes - sizeof(shared_frames::Header)) / stride) {
+        munmap(mapping, bytes);
+        throw std::runtime_error("shared memory " + segmentName + " is not a frame ring");
+    }
+
+    Detach();
+    header_ = header;
+    mappedBytes_ = bytes;
+    slotCount_ = slotCount;
+    stride_ = stride;
+    size_t count = std::min<size_t>(lightIds.size(), lightCount);
+    ids_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        ids_.push_back(std::to_string(lightIds[i]));
+    }
+    slotCache_.Clear();
+    ResolveLuts();
+    scratch_.assign(lightCount * shared_frames::kChannels, 0.0f);
+    current_ = scratch_;
+    lastFrame_ = 0;
+    haveFrame_ = false;
+    attached_.store(true, std::memory_order_relaxed);
+#endif
+}
+
+void SharedFrameEffect::Detach() {
+#ifndef _WIN32
+    if (header_) {
+        munmap(header_, mappedBytes_);
+    }
+#endif
+    header_ = nullptr;
+    mappedBytes_ = 0;
+    slotCount_ = 0;
+    stride_ = 0;
+    haveFrame_ = false;
+    attached_.store(false, std::memory_order_relaxed);
+}
+
+void SharedFrameEffect::ReadCounters(Counters& out) const {
+    out.frames = frames_.load(std::memory_order_relaxed);
+    out.gaps = gaps_.load(std::memory_order_relaxed);
+    out.lostFrames = lostFrames_.load(std::memory_order_relaxed);
+    out.tornReads = tornReads_.load(std::memory_order_relaxed);
+    out.staleTicks = staleTicks_.load(std::memory_order_relaxed);
+}
+
+bool SharedFrameEffect::ReadFrame(uint64_t latest) {
+    shared_frames::SlotHeader* slot = shared_frames::Slot(header_, latest, slotCount_, stride_);
+    uint64_t before = slot->sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    std::memcpy(scratch_.data(), shared_frames::SlotColors(slot), scratch_.size() * sizeof(float));
+    uint64_t frame = slot->frame.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == before && frame == latest;
+}
+
+void SharedFrameEffect::Render() {
+    if (!header_) {
+        return;
+    }
+    uint64_t latest = header_->latest.load(std::memory_order_acquire);
+    if (latest == 0 || latest == lastFrame_) {
+        staleTicks_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // A torn read means the producer lapped the ring during the copy; the
+    // newest frame is then in another slot, so one retry normally succeeds
+    bool read = ReadFrame(latest);
+    if (!read) {
+        tornReads_.fetch_add(1, std::memory_order_relaxed);
+        latest = header_->latest.load(std::memory_order_acquire);
+        read = ReadFrame(latest);
+        if (!read) {
+            tornReads_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // A lower number means the producer restarted; start counting afresh
+    if (lastFrame_ != 0 && latest > lastFrame_ + 1) {
+        gaps_.fetch_add(1, std::memory_order_relaxed);
+        lostFrames_.fetch_add(latest - lastFrame_ - 1, std::memory_order_relaxed);
+    }
+    lastFrame_ = latest;
+    current_.swap(scratch_);
+    haveFrame_ = true;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+}
+
+Color SharedFrameEffect::GetColor(LightPtr light) {
+    int slot = haveFrame_ ? slotCache_.Find(light, ids_) : -1;
+    if (slot < 0) {
+        return Color(0, 0, 0, 0);
+    }
+    const float* rgba = current_.data() + slot * shared_frames::kChannels;
+    return OutputCorrector::Apply(luts_[slot], Color(UnitChannel(rgba[0], 255.0),
+                                                     UnitChannel(rgba[1], 255.0),
+                                                     UnitChannel(rgba[2], 255.0),
+                                                     UnitChannel(rgba[3], 1.0)));
+}
+
+std::string SharedFrameEffect::GetTypeName() const {
+    return "hue_edk.SharedFrameEffect";
+}
+
+void SharedFrameEffect::SetCorrector(std::shared_ptr<const OutputCorrector> corrector) {
+    corrector_ = std::move(corrector);
+    ResolveLuts();
+}
+
+void SharedFrameEffect::ResolveLuts() {
+    luts_.assign(ids_.size(), nullptr);
+    if (corrector_) {
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            luts_[i] = corrector_->ForId(ids_[i]);
+        }
+    }
+}
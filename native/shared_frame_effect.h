@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "huestream/common/data/Color.h"
+#include "huestream/common/data/Light.h"
+#include "huestream/effect/effects/base/Effect.h"
+
+#include "light_table.h"
+#include "output_lut.h"
+#include "shared_frames.h"
+
+// Mixer layer fed straight from a shared-memory frame ring (see
+// shared_frames.h). Render() copies the newest complete frame out of the
+// segment, so an external producer reaches the bridge without JS. Frame
+// light i drives lightIds[i]; lights the segment does not cover, and all
+// lights before the first frame, are transparent.
+//
+// Attach() and Detach() require the mixer lock; the counters can be read
+// from any thread.
+class SharedFrameEffect : public huestream::Effect {
+public:
+    SharedFrameEffect(const std::string& name, unsigned int layer);
+    ~SharedFrameEffect() override;
+
+    // Maps the segment read-only. Throws std::runtime_error if it cannot be
+    // opened or is not a valid ring.
+    void Attach(const std::string& segmentName, const std::vector<int>& lightIds);
+    void Detach();
+    bool IsAttached() const { return attached_.load(std::memory_order_relaxed); }
+    // Output correction for the attached lights, or nullptr for none
+    void SetCorrector(std::shared_ptr<const OutputCorrector> corrector);
+
+    struct Counters {
+        uint64_t frames = 0;      // frames taken from the segment
+        uint64_t gaps = 0;        // times one or more frames were passed over
+        uint64_t lostFrames = 0;  // frames written but never taken
+        uint64_t tornReads = 0;   // reads the producer overwrote mid-copy
+        uint64_t staleTicks = 0;  // render ticks with no new frame
+    };
+    void ReadCounters(Counters& out) const;
+
+    void Render() override;
+    huestream::Color GetColor(huestream::LightPtr light) override;
+    std::string GetTypeName() const override;
+
+private:
+    // Copies the newest frame into scratch_; false if it was torn
+    bool ReadFrame(uint64_t latest);
+    void ResolveLuts();
+
+    shared_frames::Header* header_ = nullptr;
+    size_t mappedBytes_ = 0;
+    // Validated on Attach() and used instead of the header's fields, which
+    // the producer can still change
+    uint32_t slotCount_ = 0;
+    size_t stride_ = 0;
+    std::atomic<bool> attached_{false};
+
+    // Render thread state
+    uint64_t lastFrame_ = 0;
+    bool haveFrame_ = false;
+    std::vector<float> scratch_;
+    std::vector<float> current_;
+    std::vector<std::string> ids_;
+    LightSlotCache slotCache_;
+    std::shared_ptr<const OutputCorrector> corrector_;
+    std::vector<const OutputLut*> luts_;  // per frame light, owned by corrector_
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> gaps_{0};
+    std::atomic<uint64_t> lostFrames_{0};
+    std::atomic<uint64_t> tornReads_{0};
+    std::atomic<uint64_t> staleTicks_{0};
+};
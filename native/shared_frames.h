@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Shared-memory frame ring fed by an external producer process. This header
+// has no dependencies so producers can include it as is.
+//
+// The segment (shm_open name, e.g. "/hue-audio") holds a Header followed by
+// slotCount slots of SlotStride(lightCount) bytes. A slot is a SlotHeader
+// followed by lightCount x { float r, g, b (0-255), alpha (0-1) }. Frame n
+// goes to slot n % slotCount and is guarded by that slot's seqlock counter,
+// odd while the slot is being written. There is one writer per segment;
+// readers never write to it.
+namespace shared_frames {
+
+const uint32_t kMagic = 0x31465348;  // "HSF1" in little-endian byte order
+const uint32_t kVersion = 1;
+const size_t kChannels = 4;
+
+// Shared between processes, so they must not fall back to a lock
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+static_assert(std::atomic<int64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+
+struct alignas(64) Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t lightCount;
+    uint32_t slotCount;
+    std::atomic<uint64_t> latest;  // newest complete frame, 0 before the first
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> frame;   // number of the frame in the slot
+    std::atomic<int64_t> timeNs;   // producer's CLOCK_MONOTONIC timestamp
+};
+
+inline size_t SlotStride(uint32_t lightCount) {
+    size_t bytes = sizeof(SlotHeader) + lightCount * kChannels * sizeof(float);
+    return (bytes + 63) / 64 * 64;
+}
+
+inline size_t SegmentSize(uint32_t lightCount, uint32_t slotCount) {
+    return sizeof(Header) + slotCount * SlotStride(lightCount);
+}
+
+// Readers pass the slotCount and stride they validated on attach: the
+// header stays writable by the producer, so it is not trusted after that
+inline SlotHeader* Slot(Header* header, uint64_t frame, uint32_t slotCount, size_t stride) {
+    char* base = reinterpret_cast<char*>(header) + sizeof(Header);
+    return reinterpret_cast<SlotHeader*>(base + (frame % slotCount) * stride);
+}
+
+inline SlotHeader* Slot(Header* header, uint64_t frame) {
+    return Slot(header, frame, header->slotCount, SlotStride(header->lightCount));
+}
+
+inline float* SlotColors(SlotHeader* slot) {
+    return reinterpret_cast<float*>(slot + 1);
+}
+
+// Producer: formats a zeroed segment of SegmentSize() bytes
+inline void Format(Header* header, uint32_t lightCount, uint32_t slotCount) {
+    header->lightCount = lightCount;
+    header->slotCount = slotCount;
+    header->version = kVersion;
+    header->latest.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kMagic;
+}
+
+// Producer: publishes lightCount x kChannels floats as the next frame
+inline uint64_t Write(Header* header, const float* rgba, int64_t timeNs) {
+    uint64_t frame = header->latest.load(std::memory_order_relaxed) + 1;
+    SlotHeader* slot = Slot(header, frame);
+    uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->frame.store(frame, std::memory_order_relaxed);
+    slot->timeNs.store(timeNs, std::memory_order_relaxed);
+    std::memcpy(SlotColors(slot), rgba, header->lightCount * kChannels * sizeof(float));
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    header->latest.store(frame, std::memory_order_release);
+    return frame;
+}
+
+}  // namespace shared_frames
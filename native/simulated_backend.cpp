@@ -0,0 +1,223 @@
+#include "simulated_backend.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "huestream/common/data/BridgeSettings.h"
+#include "huestream/common/data/Light.h"
+
+using namespace huestream;
+
+SimulatedBackend::SimulatedBackend(bool externalRender, const BackendOptions& options)
+    : externalRender_(externalRender),
+      lightCount_(std::max<size_t>(options.lights, 1)),
+      handshake_(std::max(options.handshakeMs, 0)),
+      discovery_(std::max(options.discoveryMs, 0)),
+      streaming_(false),
+      rendering_(false),
+      recorder_(options.captureFrames) {
+}
+
+SimulatedBackend::~SimulatedBackend() {
+    StopRenderThread();
+}
+
+// Lights "1".."N" spread left to right across the room
+GroupPtr SimulatedBackend::BuildGroup(const std::string& groupId) const {
+    auto lights = std::make_shared<LightList>();
+    for (size_t i = 0; i < lightCount_; ++i) {
+        double x = lightCount_ > 1 ? -1.0 + 2.0 * i / (lightCount_ - 1) : 0.0;
+        lights->push_back(std::make_shared<Light>(std::to_string(i + 1), Location(x, 0.0)));
+    }
+    auto group = std::make_shared<Group>();
+    group->SetId(groupId);
+    group->SetLights(lights);
+    return group;
+}
+
+void SimulatedBackend::SetBridge(const BridgeCredentials& credentials) {
+    auto bridge = std::make_shared<Bridge>(credentials.id, credentials.ip, true,
+                                           std::make_shared<BridgeSettings>());
+    bridge->SetUser(credentials.username);
+    bridge->SetClientKey(credentials.clientKey);
+
+    {
+        std::lock_guard<std::mutex> lock(mixer_);
+        bridge_ = bridge;
+    }
+    Notify(BackendEvent::BridgeConnected);
+}
+
+bool SimulatedBackend::Connect(const BridgeCredentials& credentials) {
+    // Bridge configuration
+    std::this_thread::sleep_for(discovery_);
+    SetBridge(credentials);
+    return true;
+}
+
+void SimulatedBackend::SelectGroup(const std::string& groupId) {
+    // Group lookup, then activation and handshake
+    std::this_thread::sleep_for(discovery_ + handshake_);
+    Activate(BuildGroup(groupId));
+}
+
+// Streams to the cached group as is, until FetchGroup() says otherwise
+bool SimulatedBackend::Resume(const BridgeCredentials& credentials, const WarmStartState& state) {
+    std::this_thread::sleep_for(handshake_);
+    SetBridge(credentials);
+    Activate(BuildWarmStartGroup(state));
+    return true;
+}
+
+GroupPtr SimulatedBackend::FetchGroup(const std::string& groupId) {
+    std::this_thread::sleep_for(discovery_);
+    if (!ActiveBridge()) {
+        return nullptr;
+    }
+    GroupPtr current = ActiveGroup();
+    GroupPtr fresh = BuildGroup(groupId);
+    if (!current || !SameTopology(CaptureWarmStart(nullptr, current), CaptureWarmStart(nullptr, fresh))) {
+        Activate(fresh);
+        return fresh;
+    }
+    return current;
+}
+
+void SimulatedBackend::Activate(const GroupPtr& group) {
+    std::vector<std::string> lightIds;
+    for (const auto& light : *group->GetLights()) {
+        lightIds.push_back(light->GetId());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mixer_);
+        if (!bridge_) {
+            return;
+        }
+        group_ = group;
+        output_.assign(lightIds.size() * 3, 0.0f);
+        recorder_.Reset(lightIds);
+        for (auto& effect : effects_) {
+            effect->UpdateGroup(group_);
+        }
+    }
+
+    if (!streaming_.exchange(true)) {
+        Notify(BackendEvent::StreamingStarted);
+    }
+    if (!externalRender_ && !rendering_.exchange(true)) {
+        renderThread_ = std::thread(&SimulatedBackend::RunRenderThread, this);
+    }
+}
+
+BridgePtr SimulatedBackend::ActiveBridge() {
+    std::lock_guard<std::mutex> lock(mixer_);
+    return bridge_;
+}
+
+GroupPtr SimulatedBackend::ActiveGroup() {
+    std::lock_guard<std::mutex> lock(mixer_);
+    return group_;
+}
+
+// Caller holds the mixer lock, as with HueStream::AddEffect()
+void SimulatedBackend::AddEffect(const EffectPtr& effect) {
+    if (group_) {
+        effect->UpdateGroup(group_);
+    }
+    auto position = std::upper_bound(effects_.begin(), effects_.end(), effect,
+        [](const EffectPtr& a, const EffectPtr& b) { return a->GetLayer() < b->GetLayer(); });
+    effects_.insert(position, effect);
+}
+
+void SimulatedBackend::RenderFrame() {
+    std::lock_guard<std::mutex> lock(mixer_);
+    RenderLocked();
+}
+
+void SimulatedBackend::RenderLocked() {
+    if (!streaming_ || !group_) {
+        return;
+    }
+
+    for (auto& effect : effects_) {
+        if (effect->IsEnabled() && !effect->IsFinished()) {
+            effect->Render();
+        }
+    }
+
+    const LightList& lights = *group_->GetLights();
+    for (size_t i = 0; i < lights.size(); ++i) {
+        double r = 0.0, g = 0.0, b = 0.0;
+        for (auto& effect : effects_) {
+            if (!effect->IsEnabled() || effect->IsFinished()) {
+                continue;
+            }
+            Color color = effect->GetColor(lights[i]);
+            double alpha = color.GetAlpha();
+            r = r * (1.0 - alpha) + color.GetR() * alpha;
+            g = g * (1.0 - alpha) + color.GetG() * alpha;
+            b = b * (1.0 - alpha) + color.GetB() * alpha;
+        }
+        // Left on the light like the EDK mixer does, for output capture
+        lights[i]->SetColor(Color(r, g, b));
+        output_[i * 3] = static_cast<float>(r);
+        output_[i * 3 + 1] = static_cast<float>(g);
+        output_[i * 3 + 2] = static_cast<float>(b);
+    }
+
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    recorder_.Record(now, output_.data());
+}
+
+// Stands in for the EDK render thread: 60 Hz on absolute deadlines
+void SimulatedBackend::RunRenderThread() {
+    const auto period = std::chrono::microseconds(1000000 / 60);
+    auto deadline = std::chrono::steady_clock::now();
+    while (rendering_.load(std::memory_order_relaxed)) {
+        RenderFrame();
+        deadline += period;
+        auto now = std::chrono::steady_clock::now();
+        if (now > deadline + period) {
+            deadline = now;
+            continue;
+        }
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+void SimulatedBackend::StopRenderThread() {
+    if (rendering_.exchange(false) && renderThread_.joinable()) {
+        renderThread_.join();
+    }
+}
+
+void SimulatedBackend::Stop() {
+    bool wasStreaming = streaming_.exchange(false);
+    StopRenderThread();
+    if (wasStreaming) {
+        Notify(BackendEvent::StreamingStopped);
+    }
+}
+
+void SimulatedBackend::ShutDown() {
+    Stop();
+    bool wasConnected;
+    {
+        std::lock_guard<std::mutex> lock(mixer_);
+        effects_.clear();
+        group_.reset();
+        wasConnected = bridge_ != nullptr;
+        bridge_.reset();
+    }
+    if (wasConnected) {
+        Notify(BackendEvent::BridgeDisconnected);
+    }
+}
+
+void SimulatedBackend::Notify(BackendEvent event) {
+    if (eventCallback_) {
+        eventCallback_(event);
+    }
+}
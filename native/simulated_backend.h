@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "frame_recorder.h"
+#include "stream_backend.h"
+
+// In-process stand-in for a bridge: accepts any credentials, builds a group
+// of evenly spaced lights for any group id and mixes the effect layers the
+// way the EDK does (ascending layer order, alpha over). Every rendered frame
+// goes to a FrameRecorder instead of the network, which makes latency and
+// throughput measurable without hardware. Optional delays stand in for the
+// bridge's configuration requests and the DTLS handshake.
+class SimulatedBackend : public StreamBackend {
+public:
+    SimulatedBackend(bool externalRender, const BackendOptions& options);
+    ~SimulatedBackend() override;
+
+    void SetEventCallback(BackendEventCallback callback) override { eventCallback_ = std::move(callback); }
+    bool Connect(const BridgeCredentials& credentials) override;
+    void SelectGroup(const std::string& groupId) override;
+    bool Resume(const BridgeCredentials& credentials, const WarmStartState& state) override;
+    huestream::GroupPtr FetchGroup(const std::string& groupId) override;
+    bool IsStreaming() override { return streaming_.load(); }
+    huestream::BridgePtr ActiveBridge() override;
+    huestream::GroupPtr ActiveGroup() override;
+    const char* Mode() const override { return "simulated"; }
+
+    void AddEffect(const huestream::EffectPtr& effect) override;
+    void LockMixer() override { mixer_.lock(); }
+    void UnlockMixer() override { mixer_.unlock(); }
+    void RenderFrame() override;
+
+    void Stop() override;
+    void ShutDown() override;
+
+    FrameRecorder* Recorder() override { return &recorder_; }
+
+private:
+    huestream::GroupPtr BuildGroup(const std::string& groupId) const;
+    void SetBridge(const BridgeCredentials& credentials);
+    // Makes group the streamed group and starts streaming
+    void Activate(const huestream::GroupPtr& group);
+    void RenderLocked();
+    void RunRenderThread();
+    void StopRenderThread();
+
+    // Events go out on the calling thread, outside the mixer lock
+    void Notify(BackendEvent event);
+
+    bool externalRender_;
+    size_t lightCount_;
+    std::chrono::milliseconds handshake_;
+    std::chrono::milliseconds discovery_;
+    BackendEventCallback eventCallback_;
+
+    std::mutex mixer_;  // guards everything below except the atomics
+    std::vector<huestream::EffectPtr> effects_;  // ascending layer order
+    huestream::BridgePtr bridge_;
+    huestream::GroupPtr group_;
+    std::vector<float> output_;
+
+    std::atomic<bool> streaming_;
+    std::atomic<bool> rendering_;
+    std::thread renderThread_;
+    FrameRecorder recorder_;
+};
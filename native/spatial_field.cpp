@@ -0,0 +1,153 @@
+#include "spatial_field.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double kTwoPi = 6.283185307179586;
+
+bool ParseFieldType(const std::string& name, FieldType& type) {
+    if (name == "radial") {
+        type = FieldType::Radial;
+    } else if (name == "sweep") {
+        type = FieldType::Sweep;
+    } else if (name == "falloff") {
+        type = FieldType::Falloff;
+    } else if (name == "burst") {
+        type = FieldType::Burst;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* FieldTypeName(FieldType type) {
+    switch (type) {
+        case FieldType::Sweep: return "sweep";
+        case FieldType::Falloff: return "falloff";
+        case FieldType::Burst: return "burst";
+        case FieldType::Radial:
+        default: return "radial";
+    }
+}
+
+// Distances from center into values, one pass per axis so the loops stay
+// over contiguous floats
+static void Distances(const FieldParams& params, const LightPositions& positions, float* values) {
+    size_t count = positions.Size();
+    for (size_t i = 0; i < count; ++i) {
+        float dx = positions.x[i] - params.center[0];
+        values[i] = dx * dx;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        float dy = positions.y[i] - params.center[1];
+        values[i] += dy * dy;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        float dz = positions.z[i] - params.center[2];
+        values[i] = std::sqrt(values[i] + dz * dz);
+    }
+}
+
+// Field values in 0-1 for every light
+static void FieldValues(const FieldParams& params, double timeMs, const LightPositions& positions,
+                        float* values) {
+    size_t count = positions.Size();
+    double seconds = timeMs / 1000.0;
+
+    switch (params.type) {
+        case FieldType::Radial: {
+            Distances(params, positions, values);
+            double wavelength = std::max(params.wavelength, 1e-3);
+            double travelled = params.speed * seconds;
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = static_cast<float>(0.5 + 0.5 * std::cos(kTwoPi * (values[i] - travelled) / wavelength));
+            }
+            break;
+        }
+        case FieldType::Sweep: {
+            double length = std::sqrt(params.direction[0] * params.direction[0] +
+                                      params.direction[1] * params.direction[1] +
+                                      params.direction[2] * params.direction[2]);
+            if (length < 1e-6 || count == 0) {
+                std::fill(values, values + count, 0.0f);
+                break;
+            }
+            float dx = static_cast<float>(params.direction[0] / length);
+            float dy = static_cast<float>(params.direction[1] / length);
+            float dz = static_cast<float>(params.direction[2] / length);
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = positions.x[i] * dx + positions.y[i] * dy + positions.z[i] * dz;
+            }
+            // The band enters before the first light and leaves after the
+            // last, whatever the group's extent along direction
+            double width = std::max(params.width, 1e-3);
+            auto range = std::minmax_element(values, values + count);
+            double span = *range.second - *range.first + 2 * width;
+            double travelled = std::fmod(std::fabs(params.speed) * seconds, span);
+            double front = params.speed >= 0 ? *range.first - width + travelled : *range.second + width - travelled;
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = static_cast<float>(std::max(0.0, 1.0 - std::fabs(values[i] - front) / width));
+            }
+            break;
+        }
+        case FieldType::Falloff: {
+            Distances(params, positions, values);
+            double radius = std::max(params.radius, 1e-3);
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = static_cast<float>(std::max(0.0, 1.0 - values[i] / radius));
+            }
+            break;
+        }
+        case FieldType::Burst: {
+            Distances(params, positions, values);
+            double width = std::max(params.width, 1e-3);
+            double ring = params.speed * seconds;
+            double fade = 1.0;
+            if (params.duration > 0) {
+                fade = std::max(0.0, 1.0 - timeMs / params.duration);
+                fade *= fade;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = static_cast<float>(std::max(0.0, 1.0 - std::fabs(values[i] - ring) / width) * fade);
+            }
+            break;
+        }
+    }
+}
+
+void EvaluateField(const FieldParams& params, double timeMs, const LightPositions& positions, float* out) {
+    size_t count = positions.Size();
+    // Values go into the first count floats, then expand in place back to
+    // front, so a call allocates nothing
+    FieldValues(params, timeMs, positions, out);
+
+    static const Rgb kBlack = {0, 0, 0};
+    const std::vector<Rgb>& colors = params.colors;
+    const Rgb last = colors.empty() ? Rgb{255, 255, 255} : colors.back();
+    for (size_t i = count; i-- > 0;) {
+        float value = std::min(std::max(out[i], 0.0f), 1.0f);
+        float* rgba = out + i * 4;
+        if (params.transparent) {
+            rgba[0] = static_cast<float>(last.r / 255.0);
+            rgba[1] = static_cast<float>(last.g / 255.0);
+            rgba[2] = static_cast<float>(last.b / 255.0);
+            rgba[3] = value;
+            continue;
+        }
+
+        const Rgb* from = &kBlack;
+        const Rgb* to = &last;
+        double t = value;
+        if (colors.size() > 1) {
+            double position = value * (colors.size() - 1);
+            size_t index = std::min(static_cast<size_t>(position), colors.size() - 2);
+            from = &colors[index];
+            to = &colors[index + 1];
+            t = position - index;
+        }
+        rgba[0] = static_cast<float>((from->r + (to->r - from->r) * t) / 255.0);
+        rgba[1] = static_cast<float>((from->g + (to->g - from->g) * t) / 255.0);
+        rgba[2] = static_cast<float>((from->b + (to->b - from->b) * t) / 255.0);
+        rgba[3] = 1.0f;
+    }
+}
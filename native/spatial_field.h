@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "effect_engine.h"
+#include "light_table.h"
+
+// Shape of a spatial field
+enum class FieldType : uint8_t {
+    Radial = 0,   // rings moving out from center, repeating every wavelength
+    Sweep = 1,    // a band crossing the room along direction, then starting over
+    Falloff = 2,  // 1 at center, fading to 0 at radius
+    Burst = 3     // one ring expanding from center, fading out over duration
+};
+
+// "radial", "sweep", "falloff", "burst"
+bool ParseFieldType(const std::string& name, FieldType& type);
+const char* FieldTypeName(FieldType type);
+
+// A field is a value from 0 to 1 at every point of the entertainment area,
+// mapped to a color through colors: 0 is the first color, 1 the last, with
+// the ones between spread evenly. A single color fades up from black. With
+// transparent set, lights take the last color with the field value as alpha
+// instead, so the layers below show through.
+struct FieldParams {
+    FieldType type = FieldType::Radial;
+    std::vector<Rgb> colors;     // 0-255
+    float center[3] = {0, 0, 0};
+    float direction[3] = {1, 0, 0};  // sweep; need not be normalized
+    double speed = 1;            // area units per second
+    double wavelength = 1;       // radial
+    double width = 0.5;          // sweep band and burst ring half-width
+    double radius = 1;           // falloff
+    double duration = 0;         // burst fade-out in ms, 0 = no fade
+    bool transparent = false;
+};
+
+// Evaluates the field at timeMs for every position. out receives r, g, b
+// (0-1) and alpha per light, in slot order: 4 floats per position.
+void EvaluateField(const FieldParams& params, double timeMs, const LightPositions& positions, float* out);
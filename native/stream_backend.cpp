@@ -0,0 +1,12 @@
+#include "stream_backend.h"
+
+#include "edk_backend.h"
+#include "simulated_backend.h"
+
+std::unique_ptr<StreamBackend> CreateStreamBackend(const std::string& appName, const std::string& deviceName,
+                                                   bool externalRender, const BackendOptions& options) {
+    if (options.kind == BackendKind::Simulated) {
+        return std::make_unique<SimulatedBackend>(externalRender, options);
+    }
+    return std::make_unique<EdkBackend>(appName, deviceName, externalRender);
+}
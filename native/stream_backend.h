@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "huestream/common/data/Bridge.h"
+#include "huestream/common/data/Group.h"
+#include "huestream/effect/effects/base/Effect.h"
+
+#include "warm_start.h"
+
+class FrameRecorder;
+
+// Bridge connection details passed to connectManual()
+struct BridgeCredentials {
+    std::string id;
+    std::string ip;
+    std::string username;
+    std::string clientKey;
+};
+
+enum class BackendKind {
+    Edk,        // real bridge through the Hue EDK
+    Simulated,  // in-process bridge that records its output
+};
+
+struct BackendOptions {
+    BackendKind kind = BackendKind::Edk;
+    // Simulated backend only
+    size_t lights = 10;           // lights in every selected group
+    size_t captureFrames = 1024;  // frames kept by the recorder
+    // Stand-in latencies, so warm and cold starts differ as with a bridge
+    int handshakeMs = 0;          // group activation and DTLS handshake
+    int discoveryMs = 0;          // each bridge configuration or group request
+};
+
+// Connection changes a backend reports, from whichever thread notices them
+enum class BackendEvent : uint8_t {
+    BridgeConnected,
+    BridgeDisconnected,
+    StreamingStarted,
+    StreamingStopped,
+};
+using BackendEventCallback = std::function<void(BackendEvent)>;
+
+// What a StreamSession streams through: connection handshake, the effect
+// mixer and frame output. Connection calls block; mixer calls follow the
+// EDK rules (effects are added and mutated under LockMixer()).
+class StreamBackend {
+public:
+    virtual ~StreamBackend() = default;
+
+    // Set once before Connect(). Called from backend threads until
+    // ShutDown() returns; repeated or out-of-order events are possible.
+    virtual void SetEventCallback(BackendEventCallback callback) = 0;
+
+    virtual bool Connect(const BridgeCredentials& credentials) = 0;
+    virtual void SelectGroup(const std::string& groupId) = 0;
+    // Connects and starts streaming to the group in state without first
+    // asking the bridge for its configuration. False when the bridge refused;
+    // the caller then connects normally.
+    virtual bool Resume(const BridgeCredentials& credentials, const WarmStartState& state) = 0;
+    // The group as the bridge reports it now, made the active group if its
+    // lights changed; null when the bridge does not know it. Blocks.
+    virtual huestream::GroupPtr FetchGroup(const std::string& groupId) = 0;
+    virtual bool IsStreaming() = 0;
+    virtual huestream::BridgePtr ActiveBridge() = 0;
+    virtual huestream::GroupPtr ActiveGroup() = 0;
+    // Reported as getStatus().streamingMode
+    virtual const char* Mode() const = 0;
+
+    virtual void AddEffect(const huestream::EffectPtr& effect) = 0;
+    virtual void LockMixer() = 0;
+    virtual void UnlockMixer() = 0;
+    // Renders the mixer and sends one frame (external render only)
+    virtual void RenderFrame() = 0;
+
+    virtual void Stop() = 0;
+    virtual void ShutDown() = 0;
+
+    // Output frames, recorded only by the simulated backend
+    virtual FrameRecorder* Recorder() { return nullptr; }
+};
+
+// externalRender disables the backend's own 60 Hz render thread
+std::unique_ptr<StreamBackend> CreateStreamBackend(const std::string& appName, const std::string& deviceName,
+                                                   bool externalRender, const BackendOptions& options);
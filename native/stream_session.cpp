@@ -0,0 +1,631 @@
+#include "stream_session.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+using namespace huestream;
+
+// Mixer layers, bottom to top
+static const unsigned int kFrameLayer = 1;
+static const unsigned int kSharedInputLayer = 2;
+static const unsigned int kEngineLayer = 3;
+static const unsigned int kLayerStackLayer = 4;
+static const unsigned int kReplayLayer = 5;
+
+// Backend is asked directly at most this often while not streaming
+static const int64_t kStreamPollNs = 100000000;
+// A resumed stream that is not up by then continues as a cold start
+static const std::chrono::milliseconds kWarmStartTimeout(2000);
+
+const char* SessionEventName(SessionEvent event) {
+    switch (event) {
+        case SessionEvent::Connected: return "connected";
+        case SessionEvent::Disconnected: return "disconnected";
+        case SessionEvent::Streaming: return "streaming";
+        case SessionEvent::Lost: return "lost";
+        case SessionEvent::Reconnected: return "reconnected";
+        case SessionEvent::Stopped:
+        default: return "stopped";
+    }
+}
+
+StreamSession::StreamSession(const std::string& appName, const std::string& deviceName, bool externalRender,
+                             const BackendOptions& options)
+    : backend_(CreateStreamBackend(appName, deviceName, externalRender, options)),
+      groupId_("0") {
+    backend_->SetEventCallback([this](BackendEvent event) { OnBackendEvent(event); });
+}
+
+StreamSession::~StreamSession() {
+    if (backend_) {
+        // Nobody is listening any more, and the backend may report its
+        // shutdown after members it would call into are gone
+        backend_->SetEventCallback(nullptr);
+        if (streaming_) {
+            backend_->Stop();
+        }
+        backend_->ShutDown();
+        backend_.reset();
+    }
+}
+
+bool StreamSession::Connect(const BridgeCredentials& credentials) {
+    connectNs_ = StatsNowNs();
+    credentials_ = credentials;
+    {
+        std::lock_guard<std::mutex> lock(warmMutex_);
+        warmStart_ = WarmStartReport();
+    }
+    if (!warmStartPath_.empty() && ResumeWarmStart(credentials)) {
+        return true;
+    }
+
+    bool connected = backend_->Connect(credentials);
+    if (connected) {
+        OnBackendEvent(BackendEvent::BridgeConnected);
+    }
+    return connected;
+}
+
+bool StreamSession::ResumeWarmStart(const BridgeCredentials& credentials) {
+    WarmStartState cached;
+    if (!LoadWarmStart(warmStartPath_, cached) || cached.bridgeId != credentials.id ||
+        cached.ip != credentials.ip || cached.lights.empty()) {
+        return false;
+    }
+    if (!backend_->Resume(credentials, cached)) {
+        return false;
+    }
+    OnBackendEvent(BackendEvent::BridgeConnected);
+    groupId_ = cached.groupId;
+    warmState_ = std::move(cached);
+    {
+        std::lock_guard<std::mutex> lock(warmMutex_);
+        warmStart_.used = true;
+        warmStart_.coldStartMs = warmState_.coldStartMs;
+    }
+    // Still connected if the stream is slow to come up; the caller's group
+    // selection then starts it the usual way. The caller adds the layers.
+    WaitForStreaming(kWarmStartTimeout);
+    return true;
+}
+
+void StreamSession::FinishStartup() {
+    if (connectNs_ == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(warmMutex_);
+    warmStart_.startupMs = (StatsNowNs() - connectNs_) / 1e6;
+    connectNs_ = 0;
+    if (warmStart_.used) {
+        warmStart_.savedMs = std::max(0.0, warmStart_.coldStartMs - warmStart_.startupMs);
+        return;
+    }
+    if (warmStartPath_.empty()) {
+        return;
+    }
+    WarmStartState state = CaptureWarmStart(backend_->ActiveBridge(), backend_->ActiveGroup());
+    // Matched against the caller's credentials next time, not the EDK's spelling
+    state.bridgeId = credentials_.id;
+    state.ip = credentials_.ip;
+    state.coldStartMs = warmStart_.startupMs;
+    if (!state.lights.empty() && SaveWarmStart(warmStartPath_, state)) {
+        warmStart_.coldStartMs = state.coldStartMs;
+    }
+}
+
+WarmStartReport StreamSession::GetWarmStart() const {
+    std::lock_guard<std::mutex> lock(warmMutex_);
+    return warmStart_;
+}
+
+bool StreamSession::RevalidateWarmStart() {
+    WarmStartReport report = GetWarmStart();
+    if (!report.used || report.revalidated || !backend_) {
+        return false;
+    }
+    GroupPtr group = backend_->FetchGroup(groupId_);
+    if (!group) {
+        return false;
+    }
+    WarmStartState current = CaptureWarmStart(backend_->ActiveBridge(), group);
+    current.bridgeId = warmState_.bridgeId;
+    current.ip = warmState_.ip;
+    current.coldStartMs = warmState_.coldStartMs;
+    bool lightsChanged = !SameTopology(current, warmState_);
+    // A firmware update alone also refreshes the cache
+    bool changed = lightsChanged || current.apiVersion != warmState_.apiVersion ||
+                   current.swVersion != warmState_.swVersion;
+    if (changed) {
+        SaveWarmStart(warmStartPath_, current);
+        warmState_ = std::move(current);
+    }
+    std::lock_guard<std::mutex> lock(warmMutex_);
+    warmStart_.revalidated = true;
+    warmStart_.changed = warmStart_.changed || changed;
+    return lightsChanged;
+}
+
+void StreamSession::SelectGroup(const std::string& groupId) {
+    // Already streaming to it, as after a warm start
+    if (groupId == groupId_ && IsStreaming()) {
+        return;
+    }
+    groupId_ = groupId;
+    backend_->SelectGroup(groupId);
+}
+
+// Streaming auto-starts shortly after group selection; polls instead of
+// sleeping for a fixed time so callers continue as soon as it is up
+bool StreamSession::WaitForStreaming(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!backend_->IsStreaming()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    OnBackendEvent(BackendEvent::StreamingStarted);
+    return true;
+}
+
+bool StreamSession::StartStreaming() {
+    // With auto-start enabled, streaming should already be active after group selection
+    if (!backend_->IsStreaming()) {
+        // Group selection hasn't triggered auto-start yet
+        return false;
+    }
+    OnBackendEvent(BackendEvent::StreamingStarted);
+
+    // Create the manual color layer if not already created
+    if (!frameEffect_) {
+        frameEffect_ = std::make_shared<FrameEffect>("manual_effect", kFrameLayer, &stats_);
+        frameEffect_->Resize(lightTable_);
+
+        // Named layers go above the native effect
+        layerStack_ = std::make_shared<LayerStack>("layer_stack", kLayerStackLayer);
+        layerStack_->Resize(lightTable_);
+        ApplyCorrector();
+
+        // Add effects to mixer
+        LockMixer();
+        backend_->AddEffect(frameEffect_);
+        backend_->AddEffect(layerStack_);
+        frameEffect_->Enable();
+        layerStack_->Enable();
+        UnlockMixer();
+    } else {
+        // Effects already exist, just enable them
+        LockMixer();
+        frameEffect_->Enable();
+        layerStack_->Enable();
+        UnlockMixer();
+    }
+
+    FinishStartup();
+    return true;
+}
+
+// The render thread reads the table for captures, so it is rebuilt in the
+// same lock as the layers that follow it
+void StreamSession::SyncLightTable() {
+    GroupPtr group = backend_->ActiveGroup();
+    LockMixer();
+    bool changed = lightTable_.Sync(group);
+    if (changed && frameEffect_) {
+        frameEffect_->Resize(lightTable_);
+        layerStack_->Resize(lightTable_);
+    }
+    UnlockMixer();
+    if (changed && frameEffect_) {
+        ApplyCorrector();
+    }
+}
+
+void StreamSession::Halt() {
+    // Disable the effects but keep them in the mixer
+    if (frameEffect_) {
+        LockMixer();
+        if (engineEffect_) {
+            engineEffect_->Halt();
+        }
+        if (sharedInput_) {
+            sharedInput_->Detach();
+        }
+        if (replay_) {
+            replay_->Stop();
+        }
+        frameEffect_->Disable();
+        layerStack_->Disable();
+        UnlockMixer();
+    }
+}
+
+void StreamSession::ShutDown() {
+    Halt();
+    CaptureWriter::Summary summary;
+    StopCapture(summary);
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    if (backend_->IsStreaming()) {
+        backend_->Stop();
+    }
+    backend_->ShutDown();
+    // Whether or not the backend reported them
+    OnBackendEvent(BackendEvent::StreamingStopped);
+    OnBackendEvent(BackendEvent::BridgeDisconnected);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = false;
+        lost_ = false;
+    }
+
+    engineReady_ = false;
+    engineEffect_.reset();
+    sharedReady_ = false;
+    sharedInput_.reset();
+    replayReady_ = false;
+    replay_.reset();
+    layerStack_.reset();
+    frameEffect_.reset();
+    corrector_.reset();
+    lightTable_.Clear();
+    backend_->SetEventCallback(nullptr);
+    backend_.reset();
+}
+
+void StreamSession::SetStateListener(std::function<void(SessionEvent)> listener) {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    stateListener_ = std::move(listener);
+}
+
+bool StreamSession::PollStreaming(int64_t nowNs) {
+    if (IsStreaming()) {
+        return true;
+    }
+    if (!backend_ || nowNs - lastPollNs_ < kStreamPollNs) {
+        return false;
+    }
+    lastPollNs_ = nowNs;
+    if (!backend_->IsStreaming()) {
+        return false;
+    }
+    OnBackendEvent(BackendEvent::StreamingStarted);
+    return true;
+}
+
+void StreamSession::OnBackendEvent(BackendEvent event) {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    switch (event) {
+        case BackendEvent::BridgeConnected:
+            if (!connected_.exchange(true, std::memory_order_acq_rel) && stateListener_) {
+                stateListener_(SessionEvent::Connected);
+            }
+            break;
+        case BackendEvent::BridgeDisconnected:
+            StreamingEnded();
+            if (connected_.exchange(false, std::memory_order_acq_rel) && stateListener_) {
+                stateListener_(SessionEvent::Disconnected);
+            }
+            break;
+        case BackendEvent::StreamingStarted:
+            if (!streaming_.exchange(true, std::memory_order_acq_rel)) {
+                if (stateListener_) {
+                    stateListener_(lost_ ? SessionEvent::Reconnected : SessionEvent::Streaming);
+                }
+                lost_ = false;
+            }
+            break;
+        case BackendEvent::StreamingStopped:
+            StreamingEnded();
+            break;
+    }
+}
+
+void StreamSession::StreamingEnded() {
+    if (!streaming_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    lost_ = !stopping_;
+    if (stateListener_) {
+        stateListener_(stopping_ ? SessionEvent::Stopped : SessionEvent::Lost);
+    }
+}
+
+BridgePtr StreamSession::ActiveBridge() const {
+    return backend_ ? backend_->ActiveBridge() : nullptr;
+}
+
+// The mixer lock is only taken when the layer has to be re-enabled after stop()
+void StreamSession::PublishFrame() {
+    if (frameEffect_->Publish()) {
+        MarkActivity(frameEffect_->PublishedTransitionMs());
+    }
+    if (!frameEffect_->IsEnabled()) {
+        LockMixer();
+        frameEffect_->Enable();
+        UnlockMixer();
+    }
+}
+
+void StreamSession::PublishLayer(FrameEffect& layer) {
+    if (layer.Publish()) {
+        MarkActivity(layer.PublishedTransitionMs());
+    }
+    if (!layerStack_->IsEnabled()) {
+        LockMixer();
+        layerStack_->Enable();
+        UnlockMixer();
+    }
+}
+
+void StreamSession::RunEffect(std::unique_ptr<NativeEffect> effect, const std::vector<int>& lightIds,
+                              double startMs) {
+    LockMixer();
+    if (!engineEffect_) {
+        // Above the manual layer so the running effect owns its lights
+        engineEffect_ = std::make_shared<EngineEffect>("native_effect", kEngineLayer, frameEffect_, &stats_);
+        engineEffect_->SetCorrector(corrector_);
+        backend_->AddEffect(engineEffect_);
+        engineReady_.store(true, std::memory_order_release);
+    }
+    frameEffect_->Enable();
+    engineEffect_->Run(std::move(effect), lightIds, startMs);
+    UnlockMixer();
+}
+
+void StreamSession::AttachSharedInput(const std::string& segmentName, const std::vector<int>& lightIds) {
+    LockMixer();
+    try {
+        if (!sharedInput_) {
+            sharedInput_ = std::make_shared<SharedFrameEffect>("shared_input", kSharedInputLayer);
+            sharedInput_->SetCorrector(corrector_);
+            backend_->AddEffect(sharedInput_);
+            sharedReady_.store(true, std::memory_order_release);
+        }
+        sharedInput_->Attach(segmentName, lightIds);
+        sharedInput_->Enable();
+    } catch (...) {
+        UnlockMixer();
+        throw;
+    }
+    UnlockMixer();
+}
+
+void StreamSession::DetachSharedInput() {
+    if (!sharedInput_) {
+        return;
+    }
+    LockMixer();
+    sharedInput_->Detach();
+    sharedInput_->Disable();
+    UnlockMixer();
+}
+
+void StreamSession::LockMixer() {
+    int64_t requested = StatsNowNs();
+    backend_->LockMixer();
+    lockedAtNs_ = StatsNowNs();
+    stats_.OnLockWait(static_cast<uint64_t>(lockedAtNs_ - requested));
+}
+
+void StreamSession::UnlockMixer() {
+    stats_.OnLockHold(static_cast<uint64_t>(StatsNowNs() - lockedAtNs_));
+    backend_->UnlockMixer();
+    // Layers are only changed under the mixer lock, so this covers effect
+    // starts, stops and parameter changes
+    MarkActivity();
+}
+
+void StreamSession::RenderFrame() {
+    int64_t start = StatsNowNs();
+    backend_->RenderFrame();
+    stats_.OnRenderFrame(static_cast<uint64_t>(StatsNowNs() - start));
+    if (capturing_.load(std::memory_order_acquire)) {
+        RecordCapture();
+    }
+}
+
+// The mixer leaves each light's final color on the group's lights. Taken
+// under the backend's own lock so it is not counted as layer activity.
+void StreamSession::RecordCapture() {
+    int64_t now = StatsNowNs();
+    backend_->LockMixer();
+    size_t count = lightTable_.Size();
+    captureRgb_.resize(count * 3);
+    for (size_t slot = 0; slot < count; ++slot) {
+        Color color = lightTable_.Light(slot)->GetColor();
+        captureRgb_[slot * 3] = static_cast<float>(color.GetR());
+        captureRgb_[slot * 3 + 1] = static_cast<float>(color.GetG());
+        captureRgb_[slot * 3 + 2] = static_cast<float>(color.GetB());
+    }
+    backend_->UnlockMixer();
+
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    if (capture_) {
+        capture_->Record(now, captureRgb_.data(), count);
+    }
+}
+
+void StreamSession::StartCapture(const std::string& path) {
+    std::vector<std::string> ids;
+    LockMixer();
+    for (size_t slot = 0; slot < lightTable_.Size(); ++slot) {
+        ids.push_back(lightTable_.Id(slot));
+    }
+    UnlockMixer();
+
+    auto writer = std::make_unique<CaptureWriter>(path, ids);
+    std::unique_ptr<CaptureWriter> previous;
+    {
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        previous = std::move(capture_);
+        capture_ = std::move(writer);
+    }
+    capturing_.store(true, std::memory_order_release);
+    if (previous) {
+        previous->Close();
+    }
+}
+
+bool StreamSession::StopCapture(CaptureWriter::Summary& summary) {
+    std::unique_ptr<CaptureWriter> writer;
+    {
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        capturing_.store(false, std::memory_order_release);
+        writer = std::move(capture_);
+    }
+    if (!writer) {
+        return false;
+    }
+    // Closed outside the lock: the final flush may wait for the disk
+    writer->Close();
+    summary = writer->GetSummary();
+    return true;
+}
+
+bool StreamSession::CaptureSummary(CaptureWriter::Summary& summary) {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    if (!capture_) {
+        return false;
+    }
+    summary = capture_->GetSummary();
+    return true;
+}
+
+void StreamSession::StartReplay(const std::string& path, bool loop) {
+    LockMixer();
+    try {
+        if (!replay_) {
+            replay_ = std::make_shared<ReplayEffect>("replay", kReplayLayer);
+            backend_->AddEffect(replay_);
+            replayReady_.store(true, std::memory_order_release);
+        }
+        replay_->Play(path, loop);
+        replay_->Enable();
+    } catch (...) {
+        UnlockMixer();
+        throw;
+    }
+    UnlockMixer();
+}
+
+bool StreamSession::StopReplay() {
+    if (!replay_ || !replay_->IsActive()) {
+        return false;
+    }
+    LockMixer();
+    replay_->Stop();
+    UnlockMixer();
+    return true;
+}
+
+void StreamSession::SetOutputCorrection(const OutputCorrection& correction) {
+    correction_ = correction;
+    if (frameEffect_) {
+        ApplyCorrector();
+    }
+}
+
+void StreamSession::ApplyCorrector() {
+    // Built outside the lock: a new gamut or gamma samples a whole table
+    corrector_ = correction_.enabled ? std::make_shared<OutputCorrector>(lightTable_, correction_) : nullptr;
+    LockMixer();
+    frameEffect_->SetCorrector(corrector_);
+    layerStack_->SetCorrector(corrector_);
+    if (engineEffect_) {
+        engineEffect_->SetCorrector(corrector_);
+    }
+    if (sharedInput_) {
+        sharedInput_->SetCorrector(corrector_);
+    }
+    UnlockMixer();
+}
+
+// idleAfterMs is capped well inside int64_t nanoseconds (about 31 years), so
+// huge values cannot overflow the cast; NaN counts as 0
+void StreamSession::SetRatePolicy(const RatePolicy& policy) {
+    const double kMaxIdleAfterMs = 1e12;
+    double idleAfterMs = policy.idleAfterMs > 0 ? std::min(policy.idleAfterMs, kMaxIdleAfterMs) : 0.0;
+    idleAfterNs_.store(static_cast<int64_t>(idleAfterMs * 1e6), std::memory_order_relaxed);
+    idlePeriodNs_.store(1000000000LL / std::max(policy.idleFps, 1), std::memory_order_relaxed);
+    adaptive_.store(policy.adaptive, std::memory_order_relaxed);
+    if (!policy.adaptive) {
+        MarkActivity();
+    }
+}
+
+RatePolicy StreamSession::GetRatePolicy() const {
+    RatePolicy policy;
+    policy.adaptive = adaptive_.load(std::memory_order_relaxed);
+    policy.idleAfterMs = idleAfterNs_.load(std::memory_order_relaxed) / 1e6;
+    policy.idleFps = static_cast<int>(1000000000LL / idlePeriodNs_.load(std::memory_order_relaxed));
+    return policy;
+}
+
+void StreamSession::SetWakeCallback(std::function<void()> wake) {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    wake_ = std::move(wake);
+}
+
+void StreamSession::MarkActivity(double transitionMs) {
+    int64_t now = StatsNowNs();
+    // The transition end goes first: RenderDue re-checks lastChangeNs_ only
+    if (transitionMs > 0) {
+        int64_t until = now + static_cast<int64_t>(transitionMs * 1e6);
+        int64_t current = fadingUntilNs_.load(std::memory_order_relaxed);
+        while (current < until &&
+               !fadingUntilNs_.compare_exchange_weak(current, until, std::memory_order_relaxed)) {
+        }
+    }
+    lastChangeNs_.store(now);
+    if (idle_.load()) {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (wake_) {
+            wake_();
+        }
+    }
+}
+
+bool StreamSession::RenderDue(int64_t nowNs, int64_t& nextNs) {
+    int64_t lastChange = lastChangeNs_.load();
+    bool active = !adaptive_.load(std::memory_order_relaxed) ||
+                  nowNs - lastChange < idleAfterNs_.load(std::memory_order_relaxed) ||
+                  nowNs < fadingUntilNs_.load(std::memory_order_relaxed) ||
+                  (engineReady_.load(std::memory_order_acquire) && engineEffect_->IsActive()) ||
+                  (sharedReady_.load(std::memory_order_acquire) && sharedInput_->IsAttached()) ||
+                  (replayReady_.load(std::memory_order_acquire) && replay_->IsActive());
+
+    if (!active && !idle_.exchange(true)) {
+        // MarkActivity only wakes an idle session, so a change that landed
+        // after lastChange was read but before idle_ was set renders now
+        if (lastChangeNs_.load() != lastChange) {
+            idle_.store(false);
+            active = true;
+        } else {
+            stats_.OnRateChange(true, nowNs);
+        }
+    }
+
+    if (active) {
+        if (idle_.exchange(false) || lastRenderNs_ == 0) {
+            stats_.OnRateChange(false, nowNs);
+        }
+        lastRenderNs_ = nowNs;
+        nextNs = 0;
+        return true;
+    }
+
+    int64_t due = lastRenderNs_ + idlePeriodNs_.load(std::memory_order_relaxed);
+    if (nowNs >= due) {
+        lastRenderNs_ = nowNs;
+        nextNs = nowNs + idlePeriodNs_.load(std::memory_order_relaxed);
+        return true;
+    }
+    nextNs = due;
+    return false;
+}
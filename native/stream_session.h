@@ -0,0 +1,254 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "capture_file.h"
+#include "effect_engine.h"
+#include "frame_effect.h"
+#include "layer_stack.h"
+#include "replay_effect.h"
+#include "shared_frame_effect.h"
+#include "frame_recorder.h"
+#include "light_table.h"
+#include "output_lut.h"
+#include "stream_backend.h"
+#include "stream_stats.h"
+
+// Adaptive stream rate: once no light has changed for idleAfterMs (and no
+// native effect runs) the session renders only idleFps keep-alive frames,
+// until the next change renders immediately at full rate again
+struct RatePolicy {
+    bool adaptive = false;
+    double idleAfterMs = 1000;
+    int idleFps = 2;
+};
+
+// Connection and stream state changes of a session, in the order they happen
+enum class SessionEvent : uint8_t {
+    Connected,     // bridge handshake done
+    Disconnected,  // bridge connection ended
+    Streaming,     // stream up for the first time
+    Lost,          // stream dropped without being stopped
+    Reconnected,   // stream up again after Lost
+    Stopped,       // stream ended by ShutDown()
+};
+const char* SessionEventName(SessionEvent event);
+
+// How the last Connect() went with a warm start cache set
+struct WarmStartReport {
+    bool used = false;         // resumed from the cache instead of a cold start
+    double startupMs = 0;      // Connect() to streaming; 0 until streaming
+    double coldStartMs = 0;    // the same on the cold start that wrote the cache
+    double savedMs = 0;        // coldStartMs - startupMs after a warm start
+    bool revalidated = false;  // the bridge was asked whether the cache still holds
+    bool changed = false;      // ... and the cache had to be rewritten
+};
+
+// One stream to a bridge's entertainment group, plus the addon's mixer
+// layers on top of it. The stream itself goes through a StreamBackend: the
+// EDK, or the in-process simulated bridge. Both HueWrapper (one session) and
+// the session manager (several) disable the backend's render thread and
+// render from a RenderScheduler, which can skip ticks under a RatePolicy.
+//
+// Connection methods (Connect, SelectGroup, WaitForStreaming, revalidation)
+// block and may run on a worker thread; callers serialize them. Creating and
+// resizing layers (StartStreaming, SyncLightTable, ShutDown) stays on the
+// thread that runs the setters, so they never see a half-built frame layer.
+// The frame layer setters follow FrameEffect's producer rules.
+class StreamSession {
+public:
+    // externalRender disables the EDK render thread; RenderFrame() must then
+    // be called once per tick while streaming
+    StreamSession(const std::string& appName, const std::string& deviceName, bool externalRender,
+                  const BackendOptions& options = BackendOptions());
+    ~StreamSession();
+
+    // With a warm start cache for the same bridge, goes straight to
+    // streaming on the cached group; StartStreaming() then only adds the
+    // layers, and SelectGroup() for that group is a no-op. Otherwise a cold
+    // start, whose first StartStreaming() writes the cache.
+    bool Connect(const BridgeCredentials& credentials);
+    void SelectGroup(const std::string& groupId);
+    bool WaitForStreaming(std::chrono::milliseconds timeout);
+    // Adds the manual frame layer once the bridge is streaming
+    bool StartStreaming();
+    // Rebuilds the light table (and frame buffers) when the group changed
+    void SyncLightTable();
+    // Halts the native effect and disables the frame layer; streaming continues
+    void Halt();
+    void ShutDown();
+
+    // Opt-in warm start (see warm_start.h); empty disables. Same threading
+    // as Connect().
+    void SetWarmStartPath(const std::string& path) { warmStartPath_ = path; }
+    const std::string& WarmStartPath() const { return warmStartPath_; }
+    // A copy: revalidation fills in the report from another thread
+    WarmStartReport GetWarmStart() const;
+    bool WarmStarted() const { return GetWarmStart().used; }
+    // After a warm start, off the JS thread: asks the bridge for the group
+    // and rewrites the cache if it changed. True when the lights changed;
+    // SyncLightTable() then picks them up. Serialized with Connect() by the
+    // caller like the other connection steps.
+    bool RevalidateWarmStart();
+
+    // Cached from the backend's events and the session's own checks, so
+    // cheap enough for every setter call and render tick
+    bool IsConnected() const { return connected_.load(std::memory_order_acquire); }
+    bool IsStreaming() const { return streaming_.load(std::memory_order_acquire); }
+    // Called with every state change, in order, on whichever thread noticed
+    // it (never concurrently). Replacing or clearing it waits for a running
+    // call to return.
+    void SetStateListener(std::function<void(SessionEvent)> listener);
+    // Scheduler thread, while not streaming: asks the backend directly, at
+    // most every 100 ms, in case a restart was not reported
+    bool PollStreaming(int64_t nowNs);
+    bool HasFrameLayer() const { return frameEffect_ != nullptr; }
+    const std::string& GroupId() const { return groupId_; }
+    huestream::BridgePtr ActiveBridge() const;
+    const char* Mode() const { return backend_->Mode(); }
+
+    const LightTable& Lights() const { return lightTable_; }
+    FrameEffect& Frame() { return *frameEffect_; }
+    // Hands the staged frame to the renderer
+    void PublishFrame();
+
+    // Named blend layers, drawn above the native effect; created with the
+    // frame layer. Changing the set or options requires the mixer lock.
+    LayerStack* Layers() { return layerStack_.get(); }
+    // Hands a named layer's staged frame to the renderer
+    void PublishLayer(FrameEffect& layer);
+
+    // Shared-memory input layer, between the frame layer and the native
+    // effect. Throws std::runtime_error if the segment cannot be attached.
+    // While attached the session renders at full rate.
+    void AttachSharedInput(const std::string& segmentName, const std::vector<int>& lightIds);
+    void DetachSharedInput();
+    const SharedFrameEffect* SharedInput() const { return sharedInput_.get(); }
+
+    // Native effect layer, created on first use. Callers hold the mixer lock
+    // for every EngineEffect call except through RunEffect(). startMs starts
+    // playback that far in, in the same lock as the start.
+    void RunEffect(std::unique_ptr<NativeEffect> effect, const std::vector<int>& lightIds, double startMs = 0);
+    EngineEffect* Engine() { return engineEffect_.get(); }
+    // Timed: waits and holds go to Stats()
+    void LockMixer();
+    void UnlockMixer();
+
+    // Renders the mixer and sends the frame (externalRender sessions only)
+    void RenderFrame();
+
+    // Records every frame sent to a capture file (see capture_file.h), for
+    // the lights of the group at the start. Throws std::runtime_error if
+    // the file cannot be created. StopCapture() returns false if no capture
+    // ran; summary receives its totals.
+    void StartCapture(const std::string& path);
+    bool StopCapture(CaptureWriter::Summary& summary);
+    bool CaptureSummary(CaptureWriter::Summary& summary);
+
+    // Replay layer, on top of everything else; created on first use. Throws
+    // std::runtime_error if the file is not a capture. While it plays the
+    // session renders at full rate.
+    void StartReplay(const std::string& path, bool loop);
+    bool StopReplay();
+    const ReplayEffect* Replay() const { return replay_.get(); }
+
+    // Per-light gamut correction of the frame layer, named layers, shared
+    // input and native effect (see output_lut.h). JS thread; tables are
+    // built when the correction is enabled and when the group's lights
+    // change. Colors already shown keep their old correction until
+    // rewritten. Replays are left as captured.
+    void SetOutputCorrection(const OutputCorrection& correction);
+    const OutputCorrection& GetOutputCorrection() const { return correction_; }
+    // nullptr while correction is off or before the group is known
+    const OutputCorrector* Corrector() const { return corrector_.get(); }
+
+    // Any thread. Takes effect on the next tick.
+    void SetRatePolicy(const RatePolicy& policy);
+    RatePolicy GetRatePolicy() const;
+    // Set by the scheduler before streaming; called from any thread when
+    // an idle session changes so the change renders without waiting. Once
+    // this returns the previous callback is not running and is never called
+    // again, so its owner may go away.
+    void SetWakeCallback(std::function<void()> wake);
+    // Scheduler thread, once per tick: whether to render now. nextNs is when
+    // the session next needs a render, or 0 if it renders every tick.
+    bool RenderDue(int64_t nowNs, int64_t& nextNs);
+    const StreamStats& Stats() const { return stats_; }
+    // Output frames of the simulated backend, nullptr otherwise
+    FrameRecorder* Recorder() { return backend_ ? backend_->Recorder() : nullptr; }
+
+private:
+    std::unique_ptr<StreamBackend> backend_;
+    std::shared_ptr<FrameEffect> frameEffect_;
+    std::shared_ptr<EngineEffect> engineEffect_;
+    std::shared_ptr<LayerStack> layerStack_;
+    std::shared_ptr<SharedFrameEffect> sharedInput_;
+    std::shared_ptr<ReplayEffect> replay_;
+    LightTable lightTable_;
+    std::string groupId_;
+    StreamStats stats_;
+
+    // Streams to the cached group; false for a cold start
+    bool ResumeWarmStart(const BridgeCredentials& credentials);
+    // First StartStreaming() after Connect(): measures, and caches a cold start
+    void FinishStartup();
+    std::string warmStartPath_;
+    BridgeCredentials credentials_;
+    WarmStartState warmState_;  // what the warm start resumed from
+    WarmStartReport warmStart_;  // guarded by warmMutex_
+    mutable std::mutex warmMutex_;
+    int64_t connectNs_ = 0;     // 0 once streaming
+    int64_t lockedAtNs_ = 0;  // written only while holding the mixer lock
+
+    // Something visible changed; wakes the scheduler if the session idles.
+    // A change that fades in keeps the full rate for transitionMs.
+    void MarkActivity(double transitionMs = 0);
+
+    // Applies a reported or observed change to the cached state and tells
+    // the listener about real transitions
+    void OnBackendEvent(BackendEvent event);
+    void StreamingEnded();  // caller holds stateMutex_
+    std::atomic<bool> connected_{false};
+    std::atomic<bool> streaming_{false};
+    std::mutex stateMutex_;  // serializes transitions and the listener
+    bool lost_ = false;      // stream dropped; the next start is a reconnect
+    bool stopping_ = false;  // inside ShutDown(): stream ends are not losses
+    std::function<void(SessionEvent)> stateListener_;
+    int64_t lastPollNs_ = 0;  // scheduler thread only
+
+    // Rebuilds corrector_ for the current lights and hands it to the layers
+    void ApplyCorrector();
+    OutputCorrection correction_;
+    std::shared_ptr<const OutputCorrector> corrector_;
+
+    // engineEffect_ is created once; the flag publishes it to the scheduler
+    std::atomic<bool> engineReady_{false};
+    std::atomic<bool> sharedReady_{false};
+    std::atomic<bool> replayReady_{false};
+
+    // Reads the mixed light colors into captureRgb_ and records them
+    void RecordCapture();
+    std::mutex captureMutex_;  // guards capture_; taken by the render thread only while capturing
+    std::unique_ptr<CaptureWriter> capture_;
+    std::atomic<bool> capturing_{false};
+    std::vector<float> captureRgb_;  // render thread only
+    std::atomic<bool> adaptive_{false};
+    std::atomic<int64_t> idleAfterNs_{1000000000};
+    std::atomic<int64_t> idlePeriodNs_{500000000};
+    // lastChangeNs_ and idle_ are sequentially consistent: MarkActivity
+    // stores the one and reads the other, RenderDue the other way round, so
+    // a change is either seen by RenderDue or wakes the scheduler
+    std::atomic<int64_t> lastChangeNs_{0};
+    std::atomic<int64_t> fadingUntilNs_{0};  // end of the last transition
+    std::atomic<bool> idle_{false};
+    int64_t lastRenderNs_ = 0;  // scheduler thread only
+    std::mutex wakeMutex_;
+    std::function<void()> wake_;  // guarded by wakeMutex_
+};
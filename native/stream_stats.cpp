@@ -0,0 +1,130 @@
+#include "stream_stats.h"
+
+#include <cmath>
+#include <limits>
+
+void Histogram::Record(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    size_t bucket = 0;
+    while (us != 0 && bucket < kBuckets - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    totalNs_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = maxNs_.load(std::memory_order_relaxed);
+    while (ns > max && !maxNs_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::Read(Snapshot& out) const {
+    out.count = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        out.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        out.count += out.buckets[i];
+    }
+    out.totalNs = totalNs_.load(std::memory_order_relaxed);
+    out.maxNs = maxNs_.load(std::memory_order_relaxed);
+}
+
+double Histogram::BucketLimitUs(size_t bucket) {
+    if (bucket >= kBuckets - 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return std::ldexp(1.0, static_cast<int>(bucket));
+}
+
+double Histogram::Snapshot::PercentileUs(double fraction) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(fraction * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= target && buckets[i] != 0) {
+            // The last bucket is open-ended; the maximum bounds it instead
+            return i == kBuckets - 1 ? maxNs / 1000.0 : BucketLimitUs(i);
+        }
+    }
+    return maxNs / 1000.0;
+}
+
+void StreamStats::OnFrameStart(int64_t nowNs) {
+    // Idle keep-alive frames are deliberately far apart and not timed
+    if (lastFrameNs_ != 0 && !idle_.load(std::memory_order_relaxed)) {
+        int64_t interval = nowNs - lastFrameNs_;
+        frameInterval_.Record(static_cast<uint64_t>(interval));
+        uint64_t intervalUs = static_cast<uint64_t>(interval / 1000);
+        frameIntervalSqUs_.fetch_add(intervalUs * intervalUs, std::memory_order_relaxed);
+        if (interval > kFramePeriodNs * 3 / 2) {
+            framesDropped_.fetch_add(static_cast<uint64_t>((interval + kFramePeriodNs / 2) / kFramePeriodNs - 1),
+                                     std::memory_order_relaxed);
+        }
+        if (!externalRender_) {
+            frameTime_.Record(layerNs_);
+        }
+    }
+    lastFrameNs_ = nowNs;
+    layerNs_ = 0;
+    framesSent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StreamStats::OnFrameAcquired(int64_t publishedAtNs, int64_t nowNs) {
+    framesAcquired_.fetch_add(1, std::memory_order_relaxed);
+    if (nowNs > publishedAtNs) {
+        setterToFrame_.Record(static_cast<uint64_t>(nowNs - publishedAtNs));
+    }
+}
+
+void StreamStats::OnRenderFrame(uint64_t ns) {
+    externalRender_ = true;
+    frameTime_.Record(ns);
+}
+
+void StreamStats::OnRateChange(bool idle, int64_t nowNs) {
+    int64_t since = rateSinceNs_.load(std::memory_order_relaxed);
+    if (since != 0) {
+        std::atomic<uint64_t>& total = idle_.load(std::memory_order_relaxed) ? idleRateNs_ : fullRateNs_;
+        total.fetch_add(static_cast<uint64_t>(nowNs - since), std::memory_order_relaxed);
+        rateSwitches_.fetch_add(1, std::memory_order_relaxed);
+    }
+    idle_.store(idle, std::memory_order_relaxed);
+    rateSinceNs_.store(nowNs, std::memory_order_relaxed);
+    // The gap before the first full-rate frame is not a dropped frame
+    lastFrameNs_ = 0;
+}
+
+void StreamStats::Read(Snapshot& out) const {
+    out.publishes = publishes_.load(std::memory_order_relaxed);
+    out.writesSkipped = writesSkipped_.load(std::memory_order_relaxed);
+    out.publishesSkipped = publishesSkipped_.load(std::memory_order_relaxed);
+    out.framesSent = framesSent_.load(std::memory_order_relaxed);
+    out.framesUnchanged = framesUnchanged_.load(std::memory_order_relaxed);
+    out.framesAcquired = framesAcquired_.load(std::memory_order_relaxed);
+    out.framesDropped = framesDropped_.load(std::memory_order_relaxed);
+    out.frameIntervalSqUs = frameIntervalSqUs_.load(std::memory_order_relaxed);
+    out.idle = idle_.load(std::memory_order_relaxed);
+    out.fullRateNs = fullRateNs_.load(std::memory_order_relaxed);
+    out.idleRateNs = idleRateNs_.load(std::memory_order_relaxed);
+    out.rateSwitches = rateSwitches_.load(std::memory_order_relaxed);
+    int64_t since = rateSinceNs_.load(std::memory_order_relaxed);
+    if (since != 0) {
+        (out.idle ? out.idleRateNs : out.fullRateNs) += static_cast<uint64_t>(StatsNowNs() - since);
+    }
+    lockWait_.Read(out.lockWait);
+    lockHold_.Read(out.lockHold);
+    frameTime_.Read(out.frameTime);
+    frameInterval_.Read(out.frameInterval);
+    setterToFrame_.Read(out.setterToFrame);
+}
+
+double StreamStats::Snapshot::FrameJitterUs() const {
+    if (frameInterval.count < 2) {
+        return 0.0;
+    }
+    double mean = frameInterval.MeanUs();
+    double variance = static_cast<double>(frameIntervalSqUs) / frameInterval.count - mean * mean;
+    return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
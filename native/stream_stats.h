@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free histogram of durations with fixed power-of-two buckets:
+// bucket 0 holds values below 1us, bucket i values in [2^(i-1), 2^i) us, and
+// the last bucket everything above. Record() is a handful of relaxed atomic
+// adds, so it is safe on the render thread; readers take a Snapshot.
+class Histogram {
+public:
+    static constexpr size_t kBuckets = 24;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        std::array<uint64_t, kBuckets> buckets{};
+
+        // Upper bound of the bucket holding the given fraction of samples
+        double PercentileUs(double fraction) const;
+        double MeanUs() const { return count ? totalNs / 1000.0 / count : 0.0; }
+    };
+
+    void Record(uint64_t ns);
+    void Read(Snapshot& out) const;
+
+    // Exclusive upper bound of bucket i in microseconds (infinite for the last)
+    static double BucketLimitUs(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> totalNs_{0};
+    std::atomic<uint64_t> maxNs_{0};
+};
+
+inline int64_t StatsNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Counters and histograms of one stream. Every field is written by exactly
+// one side (JS thread or render thread) with relaxed atomics; getStats()
+// reads them without locking, so polling it does not disturb the stream.
+class StreamStats {
+public:
+    // JS thread: a setter published a frame (skippedWrites of its light writes
+    // were dropped as unchanged), a publish had no change at all, or the
+    // mixer lock was taken
+    void OnPublish(uint64_t skippedWrites) {
+        publishes_.fetch_add(1, std::memory_order_relaxed);
+        if (skippedWrites) {
+            writesSkipped_.fetch_add(skippedWrites, std::memory_order_relaxed);
+        }
+    }
+    void OnPublishSkipped() { publishesSkipped_.fetch_add(1, std::memory_order_relaxed); }
+    void OnLockWait(uint64_t ns) { lockWait_.Record(ns); }
+    void OnLockHold(uint64_t ns) { lockHold_.Record(ns); }
+
+    // Render thread, once per frame before the addon's layers render. Frame
+    // intervals above 1.5 periods count the missed ticks as dropped.
+    void OnFrameStart(int64_t nowNs);
+    // Render thread: time spent in one of the addon's layers this frame
+    void OnLayerRender(uint64_t ns) { layerNs_ += ns; }
+    // Render thread: a published frame was picked up, publishedAtNs ago, or
+    // there was nothing new and the previous colors were kept
+    void OnFrameAcquired(int64_t publishedAtNs, int64_t nowNs);
+    void OnFrameUnchanged() { framesUnchanged_.fetch_add(1, std::memory_order_relaxed); }
+    // Whole-frame render time when the addon drives rendering itself; the
+    // layer times are then not used as the frame time
+    void OnRenderFrame(uint64_t ns);
+    // Render thread, externally rendered sessions: the adaptive rate switched
+    // between full and idle rate
+    void OnRateChange(bool idle, int64_t nowNs);
+
+    struct Snapshot {
+        uint64_t publishes = 0;
+        uint64_t writesSkipped = 0;
+        uint64_t publishesSkipped = 0;
+        uint64_t framesSent = 0;
+        uint64_t framesUnchanged = 0;
+        uint64_t framesAcquired = 0;
+        uint64_t framesDropped = 0;
+        uint64_t frameIntervalSqUs = 0;  // sum of squared intervals, for the jitter
+        bool idle = false;
+        uint64_t fullRateNs = 0;  // time at each rate, including the current stretch
+        uint64_t idleRateNs = 0;
+        uint64_t rateSwitches = 0;
+        Histogram::Snapshot lockWait;
+        Histogram::Snapshot lockHold;
+        Histogram::Snapshot frameTime;
+        Histogram::Snapshot frameInterval;
+        Histogram::Snapshot setterToFrame;
+
+        // Standard deviation of the frame interval
+        double FrameJitterUs() const;
+    };
+    void Read(Snapshot& out) const;
+
+    static constexpr int64_t kFramePeriodNs = 1000000000 / 60;
+
+private:
+    std::atomic<uint64_t> publishes_{0};
+    std::atomic<uint64_t> writesSkipped_{0};
+    std::atomic<uint64_t> publishesSkipped_{0};
+    std::atomic<uint64_t> framesSent_{0};
+    std::atomic<uint64_t> framesUnchanged_{0};
+    std::atomic<uint64_t> framesAcquired_{0};
+    std::atomic<uint64_t> framesDropped_{0};
+    std::atomic<uint64_t> frameIntervalSqUs_{0};
+    std::atomic<bool> idle_{false};
+    std::atomic<int64_t> rateSinceNs_{0};
+    std::atomic<uint64_t> fullRateNs_{0};
+    std::atomic<uint64_t> idleRateNs_{0};
+    std::atomic<uint64_t> rateSwitches_{0};
+    Histogram lockWait_;
+    Histogram lockHold_;
+    Histogram frameTime_;
+    Histogram frameInterval_;
+    Histogram setterToFrame_;
+
+    // Render thread only
+    int64_t lastFrameNs_ = 0;
+    uint64_t layerNs_ = 0;
+    bool externalRender_ = false;
+};
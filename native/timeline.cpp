@@ -0,0 +1,228 @@
+#include "timeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+// Little-endian reader over a blob; throws when the data runs out
+class BlobReader {
+public:
+    BlobReader(const uint8_t* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+    const uint8_t* Take(size_t count) {
+        if (size_ - pos_ < count) {
+            throw std::invalid_argument("timeline blob is truncated");
+        }
+        const uint8_t* bytes = data_ + pos_;
+        pos_ += count;
+        return bytes;
+    }
+
+    uint8_t U8() { return *Take(1); }
+
+    uint32_t U32() {
+        const uint8_t* b = Take(4);
+        return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+               (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+    }
+
+    double F64() {
+        const uint8_t* b = Take(8);
+        uint64_t bits = 0;
+        for (int i = 7; i >= 0; --i) {
+            bits = (bits << 8) | b[i];
+        }
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    size_t Remaining() const { return size_ - pos_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+const size_t kBlobKeyframeSize = 12;
+
+class TimelineEffect : public NativeEffect {
+public:
+    explicit TimelineEffect(std::shared_ptr<const Timeline> timeline)
+        : NativeEffect(EffectParams()),
+          timeline_(std::move(timeline)),
+          cursors_(timeline_->LightIds().size(), 0) {}
+
+    bool Render(double elapsedMs, Rgb* out, size_t count) override {
+        double duration = timeline_->Duration();
+        double t = elapsedMs;
+        bool finished = false;
+        if (timeline_->Loops()) {
+            t = std::fmod(t, duration);
+        } else if (t >= duration) {
+            t = duration;
+            finished = true;
+        }
+
+        size_t tracks = std::min(count, cursors_.size());
+        for (size_t i = 0; i < tracks; ++i) {
+            out[i] = timeline_->Evaluate(i, t, cursors_[i]);
+        }
+        return !finished && !Expired(elapsedMs);
+    }
+
+private:
+    std::shared_ptr<const Timeline> timeline_;
+    std::vector<size_t> cursors_;
+};
+
+}  // namespace
+
+bool ParseEasing(const std::string& name, Easing& easing) {
+    if (name == "linear") {
+        easing = Easing::Linear;
+    } else if (name == "step") {
+        easing = Easing::Step;
+    } else if (name == "easeIn") {
+        easing = Easing::EaseIn;
+    } else if (name == "easeOut") {
+        easing = Easing::EaseOut;
+    } else if (name == "easeInOut") {
+        easing = Easing::EaseInOut;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const Timeline> Timeline::Compile(std::vector<TimelineTrack> tracks, double durationMs, bool loop) {
+    std::shared_ptr<Timeline> timeline(new Timeline());
+
+    size_t total = 0;
+    for (const TimelineTrack& track : tracks) {
+        total += track.keyframes.size();
+    }
+    timeline->lightIds_.reserve(tracks.size());
+    timeline->offsets_.reserve(tracks.size() + 1);
+    timeline->times_.reserve(total);
+    timeline->colors_.reserve(total);
+    timeline->easings_.reserve(total);
+
+    std::set<int> seen;
+    double lastKeyframe = 0;
+    timeline->offsets_.push_back(0);
+    for (TimelineTrack& track : tracks) {
+        if (track.keyframes.empty()) {
+            throw std::invalid_argument("track for light " + std::to_string(track.lightId) + " has no keyframes");
+        }
+        if (!seen.insert(track.lightId).second) {
+            throw std::invalid_argument("light " + std::to_string(track.lightId) + " has more than one track");
+        }
+        for (const Keyframe& key : track.keyframes) {
+            if (!std::isfinite(key.timeMs) || key.timeMs < 0) {
+                throw std::invalid_argument("keyframe times must be finite and >= 0");
+            }
+        }
+        std::stable_sort(track.keyframes.begin(), track.keyframes.end(),
+                         [](const Keyframe& a, const Keyframe& b) { return a.timeMs < b.timeMs; });
+
+        for (const Keyframe& key : track.keyframes) {
+            timeline->times_.push_back(key.timeMs);
+            timeline->colors_.push_back(key.color);
+            timeline->easings_.push_back(key.easing);
+        }
+        lastKeyframe = std::max(lastKeyframe, track.keyframes.back().timeMs);
+        timeline->lightIds_.push_back(track.lightId);
+        timeline->offsets_.push_back(static_cast<uint32_t>(timeline->times_.size()));
+    }
+
+    if (timeline->lightIds_.empty()) {
+        throw std::invalid_argument("timeline has no tracks");
+    }
+    timeline->duration_ = durationMs > 0 ? durationMs : lastKeyframe;
+    timeline->loop_ = loop;
+    if (loop && timeline->duration_ <= 0) {
+        throw std::invalid_argument("a looping timeline needs a duration");
+    }
+    return timeline;
+}
+
+std::shared_ptr<const Timeline> Timeline::FromBlob(const uint8_t* data, size_t size) {
+    BlobReader reader(data, size);
+    if (std::memcmp(reader.Take(4), "HTL1", 4) != 0) {
+        throw std::invalid_argument("not a timeline blob");
+    }
+    bool loop = (reader.U8() & 1) != 0;
+    reader.Take(3);
+    double durationMs = reader.F64();
+
+    uint32_t trackCount = reader.U32();
+    std::vector<TimelineTrack> tracks;
+    for (uint32_t i = 0; i < trackCount; ++i) {
+        TimelineTrack track;
+        track.lightId = static_cast<int32_t>(reader.U32());
+        uint32_t keyframeCount = reader.U32();
+        if (reader.Remaining() / kBlobKeyframeSize < keyframeCount) {
+            throw std::invalid_argument("timeline blob is truncated");
+        }
+        track.keyframes.reserve(keyframeCount);
+        for (uint32_t k = 0; k < keyframeCount; ++k) {
+            Keyframe key;
+            key.timeMs = reader.F64();
+            key.color.r = reader.U8();
+            key.color.g = reader.U8();
+            key.color.b = reader.U8();
+            uint8_t easing = reader.U8();
+            if (easing > static_cast<uint8_t>(Easing::EaseInOut)) {
+                throw std::invalid_argument("unknown easing " + std::to_string(easing));
+            }
+            key.easing = static_cast<Easing>(easing);
+            track.keyframes.push_back(key);
+        }
+        tracks.push_back(std::move(track));
+    }
+    return Compile(std::move(tracks), durationMs, loop);
+}
+
+// Last keyframe at or before timeMs, or begin if timeMs precedes the track
+size_t Timeline::Find(size_t begin, size_t end, double timeMs) const {
+    auto first = times_.begin() + begin;
+    auto it = std::upper_bound(first, times_.begin() + end, timeMs);
+    return it == first ? begin : static_cast<size_t>(it - times_.begin()) - 1;
+}
+
+Rgb Timeline::Evaluate(size_t track, double timeMs, size_t& cursor) const {
+    size_t begin = offsets_[track];
+    size_t end = offsets_[track + 1];
+
+    if (cursor < begin || cursor >= end || times_[cursor] > timeMs) {
+        cursor = Find(begin, end, timeMs);
+    } else if (cursor + 1 < end && times_[cursor + 1] <= timeMs) {
+        // Usually playback has just crossed into the next keyframe
+        ++cursor;
+        if (cursor + 1 < end && times_[cursor + 1] <= timeMs) {
+            cursor = Find(cursor, end, timeMs);
+        }
+    }
+
+    const Rgb& from = colors_[cursor];
+    if (cursor + 1 >= end || timeMs <= times_[cursor]) {
+        return from;
+    }
+    const Rgb& to = colors_[cursor + 1];
+    double t = Ease(easings_[cursor], (timeMs - times_[cursor]) / (times_[cursor + 1] - times_[cursor]));
+    return {
+        from.r + (to.r - from.r) * t,
+        from.g + (to.g - from.g) * t,
+        from.b + (to.b - from.b) * t
+    };
+}
+
+std::unique_ptr<NativeEffect> CreateTimelineEffect(std::shared_ptr<const Timeline> timeline) {
+    return std::unique_ptr<NativeEffect>(new TimelineEffect(std::move(timeline)));
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "easing.h"
+#include "effect_engine.h"
+
+// "linear", "step", "easeIn", "easeOut", "easeInOut"
+bool ParseEasing(const std::string& name, Easing& easing);
+
+struct Keyframe {
+    double timeMs;
+    Rgb color;
+    Easing easing = Easing::Linear;
+};
+
+struct TimelineTrack {
+    int lightId;
+    std::vector<Keyframe> keyframes;
+};
+
+// Compiled, immutable show: the keyframes of every track are packed into flat
+// arrays (times, colors and easings stored separately) so playback walks
+// contiguous memory and seeking is a binary search within one track.
+class Timeline {
+public:
+    // durationMs <= 0 ends the timeline at its last keyframe. Throws
+    // std::invalid_argument for empty or duplicate tracks and bad times.
+    static std::shared_ptr<const Timeline> Compile(std::vector<TimelineTrack> tracks, double durationMs, bool loop);
+
+    // Binary form (all values little-endian):
+    //   "HTL1", u8 flags (bit 0 = loop), 3 reserved bytes, f64 durationMs,
+    //   u32 trackCount, then per track: i32 lightId, u32 keyframeCount and
+    //   keyframeCount x { f64 timeMs, u8 r, u8 g, u8 b, u8 easing }
+    static std::shared_ptr<const Timeline> FromBlob(const uint8_t* data, size_t size);
+
+    const std::vector<int>& LightIds() const { return lightIds_; }
+    double Duration() const { return duration_; }
+    bool Loops() const { return loop_; }
+    size_t KeyframeCount() const { return times_.size(); }
+
+    // Color of a track at timeMs. cursor caches the keyframe found on the
+    // previous call, so forward playback is O(1) per track and any jump
+    // falls back to an O(log n) search.
+    Rgb Evaluate(size_t track, double timeMs, size_t& cursor) const;
+
+private:
+    Timeline() = default;
+
+    size_t Find(size_t begin, size_t end, double timeMs) const;
+
+    std::vector<int> lightIds_;
+    std::vector<uint32_t> offsets_;  // track i owns [offsets_[i], offsets_[i + 1])
+    std::vector<double> times_;
+    std::vector<Rgb> colors_;
+    std::vector<Easing> easings_;
+    double duration_ = 0;
+    bool loop_ = false;
+};
+
+// Plays a compiled timeline; lights are the timeline's LightIds() in order
+std::unique_ptr<NativeEffect> CreateTimelineEffect(std::shared_ptr<const Timeline> timeline);
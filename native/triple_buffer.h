@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer. The producer
+// fills Back() and publishes it; the consumer takes the newest published
+// buffer with Acquire() and reads it through Front(). Neither side ever
+// waits for the other, and the consumer always sees a complete buffer.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle_(1), back_(0), front_(2) {}
+
+    // Producer side
+    T& Back() { return buffers_[back_]; }
+
+    void Publish() {
+        uint8_t previous = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_ = previous & kIndexMask;
+    }
+
+    // Consumer side. Returns true if a newer buffer was taken into Front().
+    bool Acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & kIndexMask;
+        return true;
+    }
+
+    const T& Front() const { return buffers_[front_]; }
+
+    // Not thread-safe: only call while neither side is active
+    void Reset(const T& value) {
+        for (T& buffer : buffers_) {
+            buffer = value;
+        }
+        middle_.store(1, std::memory_order_relaxed);
+        back_ = 0;
+        front_ = 2;
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    T buffers_[3];
+    std::atomic<uint8_t> middle_;  // index of the shared buffer | kFresh
+    uint8_t back_;                 // owned by the producer
+    uint8_t front_;                // owned by the consumer
+};
@@ -0,0 +1,257 @@
+#include "warm_start.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "huestream/common/data/Light.h"
+
+using namespace huestream;
+
+static const char kMagic[4] = {'H', 'W', 'R', 'M'};
+static const uint32_t kWarmStartVersion = 1;
+
+WarmStartState CaptureWarmStart(const BridgePtr& bridge, const GroupPtr& group) {
+    WarmStartState state;
+    if (bridge) {
+        state.bridgeId = bridge->GetId();
+        state.ip = bridge->GetIpAddress();
+        state.modelId = bridge->GetModelId();
+        state.apiVersion = bridge->GetApiversion();
+        state.swVersion = bridge->GetSwversion();
+        state.bridgeName = bridge->GetName();
+    }
+    if (group) {
+        state.groupId = group->GetId();
+        state.groupName = group->GetName();
+        auto lights = group->GetLights();
+        if (lights) {
+            for (const auto& light : *lights) {
+                Location position = light->GetPosition();
+                state.lights.push_back({light->GetId(), light->GetName(), light->GetModel(),
+                                        static_cast<float>(position.GetX()),
+                                        static_cast<float>(position.GetY()),
+                                        static_cast<float>(position.GetZ())});
+            }
+        }
+    }
+    return state;
+}
+
+bool SameTopology(const WarmStartState& a, const WarmStartState& b) {
+    if (a.groupId != b.groupId || a.lights.size() != b.lights.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.lights.size(); ++i) {
+        const WarmStartLight& la = a.lights[i];
+        const WarmStartLight& lb = b.lights[i];
+        if (la.id != lb.id || la.model != lb.model || la.x != lb.x || la.y != lb.y || la.z != lb.z) {
+            return false;
+        }
+    }
+    return true;
+}
+
+GroupPtr BuildWarmStartGroup(const WarmStartState& state) {
+    auto lights = std::make_shared<LightList>();
+    for (const WarmStartLight& light : state.lights) {
+        lights->push_back(std::make_shared<Light>(light.id, Location(light.x, light.y, light.z),
+                                                  light.name, light.model));
+    }
+    auto group = std::make_shared<Group>();
+    group->SetId(state.groupId);
+    group->SetName(state.groupName);
+    group->SetLights(lights);
+    return group;
+}
+
+// ============= File =============
+
+namespace {
+
+void PutBytes(std::string& out, const void* data, size_t size) {
+    out.append(static_cast<const char*>(data), size);
+}
+
+// Numbers are stored little-endian whatever the host order
+void PutU32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void PutU64(std::string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void PutFloat(std::string& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    PutU32(out, bits);
+}
+
+void PutDouble(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, 8);
+    PutU64(out, bits);
+}
+
+void PutString(std::string& out, const std::string& value) {
+    // Longer values are cut; ids, models and names are far shorter
+    uint8_t length = static_cast<uint8_t>(value.size() < 255 ? value.size() : 255);
+    PutBytes(out, &length, 1);
+    PutBytes(out, value.data(), length);
+}
+
+class Reader {
+public:
+    explicit Reader(const std::string& data) : data_(data) {}
+
+    bool Bytes(void* out, size_t size) {
+        if (data_.size() - offset_ < size) {
+            return false;
+        }
+        std::memcpy(out, data_.data() + offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+    bool U32(uint32_t& out) {
+        uint64_t value;
+        if (!Little(value, 4)) {
+            return false;
+        }
+        out = static_cast<uint32_t>(value);
+        return true;
+    }
+
+    bool Float(float& out) {
+        uint32_t bits;
+        if (!U32(bits)) {
+            return false;
+        }
+        std::memcpy(&out, &bits, 4);
+        return true;
+    }
+
+    bool Double(double& out) {
+        uint64_t bits;
+        if (!Little(bits, 8)) {
+            return false;
+        }
+        std::memcpy(&out, &bits, 8);
+        return true;
+    }
+
+    bool String(std::string& out) {
+        uint8_t length;
+        if (!Bytes(&length, 1) || data_.size() - offset_ < length) {
+            return false;
+        }
+        out.assign(data_, offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+private:
+    // size bytes, least significant first
+    bool Little(uint64_t& out, size_t size) {
+        uint8_t bytes[8];
+        if (!Bytes(bytes, size)) {
+            return false;
+        }
+        out = 0;
+        for (size_t i = 0; i < size; ++i) {
+            out |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return true;
+    }
+
+    const std::string& data_;
+    size_t offset_ = 0;
+};
+
+}  // namespace
+
+bool LoadWarmStart(const std::string& path, WarmStartState& state) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::string data;
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, read);
+    }
+    std::fclose(file);
+
+    Reader reader(data);
+    char magic[4];
+    uint32_t version;
+    uint32_t lightCount;
+    WarmStartState loaded;
+    if (!reader.Bytes(magic, 4) || std::memcmp(magic, kMagic, 4) != 0 ||
+        !reader.U32(version) || version != kWarmStartVersion ||
+        !reader.Double(loaded.coldStartMs) ||
+        !reader.String(loaded.bridgeId) || !reader.String(loaded.ip) || !reader.String(loaded.modelId) ||
+        !reader.String(loaded.apiVersion) || !reader.String(loaded.swVersion) ||
+        !reader.String(loaded.bridgeName) || !reader.String(loaded.groupId) ||
+        !reader.String(loaded.groupName) || !reader.U32(lightCount)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < lightCount; ++i) {
+        WarmStartLight light;
+        if (!reader.String(light.id) || !reader.String(light.name) || !reader.String(light.model) ||
+            !reader.Float(light.x) || !reader.Float(light.y) || !reader.Float(light.z)) {
+            return false;
+        }
+        loaded.lights.push_back(std::move(light));
+    }
+    state = std::move(loaded);
+    return true;
+}
+
+bool SaveWarmStart(const std::string& path, const WarmStartState& state) {
+    std::string data;
+    PutBytes(data, kMagic, 4);
+    PutU32(data, kWarmStartVersion);
+    PutDouble(data, state.coldStartMs);
+    for (const std::string* value : {&state.bridgeId, &state.ip, &state.modelId, &state.apiVersion,
+                                     &state.swVersion, &state.bridgeName, &state.groupId, &state.groupName}) {
+        PutString(data, *value);
+    }
+    uint32_t lightCount = static_cast<uint32_t>(state.lights.size());
+    PutU32(data, lightCount);
+    for (const WarmStartLight& light : state.lights) {
+        PutString(data, light.id);
+        PutString(data, light.name);
+        PutString(data, light.model);
+        PutFloat(data, light.x);
+        PutFloat(data, light.y);
+        PutFloat(data, light.z);
+    }
+
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fwrite(data.data(), data.size(), 1, file) == 1;
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        // Windows does not rename over an existing file
+        std::remove(path.c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    return true;
+}
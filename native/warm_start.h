@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "huestream/common/data/Bridge.h"
+#include "huestream/common/data/Group.h"
+
+// What a cold start learned from the bridge: enough to stream to the same
+// group again without asking for the bridge configuration and group list
+// first. Credentials are not part of it; they still come from the caller.
+struct WarmStartLight {
+    std::string id;
+    std::string name;
+    std::string model;
+    float x = 0;
+    float y = 0;
+    float z = 0;
+};
+
+struct WarmStartState {
+    // Bridge and its capabilities
+    std::string bridgeId;
+    std::string ip;
+    std::string modelId;
+    std::string apiVersion;
+    std::string swVersion;
+    std::string bridgeName;
+    // Entertainment group topology
+    std::string groupId;
+    std::string groupName;
+    std::vector<WarmStartLight> lights;
+    // Connect to streaming on the cold start that wrote the state
+    double coldStartMs = 0;
+};
+
+// The bridge's current view; lights in group order
+WarmStartState CaptureWarmStart(const huestream::BridgePtr& bridge, const huestream::GroupPtr& group);
+// Same group and lights (ids, models and positions) as last time
+bool SameTopology(const WarmStartState& a, const WarmStartState& b);
+huestream::GroupPtr BuildWarmStartGroup(const WarmStartState& state);
+
+// Cache file, little-endian:
+//
+//   "HWRM", uint32 version, double coldStartMs
+//   bridgeId, ip, modelId, apiVersion, swVersion, bridgeName,
+//   groupId, groupName                 { uint8 length, length bytes } each
+//   uint32 lightCount
+//   lights                             id, name, model, float x, y, z
+//
+// Load fails on a missing, short or foreign file, and the caller starts
+// cold. Save writes a temporary file next to path and renames it over, so a
+// crash mid-write leaves the previous cache.
+bool LoadWarmStart(const std::string& path, WarmStartState& state);
+bool SaveWarmStart(const std::string& path, const WarmStartState& state);
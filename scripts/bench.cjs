@@ -0,0 +1,494 @@
+#!/usr/bin/env node
+
+// Benchmark suite for the streaming hot path. Runs everything against the
+// simulated bridge backend, so no hardware or network is needed.
+//
+// Build both addons first:
+//   cd native && npx node-gyp rebuild --bench=1
+// then (Node before 23.6 needs the flag to load the TypeScript helpers):
+//   node --experimental-strip-types scripts/bench.cjs [--lights=3,10,25,50] [--duration=2000] [--out=bench-results.json]
+//
+// Writes one JSON report with the scenarios below for every light count:
+//   setters      N-API calls per second for each setter
+//   mixerLock    mixer lock wait / hold, lock-free publish and render frame times,
+//                and render tick intervals with and without the writer
+//   updateLoop   output frame rate, jitter and setter-to-frame latency of a
+//                16 ms setInterval loop under synthetic event-loop load
+//   colorKernels batch kernels natively, through N-API and against the JS
+//                color helpers in src/hue-light-control.ts
+//   effectRender per-frame cost of the native effects, live and from the frame cache
+//   transitions  a fade driven from JS every 16 ms against 5 Hz keyframes the
+//                render thread interpolates: calls, CPU time and smoothness
+// plus a triple buffer stress run that must report zero torn frames, and the
+// cost and accuracy of the per-gamut output correction table (outputLut).
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { execSync } = require('child_process');
+
+const nativeDir = path.join(__dirname, '..', 'native');
+const addonFile = path.join(nativeDir, 'build', 'Release', 'hue_edk.node');
+const benchFile = path.join(nativeDir, 'build', 'Release', 'bench', 'hue_edk_bench.node');
+
+for (const file of [addonFile, benchFile]) {
+    if (!fs.existsSync(file)) {
+        console.error('Error: Built binary not found at:', file);
+        console.error('   Run "cd native && npx node-gyp rebuild --bench=1" first');
+        process.exit(1);
+    }
+}
+
+const addon = require(addonFile);
+const bench = require(benchFile);
+
+// ============= Options =============
+
+function readOption(name, fallback) {
+    const prefix = `--${name}=`;
+    const arg = process.argv.find(value => value.startsWith(prefix));
+    return arg ? arg.slice(prefix.length) : fallback;
+}
+
+const lightCounts = readOption('lights', '3,10,25,50').split(',').map(Number);
+const durationMs = Number(readOption('duration', '2000'));
+const outFile = path.resolve(readOption('out', 'bench-results.json'));
+
+const BRIDGE = { id: 'bench', ip: '127.0.0.1', username: 'bench', clientKey: 'bench' };
+const FRAME_MS = 1000 / 60;
+
+// ============= Helpers =============
+
+function nowNs() {
+    return Number(process.hrtime.bigint());
+}
+
+// Same shape as the native summaries: { count, mean, p50, p99, max }
+function summarize(values) {
+    if (values.length === 0) {
+        return { count: 0 };
+    }
+    const sorted = Float64Array.from(values).sort();
+    const mean = sorted.reduce((sum, value) => sum + value, 0) / sorted.length;
+    const at = fraction => sorted[Math.round(fraction * (sorted.length - 1))];
+    return { count: sorted.length, mean, p50: at(0.5), p99: at(0.99), max: sorted[sorted.length - 1] };
+}
+
+function stddev(values) {
+    if (values.length < 2) {
+        return 0;
+    }
+    const mean = values.reduce((sum, value) => sum + value, 0) / values.length;
+    return Math.sqrt(values.reduce((sum, value) => sum + (value - mean) ** 2, 0) / (values.length - 1));
+}
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+function connectSimulated(lights, captureFrames) {
+    const hue = new addon.HueWrapper('bench', 'bench', { backend: 'simulated', lights, captureFrames });
+    hue.initialize();
+    hue.connectManual(BRIDGE);
+    hue.selectGroup('1');
+    if (!hue.start()) {
+        throw new Error('Simulated bridge did not start streaming');
+    }
+    return hue;
+}
+
+// Calls fn(i) in batches until budgetMs has passed; returns calls per second
+function callsPerSecond(fn, budgetMs) {
+    const batch = 1000;
+    let calls = 0;
+    const start = nowNs();
+    const end = start + budgetMs * 1e6;
+    let now = start;
+    while (now < end) {
+        for (let i = 0; i < batch; i++) {
+            fn(calls + i);
+        }
+        calls += batch;
+        now = nowNs();
+    }
+    return calls / ((now - start) / 1e9);
+}
+
+// ============= Setters =============
+
+function benchSetters(lights) {
+    const hue = connectSimulated(lights, 16);
+    const ids = Int32Array.from({ length: lights }, (_, i) => i + 1);
+    const frame = new Float32Array(lights * 3).fill(128);
+    const budget = Math.max(100, durationMs / 8);
+
+    const setters = {
+        setColorRGB: i => hue.setColorRGB(i & 255, 64, 128),
+        setColorRGBA: i => hue.setColorRGBA(i & 255, 64, 128, 0.5),
+        setColorXY: i => hue.setColorXY(0.3 + (i & 15) / 100, 0.3, 0.8),
+        setColorCT: i => hue.setColorCT(153 + (i & 255), 0.8),
+        setLightColorRGB: i => hue.setLightColorRGB(ids[i % lights], i & 255, 64, 128),
+        setLightColorRGBA: i => hue.setLightColorRGBA(ids[i % lights], i & 255, 64, 128, 0.5),
+        setLightColorXY: i => hue.setLightColorXY(ids[i % lights], 0.3 + (i & 15) / 100, 0.3, 0.8),
+        setLightColorCT: i => hue.setLightColorCT(ids[i % lights], 153 + (i & 255), 0.8),
+        setBrightness: i => hue.setBrightness((i & 255) / 255),
+        setLightBrightness: i => hue.setLightBrightness(ids[i % lights], (i & 255) / 255),
+        setFrame: i => {
+            frame[0] = i & 255;
+            hue.setFrame(ids, frame, 'rgb');
+        },
+    };
+
+    const result = {};
+    for (const [name, fn] of Object.entries(setters)) {
+        result[name] = { callsPerSecond: callsPerSecond(fn, budget) };
+    }
+    hue.shutdown();
+    return result;
+}
+
+// ============= Update Loop =============
+
+// Busy-waits busyMs out of every periodMs on the JS thread
+function startLoad(busyMs, periodMs) {
+    if (busyMs <= 0) {
+        return () => {};
+    }
+    const timer = setInterval(() => {
+        const end = nowNs() + busyMs * 1e6;
+        while (nowNs() < end) {
+            // spin
+        }
+    }, periodMs);
+    return () => clearInterval(timer);
+}
+
+// A startUpdateLoop()-style effect: every 16 ms compute a gradient for all
+// lights and send it with one setFrame(). Light 1's red channel carries the
+// tick number so each tick can be found again in the captured output.
+async function benchUpdateLoop(lights, load) {
+    const hue = connectSimulated(lights, 4096);
+    const ids = Int32Array.from({ length: lights }, (_, i) => i + 1);
+    const frame = new Float32Array(lights * 3);
+    const sent = [];
+
+    await sleep(50);
+    hue.clearCapturedFrames();
+    const stopLoad = startLoad(load.busyMs, load.periodMs);
+
+    let tick = 0;
+    const start = Date.now();
+    const timer = setInterval(() => {
+        const elapsed = Date.now() - start;
+        for (let i = 0; i < lights; i++) {
+            const phase = (elapsed / 2000 + i / lights) % 1;
+            frame[i * 3] = 255 * phase;
+            frame[i * 3 + 1] = 255 * (1 - phase);
+            frame[i * 3 + 2] = 128;
+        }
+        frame[0] = tick % 256;
+        sent.push(nowNs());
+        hue.setFrame(ids, frame, 'rgb');
+        tick++;
+    }, 16);
+
+    await sleep(durationMs);
+    clearInterval(timer);
+    stopLoad();
+    await sleep(50);
+
+    const captured = hue.getCapturedFrames(0);
+    hue.shutdown();
+
+    const stride = captured.lightIds.length * 3;
+    const tickIntervals = [];
+    for (let i = 1; i < sent.length; i++) {
+        tickIntervals.push((sent[i] - sent[i - 1]) / 1e6);
+    }
+
+    // Walk the output in order: each frame shows the newest tick whose code it
+    // carries; ticks replaced before a render never reach the output
+    const latencies = [];
+    const changeTimes = [];
+    let lastTick = -1;
+    for (let f = 0; f < captured.count; f++) {
+        const code = Math.round(captured.colors[f * stride] * 255);
+        const t = lastTick < 0 ? code : lastTick + ((code - (lastTick % 256) + 256) % 256);
+        if (t === lastTick || t >= sent.length || sent[t] > captured.timesNs[f]) {
+            continue;
+        }
+        latencies.push((captured.timesNs[f] - sent[t]) / 1e3);
+        changeTimes.push(captured.timesNs[f]);
+        lastTick = t;
+    }
+
+    const changeIntervals = [];
+    for (let i = 1; i < changeTimes.length; i++) {
+        changeIntervals.push((changeTimes[i] - changeTimes[i - 1]) / 1e6);
+    }
+    const outputSpanS = captured.count > 1
+        ? (captured.timesNs[captured.count - 1] - captured.timesNs[0]) / 1e9 : 0;
+
+    return {
+        load,
+        ticks: sent.length,
+        tickRateHz: tickIntervals.length / (tickIntervals.reduce((sum, v) => sum + v, 0) / 1000 || 1),
+        tickJitterMs: stddev(tickIntervals),
+        outputFrames: captured.count,
+        outputFps: outputSpanS > 0 ? (captured.count - 1) / outputSpanS : 0,
+        // Ticks that reached the output, and the cadence at which they did
+        deliveredTicks: latencies.length,
+        updateRateHz: changeIntervals.length / (changeIntervals.reduce((sum, v) => sum + v, 0) / 1000 || 1),
+        updateJitterMs: stddev(changeIntervals),
+        setterToFrameUs: summarize(latencies),
+    };
+}
+
+// ============= Transitions =============
+
+// The same fade, back and forth between two gradients every 2 s, driven
+// either from JS (colors interpolated in JS and sent with setFrame() every
+// 16 ms) or with keyframes every 200 ms that the render thread interpolates
+// (setLightTransitions()). maxStep is the largest change of any channel
+// (0-255) between two output frames: the smoothness of the result.
+async function benchTransitions(lights) {
+    const ids = Int32Array.from({ length: lights }, (_, i) => i + 1);
+    const colorAt = (timeMs, out) => {
+        const phase = (timeMs / 2000) % 2;
+        const t = phase < 1 ? phase : 2 - phase;
+        for (let i = 0; i < lights; i++) {
+            out[i * 3] = 255 * t;
+            out[i * 3 + 1] = 255 * (1 - t) * (i + 1) / lights;
+            out[i * 3 + 2] = 64;
+        }
+    };
+
+    const run = async (keyframes) => {
+        const hue = connectSimulated(lights, 4096);
+        const frame = new Float32Array(lights * 3);
+        const periodMs = keyframes ? 200 : 16;
+        await sleep(50);
+        hue.clearCapturedFrames();
+
+        let calls = 0;
+        const start = nowNs();
+        const cpuStart = process.cpuUsage();
+        const send = () => {
+            const elapsed = (nowNs() - start) / 1e6;
+            if (keyframes) {
+                // Where the fade should be when the next keyframe is due
+                colorAt(elapsed + periodMs, frame);
+                hue.setLightTransitions(ids, frame, 'rgb', periodMs);
+            } else {
+                colorAt(elapsed, frame);
+                hue.setFrame(ids, frame, 'rgb');
+            }
+            calls++;
+        };
+        send();
+        const timer = setInterval(send, periodMs);
+        await sleep(durationMs);
+        clearInterval(timer);
+        const cpu = process.cpuUsage(cpuStart);
+
+        const captured = hue.getCapturedFrames(0);
+        hue.shutdown();
+
+        // Skips the fade in from black at the start
+        const stride = captured.lightIds.length * 3;
+        let maxStep = 0;
+        for (let f = 1; f < captured.count; f++) {
+            if (captured.timesNs[f] < start + 300e6) {
+                continue;
+            }
+            for (let c = 0; c < stride; c++) {
+                const step = Math.abs(captured.colors[f * stride + c] - captured.colors[(f - 1) * stride + c]);
+                maxStep = Math.max(maxStep, step * 255);
+            }
+        }
+        return {
+            calls,
+            callsPerSecond: calls / (durationMs / 1000),
+            cpuMs: (cpu.user + cpu.system) / 1000,
+            outputFrames: captured.count,
+            maxStep,
+        };
+    };
+
+    return { jsLoop: await run(false), keyframes: await run(true) };
+}
+
+// ============= Color Kernels =============
+
+// The JS helpers effects use today, loaded from the source tree (plain
+// TypeScript, so Node needs --experimental-strip-types before 23.6)
+async function loadColorHelpers() {
+    const { pathToFileURL } = require('url');
+    return import(pathToFileURL(path.join(__dirname, '..', 'src', 'hue-light-control.ts')).href);
+}
+
+// src has no JS helpers for xy, gamma or brightness; these are written like
+// hsvToRgb() and interpolateColor(), one object per light per call, so all
+// five kernels are compared against the same style of code
+
+// Same conversion and gamut C clipping as the native kernel
+const GAMUT = [[0.6915, 0.3083], [0.17, 0.7], [0.1532, 0.0475]];
+
+function linearize(c) {
+    return c > 0.04045 ? ((c + 0.055) / 1.055) ** 2.4 : c / 12.92;
+}
+
+function closestOnEdge(x, y, [ax, ay], [bx, by]) {
+    const dx = bx - ax, dy = by - ay;
+    const t = Math.min(1, Math.max(0, ((x - ax) * dx + (y - ay) * dy) / (dx * dx + dy * dy)));
+    const px = ax + t * dx, py = ay + t * dy;
+    return { x: px, y: py, dist2: (x - px) ** 2 + (y - py) ** 2 };
+}
+
+function rgbToXyColor(color) {
+    const r = linearize(Math.min(1, Math.max(0, color.r / 255)));
+    const g = linearize(Math.min(1, Math.max(0, color.g / 255)));
+    const b = linearize(Math.min(1, Math.max(0, color.b / 255)));
+    const X = r * 0.664511 + g * 0.154324 + b * 0.162028;
+    const Y = r * 0.283881 + g * 0.668433 + b * 0.047685;
+    const Z = r * 0.000088 + g * 0.072310 + b * 0.986039;
+    const sum = X + Y + Z;
+    let x = sum > 1e-6 ? X / sum : 0.3127;
+    let y = sum > 1e-6 ? Y / sum : 0.3290;
+    const side = ([ax, ay], [bx, by]) => (y - ay) * (bx - ax) - (x - ax) * (by - ay);
+    if (side(GAMUT[0], GAMUT[1]) < -1e-7 || side(GAMUT[1], GAMUT[2]) < -1e-7 || side(GAMUT[2], GAMUT[0]) < -1e-7) {
+        let best = closestOnEdge(x, y, GAMUT[0], GAMUT[1]);
+        for (const [from, to] of [[GAMUT[1], GAMUT[2]], [GAMUT[2], GAMUT[0]]]) {
+            const edge = closestOnEdge(x, y, from, to);
+            if (edge.dist2 < best.dist2) {
+                best = edge;
+            }
+        }
+        x = best.x;
+        y = best.y;
+    }
+    return { x, y, brightness: Math.min(1, Math.max(0, Y)) };
+}
+
+function gammaColor(color, gamma) {
+    const curve = v => 255 * Math.min(1, Math.max(0, v / 255)) ** gamma;
+    return { r: curve(color.r), g: curve(color.g), b: curve(color.b) };
+}
+
+function scaleColor(color, scale) {
+    const scaled = v => Math.min(255, Math.max(0, v * scale));
+    return { r: scaled(color.r), g: scaled(color.g), b: scaled(color.b) };
+}
+
+async function benchColorKernels(lights) {
+    const helpers = await loadColorHelpers();
+    const iterations = 20000;
+    const hsv = Float32Array.from({ length: lights * 3 }, (_, i) => (i % 3 === 0 ? (i / 3) / lights : 1));
+    const a = Float32Array.from({ length: lights * 3 }, (_, i) => (i * 37) % 256);
+    const b = a.slice().reverse();
+    const out = new Float32Array(lights * 3);
+    const kernels = addon.colorKernels;
+
+    // The JS side holds one color object per light, as the effects do
+    const toColors = data => Array.from({ length: lights }, (_, i) => ({ r: data[i * 3], g: data[i * 3 + 1], b: data[i * 3 + 2] }));
+    const colorsA = toColors(a);
+    const colorsB = toColors(b);
+    const frame = new Array(lights);
+
+    const nsPerFrame = fn => {
+        const start = nowNs();
+        for (let i = 0; i < iterations; i++) {
+            fn();
+        }
+        return (nowNs() - start) / iterations;
+    };
+    const perLight = fn => () => {
+        for (let i = 0; i < lights; i++) {
+            frame[i] = fn(i);
+        }
+    };
+
+    return {
+        native: bench.colorKernels({ lights, iterations }),
+        napi: {
+            lerpColors: nsPerFrame(() => kernels.lerpColors(a, b, 0.25, out)),
+            hsvToRgb: nsPerFrame(() => kernels.hsvToRgb(hsv, out)),
+            rgbToXy: nsPerFrame(() => kernels.rgbToXy(a, out)),
+            applyGamma: nsPerFrame(() => kernels.applyGamma(a, 2.2, out)),
+            scaleBrightness: nsPerFrame(() => kernels.scaleBrightness(a, 0.8, out)),
+        },
+        js: {
+            lerpColors: nsPerFrame(perLight(i => helpers.interpolateColor(colorsA[i], colorsB[i], 0.25))),
+            hsvToRgb: nsPerFrame(perLight(i => helpers.hsvToRgb(hsv[i * 3], hsv[i * 3 + 1], hsv[i * 3 + 2]))),
+            rgbToXy: nsPerFrame(perLight(i => rgbToXyColor(colorsA[i]))),
+            applyGamma: nsPerFrame(perLight(i => gammaColor(colorsA[i], 2.2))),
+            scaleBrightness: nsPerFrame(perLight(i => scaleColor(colorsA[i], 0.8))),
+        },
+    };
+}
+
+// ============= Main =============
+
+const LOADS = [
+    { name: 'idle', busyMs: 0, periodMs: 0 },
+    { name: 'moderate', busyMs: 4, periodMs: 20 },
+    { name: 'heavy', busyMs: 12, periodMs: 20 },
+];
+
+function gitCommit() {
+    try {
+        return execSync('git rev-parse HEAD', { cwd: __dirname, stdio: ['ignore', 'pipe', 'ignore'] })
+            .toString().trim();
+    } catch {
+        return null;
+    }
+}
+
+async function main() {
+    const report = {
+        version: require('../package.json').version,
+        commit: gitCommit(),
+        date: new Date().toISOString(),
+        node: process.version,
+        platform: process.platform,
+        arch: process.arch,
+        cpus: os.cpus().length,
+        cpuModel: os.cpus()[0] ? os.cpus()[0].model : null,
+        isa: addon.colorKernels.isa,
+        durationMs,
+        frameMs: FRAME_MS,
+        tripleBuffer: bench.tripleBuffer({ lights: 50, durationMs: Math.min(durationMs, 1000) }),
+        outputLut: bench.outputLut({ samples: 100000 }),
+        runs: [],
+    };
+
+    for (const lights of lightCounts) {
+        console.log(`Benchmarking ${lights} lights...`);
+        const run = {
+            lights,
+            setters: benchSetters(lights),
+            mixerLock: bench.mixerLock({ lights, durationMs }),
+            updateLoop: [],
+            colorKernels: await benchColorKernels(lights),
+            effectRender: bench.effectRender({ lights }),
+            transitions: await benchTransitions(lights),
+        };
+        for (const load of LOADS) {
+            run.updateLoop.push(await benchUpdateLoop(lights, load));
+        }
+        report.runs.push(run);
+    }
+
+    fs.writeFileSync(outFile, JSON.stringify(report, null, 2) + '\n');
+
+    if (report.tripleBuffer.torn > 0 || report.tripleBuffer.regressions > 0) {
+        console.error('Triple buffer handed out torn or stale frames:', report.tripleBuffer);
+        process.exitCode = 1;
+    }
+    console.log(`Wrote ${path.relative(process.cwd(), outFile)}`);
+}
+
+main().catch(error => {
+    console.error(error);
+    process.exit(1);
+});
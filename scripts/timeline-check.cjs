@@ -0,0 +1,65 @@
+#!/usr/bin/env node
+
+// Checks the binary timeline encoding in src/timeline.ts, so no addon build
+// is needed. Keyframe colors outside 0-255 or with fractions must be clamped
+// and rounded, not wrapped modulo 256.
+//
+// Run (Node before 23.6 needs the flag to load the TypeScript source):
+//   node --experimental-strip-types scripts/timeline-check.cjs
+
+const path = require('path');
+const { pathToFileURL } = require('url');
+
+const HEADER_SIZE = 20;
+const TRACK_HEADER_SIZE = 8;
+const KEYFRAME_SIZE = 12;
+
+// ============= Helpers =============
+
+function check(condition, message) {
+    if (!condition) {
+        throw new Error(`Check failed: ${message}`);
+    }
+}
+
+// [r, g, b] of each keyframe in the first track of an encoded timeline
+function keyColors(bytes) {
+    const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+    const count = view.getUint32(HEADER_SIZE + 4, true);
+    const colors = [];
+    for (let k = 0; k < count; k++) {
+        const offset = HEADER_SIZE + TRACK_HEADER_SIZE + k * KEYFRAME_SIZE + 8;
+        colors.push([view.getUint8(offset), view.getUint8(offset + 1), view.getUint8(offset + 2)]);
+    }
+    return colors;
+}
+
+// ============= Main =============
+
+async function main() {
+    const { encodeTimeline } = await import(pathToFileURL(path.join(__dirname, '..', 'src', 'timeline.ts')).href);
+
+    const cases = [
+        { color: { r: 0, g: 128, b: 255 }, expected: [0, 128, 255] },
+        { color: { r: 256, g: 300, b: 1000 }, expected: [255, 255, 255] },
+        { color: { r: -1, g: -0.4, b: -255 }, expected: [0, 0, 0] },
+        { color: { r: 0.4, g: 0.5, b: 254.6 }, expected: [0, 1, 255] },
+        { color: { r: 127.49, g: 127.5, b: 255.4 }, expected: [127, 128, 255] },
+    ];
+    const bytes = encodeTimeline({
+        tracks: [{ lightId: 1, keyframes: cases.map((entry, k) => ({ t: k * 100, color: entry.color })) }],
+    });
+
+    check(bytes.length === HEADER_SIZE + TRACK_HEADER_SIZE + cases.length * KEYFRAME_SIZE, 'the encoded size');
+    keyColors(bytes).forEach((color, k) => {
+        const { color: input, expected } = cases[k];
+        check(color.join() === expected.join(),
+              `keyframe ${JSON.stringify(input)} encodes as ${expected} (got ${color})`);
+    });
+    console.log('Timeline check passed');
+}
+
+main().catch(error => {
+    console.error(error);
+    process.exit(1);
+});
@@ -0,0 +1,182 @@
+#!/usr/bin/env node
+
+// Runs the addon in worker_threads against the simulated bridge backend, so
+// no hardware or network is needed. A worker owns the stream and runs a
+// native effect while the main thread posts frames to it; the check then
+// terminates the worker without closing the stream, so only the addon's
+// environment cleanup hooks shut it down, and repeats the whole round in a
+// fresh worker.
+//
+// Build the addon first:
+//   cd native && npx node-gyp rebuild
+// then:
+//   node scripts/worker-check.cjs [--rounds=2]
+
+const fs = require('fs');
+const path = require('path');
+const { Worker, isMainThread, parentPort } = require('worker_threads');
+
+const nativeDir = path.join(__dirname, '..', 'native');
+const addonFile = path.join(nativeDir, 'build', 'Release', 'hue_edk.node');
+
+if (!fs.existsSync(addonFile)) {
+    console.error('Error: Built binary not found at:', addonFile);
+    console.error('   Run "cd native && npx node-gyp rebuild" first');
+    process.exit(1);
+}
+
+const addon = require(addonFile);
+
+const BRIDGE = { id: 'check', ip: '127.0.0.1', username: 'check', clientKey: 'check' };
+const LIGHTS = 3;
+const EFFECT_LIGHTS = [1, 2];  // the native effect's lights
+const FRAME_LIGHT = 3;         // written only by posted frames
+const SETTLE_MS = 150;         // several 60 Hz ticks
+
+// ============= Helpers =============
+
+function readOption(name, fallback) {
+    const prefix = `--${name}=`;
+    const arg = process.argv.find(value => value.startsWith(prefix));
+    return arg ? arg.slice(prefix.length) : fallback;
+}
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+function check(condition, message) {
+    if (!condition) {
+        throw new Error(`Check failed: ${message}`);
+    }
+}
+
+// Same message as postFrame() in src/hue.ts, which Hue.acceptFrames() applies
+function postFrame(port, lightIds, data, format) {
+    const buffers = [data.buffer];
+    if (lightIds.buffer !== data.buffer) {
+        buffers.push(lightIds.buffer);
+    }
+    port.postMessage({ type: 'hue-frame', lightIds, data, format }, buffers);
+}
+
+// Next reply of the given type from the worker
+function reply(worker, type) {
+    return new Promise((resolve, reject) => {
+        const onMessage = message => {
+            if (message && message.type === type) {
+                worker.off('message', onMessage);
+                worker.off('error', reject);
+                resolve(message);
+            }
+        };
+        worker.on('message', onMessage);
+        worker.once('error', reject);
+    });
+}
+
+// One light's colors over the captured frames, [r, g, b] each
+function lightColors(capture, lightId) {
+    const index = capture.lightIds.indexOf(String(lightId));
+    check(index >= 0, `light ${lightId} is in the captured frames`);
+    const colors = [];
+    for (let frame = 0; frame < capture.count; frame++) {
+        const offset = (frame * capture.lightIds.length + index) * 3;
+        colors.push(Array.from(capture.colors.subarray(offset, offset + 3)));
+    }
+    return colors;
+}
+
+// ============= Worker =============
+
+// Owns the stream; applies posted frames and answers capture requests
+function runWorker() {
+    const hue = new addon.HueWrapper('check', 'worker', { backend: 'simulated', lights: LIGHTS, captureFrames: 64 });
+    hue.initialize();
+    hue.connectManual(BRIDGE);
+    hue.selectGroup('1');
+    if (!hue.start()) {
+        throw new Error('Simulated bridge did not start streaming');
+    }
+    if (!hue.startEffect('rainbowWave', { period: 500 }, EFFECT_LIGHTS)) {
+        throw new Error('Native effect did not start');
+    }
+
+    parentPort.on('message', message => {
+        if (message.type === 'hue-frame') {
+            hue.setFrame(message.lightIds, message.data, message.format);
+        } else if (message.type === 'capture') {
+            const capture = hue.getCapturedFrames();
+            hue.clearCapturedFrames();
+            parentPort.postMessage({ type: 'capture', capture });
+        }
+    });
+    parentPort.postMessage({ type: 'ready' });
+}
+
+// ============= Main =============
+
+// Posts white, then black, to the frame light and checks both reach the
+// bridge while the effect keeps animating its own lights
+async function runRound(round) {
+    const worker = new Worker(__filename);
+    let failure = null;
+    worker.on('error', error => { failure = error; });
+    await reply(worker, 'ready');
+
+    for (const level of [255, 0]) {
+        postFrame(worker, Int32Array.of(FRAME_LIGHT), Float32Array.of(level, level, level), 'rgb');
+        await sleep(SETTLE_MS);
+        // Drop what was sent before the frame arrived
+        worker.postMessage({ type: 'capture' });
+        await reply(worker, 'capture');
+        await sleep(SETTLE_MS);
+        worker.postMessage({ type: 'capture' });
+        const { capture } = await reply(worker, 'capture');
+
+        check(capture && capture.count > 1, `round ${round}: the worker's stream sent frames`);
+        const expected = level / 255;
+        for (const color of lightColors(capture, FRAME_LIGHT)) {
+            check(color.every(channel => Math.abs(channel - expected) < 0.05),
+                  `round ${round}: light ${FRAME_LIGHT} shows the posted ${level} (got ${color})`);
+        }
+        for (const lightId of EFFECT_LIGHTS) {
+            const seen = new Set(lightColors(capture, lightId).map(color => color.join()));
+            check(seen.size > 1, `round ${round}: the native effect animates light ${lightId}`);
+        }
+    }
+
+    // The stream is still open: the environment's cleanup hooks must stop it
+    const exited = new Promise(resolve => worker.once('exit', resolve));
+    await worker.terminate();
+    await exited;
+    if (failure) {
+        throw failure;
+    }
+}
+
+async function main() {
+    const rounds = Number(readOption('rounds', '2'));
+    for (let round = 1; round <= rounds; round++) {
+        await runRound(round);
+        console.log(`Round ${round}: posted frames and the native effect reached the bridge; worker terminated`);
+    }
+
+    // The main environment is unaffected by the workers that came and went
+    const hue = new addon.HueWrapper('check', 'main', { backend: 'simulated', lights: LIGHTS });
+    hue.initialize();
+    hue.connectManual(BRIDGE);
+    hue.selectGroup('1');
+    check(hue.start(), 'the main thread streams after the workers exited');
+    hue.shutdown();
+    console.log('Worker check passed');
+}
+
+if (isMainThread) {
+    main().catch(error => {
+        console.error(error);
+        process.exit(1);
+    });
+} else {
+    runWorker();
+}
@@ -78,22 +78,34 @@ export function hsvToRgb(h: number, s: number, v: number): Color {
     };
 }
 
+// Channels per pending entry in the frame buffer (r, g, b, alpha)
+const FRAME_STRIDE = 4;
+
 export class HueLightControl {
     private hueWrapper: HueWrapper;
     segments: number[] = [0, 1, 2];
 
+    // Segment updates are staged here and flushed as one setFrame() call
+    private frameIds: Int32Array = new Int32Array(8);
+    private frameData: Float32Array = new Float32Array(8 * FRAME_STRIDE);
+    private pendingCount: number = 0;
+
     constructor(hueWrapper: HueWrapper) {
         this.hueWrapper = hueWrapper;
     }
 
     setSegmentColor(segmentId: number, color: Color): void {
-        if (color.alpha !== undefined) {
-            // Use RGBA variant if alpha is specified
-            this.hueWrapper.setLightColorRGBA(segmentId, color.r, color.g, color.b, color.alpha);
-        } else {
-            // Use RGB variant for better performance when alpha not needed
-            this.hueWrapper.setLightColorRGB(segmentId, color.r, color.g, color.b);
+        if (this.pendingCount === this.frameIds.length) {
+            this.growFrame();
         }
+        const offset = this.pendingCount * FRAME_STRIDE;
+        this.frameIds[this.pendingCount] = segmentId;
+        this.frameData[offset] = color.r;
+        this.frameData[offset + 1] = color.g;
+        this.frameData[offset + 2] = color.b;
+        // RGB colors are fully opaque, matching the native RGB setters
+        this.frameData[offset + 3] = color.alpha ?? 1;
+        this.pendingCount++;
     }
 
     setAllSegments(color: Color): void {
@@ -103,7 +115,7 @@ export class HueLightControl {
     }
 
     clearSegment(segmentId: number): void {
-        this.hueWrapper.setLightColorRGB(segmentId, 0, 0, 0);
+        this.setSegmentColor(segmentId, COLORS.black);
     }
 
     clearAllSegments(): void {
@@ -113,6 +125,25 @@ export class HueLightControl {
     }
 
     sendToDevice(): void {
-        this.hueWrapper.update();
+        if (this.pendingCount === 0) {
+            return;
+        }
+        const count = this.pendingCount;
+        this.pendingCount = 0;
+        // Later entries for the same segment win, as with individual setter calls
+        this.hueWrapper.setFrame(
+            this.frameIds.subarray(0, count),
+            this.frameData.subarray(0, count * FRAME_STRIDE),
+            'rgba'
+        );
+    }
+
+    private growFrame(): void {
+        const ids = new Int32Array(this.frameIds.length * 2);
+        ids.set(this.frameIds);
+        const data = new Float32Array(this.frameData.length * 2);
+        data.set(this.frameData);
+        this.frameIds = ids;
+        this.frameData = data;
     }
 }
\ No newline at end of file
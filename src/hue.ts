@@ -1,4 +1,4 @@
-import type { HueWrapper as HueWrapperType } from './native';
+import type { BackendOptions, CaptureSummary, CapturedFrames, ColorKernels, FrameCache, FrameFormat, LayerOptions, LightPositions, OutputCorrection, OutputCorrectionState, RatePolicy, SequenceOptions, SequenceStep, HueStats, HueSessionManager as HueSessionManagerType, HueWrapper as HueWrapperType, NativeEffectName, NativeEffectParams, SpatialField, StateCallback, TimelineEasing, TimelineSource, WarmStartReport } from './native';
 import { HueLightControl, COLORS, interpolateColor, hsvToRgb, type Color } from './hue-light-control';
 import { BRIDGE_CONFIG } from './config';
 
@@ -6,10 +6,18 @@ export interface HueConfig {
     appName: string;
     deviceName: string;
     groupId: string;
+    // Stream through the in-process simulated bridge instead of the EDK
+    backend?: BackendOptions;
+    // Cache file for sub-second restarts (see setWarmStart)
+    warmStart?: string;
 }
 
 interface HueAddon {
     HueWrapper: typeof HueWrapperType;
+    HueSessionManager: typeof HueSessionManagerType;
+    colorKernels: ColorKernels;
+    frameCache: FrameCache;
+    readCaptureFile(path: string): CapturedFrames;
 }
 
 // Load native addon using node-gyp-build (platform-independent)
@@ -18,19 +26,76 @@ const path = require('path');
 const addon = gyp(path.join(__dirname, '..')) as HueAddon;
 const { HueWrapper } = addon;
 
+// Native batch color math (lerp, HSV, xy, gamma, brightness) over Float32Array frames
+export const colorKernels = addon.colorKernels;
+
+// Precomputed cycles of the periodic native effects, with a memory limit
+export const frameCache = addon.frameCache;
+
+// Decodes a capture file written by Hue.startCapture()
+export const readCaptureFile = addon.readCaptureFile;
+
+// Streams to several bridges / groups from one process on a shared render clock
+export const HueSessionManager = addon.HueSessionManager;
+
+// A frame posted to the worker that owns the stream. The sender transfers
+// data's buffer, so the frame is moved, not copied.
+export interface FrameMessage {
+    type: 'hue-frame';
+    lightIds: Int32Array;
+    data: Float32Array | Uint8Array;
+    format: FrameFormat;
+    // Named layer to write, the manual frame when omitted
+    layer?: string;
+}
+
+// A sequence step for Hue.playSequence(); effect and scene steps may leave
+// out lightIds to play on the segments
+type DefaultLights<S> = S extends { lightIds: number[] } ? Omit<S, 'lightIds'> & { lightIds?: number[] } : S;
+export type HueSequenceStep = DefaultLights<SequenceStep>;
+
+// The MessagePort / Worker / parentPort methods used below
+interface FramePort {
+    postMessage(value: unknown, transferList?: ArrayBuffer[]): void;
+    on(event: 'message', listener: (value: unknown) => void): unknown;
+    off(event: 'message', listener: (value: unknown) => void): unknown;
+}
+
+/**
+ * Send a frame to the worker that owns the stream (see Hue.acceptFrames).
+ * data's buffer is transferred and unusable afterwards.
+ */
+export function postFrame(port: Pick<FramePort, 'postMessage'>, lightIds: Int32Array, data: Float32Array | Uint8Array,
+                          format: FrameFormat, layer?: string): void {
+    const message: FrameMessage = { type: 'hue-frame', lightIds, data, format, layer };
+    const buffers = [data.buffer as ArrayBuffer];
+    if (lightIds.buffer !== data.buffer) {
+        buffers.push(lightIds.buffer as ArrayBuffer);
+    }
+    port.postMessage(message, buffers);
+}
+
 export class Hue {
     private hueWrapper: HueWrapperType;
     private hueLightControl: HueLightControl;
     private groupId: string;
     private effectRunning: boolean = false;
     private updateInterval: ReturnType<typeof setTimeout> | null = null;
+    private frameClockRunning: boolean = false;
+    // Bumped by every onStateChange(), so a stale remover leaves a newer listener alone
+    private stateListenerToken: number = 0;
+    // Named layers owned by the running JS effect, removed when it stops
+    private effectLayers: string[] = [];
     private effectStartTime: number = 0;
     private debugLogEnabled: boolean = false;
 
     constructor(config: HueConfig) {
         this.groupId = config.groupId;
-        this.hueWrapper = new HueWrapper(config.appName, config.deviceName);
+        this.hueWrapper = new HueWrapper(config.appName, config.deviceName, config.backend);
         this.hueLightControl = new HueLightControl(this.hueWrapper);
+        if (config.warmStart) {
+            this.hueWrapper.setWarmStart(config.warmStart);
+        }
     }
 
     async initialize(): Promise<boolean> {
@@ -41,24 +106,35 @@ export class Hue {
                 return false;
             }
 
-            const connected = this.hueWrapper.connectManual(BRIDGE_CONFIG);
+            // Bridge handshake and group selection run off the JS thread
+            const connected = await this.hueWrapper.connectManualAsync(BRIDGE_CONFIG);
             if (!connected) {
                 console.log('Hue connection failed');
                 this.hueWrapper.shutdown();
                 return false;
             }
 
-            this.hueWrapper.selectGroup(this.groupId);
-            await new Promise(resolve => setTimeout(resolve, 1000));
-            this.hueWrapper.getStatus();
+            // Resolves as soon as the bridge reports streaming; right away
+            // when the warm start cache already brought the stream up
+            await this.hueWrapper.selectGroupAsync(this.groupId);
 
-            const streaming = this.hueWrapper.start();
+            const streaming = await this.hueWrapper.startAsync();
             if (!streaming) {
                 console.log('Hue streaming failed');
                 this.hueWrapper.shutdown();
                 return false;
             }
 
+            // Address the group's real lights instead of the default segments
+            const lightIds = this.hueWrapper.getLightIds().map(Number).filter(Number.isInteger);
+            if (lightIds.length > 0) {
+                this.hueLightControl.segments = lightIds;
+            }
+
+            const warmStart = this.hueWrapper.getWarmStart();
+            if (warmStart.used) {
+                console.log(`Hue warm start: streaming after ${warmStart.startupMs.toFixed(0)} ms, ${warmStart.savedMs.toFixed(0)} ms saved`);
+            }
             console.log('Hue initialized successfully');
             return true;
         } catch (error) {
@@ -80,6 +156,265 @@ export class Hue {
             clearInterval(this.updateInterval);
             this.updateInterval = null;
         }
+        if (this.frameClockRunning) {
+            this.frameClockRunning = false;
+            try { this.hueWrapper.clearFrameCallback(); } catch {}
+        }
+        for (const name of this.effectLayers) {
+            try { this.hueWrapper.removeLayer(name); } catch {}
+        }
+        this.effectLayers = [];
+        try {
+            if (this.hueWrapper.isEffectRunning()) {
+                this.hueWrapper.stopEffect();
+            }
+        } catch {}
+    }
+
+    /**
+     * Whether a native effect, timeline or sequence is playing. Asks the
+     * render thread, so it turns false when one ends by itself.
+     */
+    isNativeEffectRunning(): boolean {
+        return this.hueWrapper.isEffectRunning();
+    }
+
+    /**
+     * Re-parameterize the running native effect without restarting it
+     * (e.g. change colors or period of gradientWave while it plays)
+     */
+    setEffectParams(params: NativeEffectParams): boolean {
+        return this.hueWrapper.setEffectParams(params);
+    }
+
+    /**
+     * Compile a keyframe timeline natively; play it with playTimeline().
+     * Accepts a definition object, its JSON text or encodeTimeline() output.
+     */
+    loadTimeline(source: TimelineSource): number {
+        return this.hueWrapper.loadTimeline(source);
+    }
+
+    playTimeline(handle: number, startMs: number = 0): boolean {
+        this.stopCurrentEffect();
+        this.hueLightControl.sendToDevice();
+        return this.hueWrapper.playTimeline(handle, startMs);
+    }
+
+    unloadTimeline(handle: number): boolean {
+        return this.hueWrapper.unloadTimeline(handle);
+    }
+
+    /**
+     * Play a playlist of native effects, timelines and scenes, switched and
+     * crossfaded on the render thread. Effect and scene steps without
+     * lightIds play on the segments.
+     */
+    playSequence(steps: HueSequenceStep[], options: SequenceOptions = {}): boolean {
+        const nativeSteps = steps.map((step) => ('timeline' in step
+            ? step
+            : { ...step, lightIds: step.lightIds ?? this.hueLightControl.segments })) as SequenceStep[];
+        this.stopCurrentEffect();
+        this.hueLightControl.sendToDevice();
+        return this.hueWrapper.playSequence(nativeSteps, options);
+    }
+
+    /**
+     * Whole frame, one entry per light id, in a single native call
+     */
+    setFrame(lightIds: Int32Array | number[], data: Float32Array | Uint8Array, format: FrameFormat): boolean {
+        return this.hueWrapper.setFrame(lightIds, data, format);
+    }
+
+    /**
+     * Fade one light to color over durationMs; the render thread fills in
+     * the ticks between, so sparse keyframes still come out smooth
+     */
+    setLightTransition(lightId: number, color: Color & { a?: number }, durationMs: number,
+                       easing: TimelineEasing = 'linear'): boolean {
+        return this.hueWrapper.setLightTransition(lightId, color, durationMs, easing);
+    }
+
+    /**
+     * Batch variant of setLightTransition, laid out like setFrame
+     */
+    setLightTransitions(lightIds: Int32Array | number[], data: Float32Array | Uint8Array, format: FrameFormat,
+                        durationMs: number, easing: TimelineEasing = 'linear'): boolean {
+        return this.hueWrapper.setLightTransitions(lightIds, data, format, durationMs, easing);
+    }
+
+    /**
+     * Apply the frames other threads post to port with postFrame(). Lets one
+     * worker own the stream while producers run elsewhere. Returns a function
+     * that stops listening.
+     */
+    acceptFrames(port: Pick<FramePort, 'on' | 'off'>): () => void {
+        const listener = (value: unknown) => {
+            const frame = value as FrameMessage;
+            if (!frame || frame.type !== 'hue-frame') {
+                return;
+            }
+            try {
+                if (frame.layer !== undefined) {
+                    this.hueWrapper.setLayerFrame(frame.layer, frame.lightIds, frame.data, frame.format);
+                } else {
+                    this.hueWrapper.setFrame(frame.lightIds, frame.data, frame.format);
+                }
+            } catch (error) {
+                if (this.debugLogEnabled) {
+                    console.log('Dropped posted frame:', error);
+                }
+            }
+        };
+        port.on('message', listener);
+        return () => { port.off('message', listener); };
+    }
+
+    /**
+     * Named layer composited natively above effects and manual colors.
+     * Layers update independently; false if the name is taken.
+     */
+    createLayer(name: string, options: LayerOptions = {}): boolean {
+        return this.hueWrapper.createLayer(name, options);
+    }
+
+    setLayerOptions(name: string, options: LayerOptions): boolean {
+        return this.hueWrapper.setLayerOptions(name, options);
+    }
+
+    /**
+     * One color for every segment, or one per segment; alpha (0-1) makes
+     * lights partly or fully transparent on this layer
+     */
+    setLayerColors(name: string, colors: Color | Color[]): boolean {
+        const segments = this.hueLightControl.segments;
+        const data = new Float32Array(segments.length * 4);
+        segments.forEach((segId, index) => {
+            const color = Array.isArray(colors) ? colors[index] ?? colors[colors.length - 1] : colors;
+            data.set([color.r, color.g, color.b, color.alpha ?? 1], index * 4);
+        });
+        return this.hueWrapper.setLayerFrame(name, Int32Array.from(segments), data, 'rgba');
+    }
+
+    /**
+     * Color every light from a spatial field evaluated natively at its
+     * position in the entertainment area, whatever the group's size
+     */
+    setField(field: SpatialField, timeMs: number, layer?: string): boolean {
+        return this.hueWrapper.setField(field, timeMs, layer);
+    }
+
+    lightPositions(): LightPositions {
+        return this.hueWrapper.getLightPositions();
+    }
+
+    clearLayer(name: string): boolean {
+        return this.hueWrapper.clearLayer(name);
+    }
+
+    removeLayer(name: string): boolean {
+        return this.hueWrapper.removeLayer(name);
+    }
+
+    /**
+     * Render frames another process writes to a shared-memory ring; they
+     * reach the render thread without passing through JS
+     */
+    attachSharedFrames(name: string, lightIds: number[]): boolean {
+        return this.hueWrapper.attachSharedFrames(name, lightIds);
+    }
+
+    detachSharedFrames(): boolean {
+        return this.hueWrapper.detachSharedFrames();
+    }
+
+    /**
+     * Scrub the running native effect or timeline to timeMs since its start
+     */
+    seek(timeMs: number): boolean {
+        return this.hueWrapper.seekEffect(timeMs);
+    }
+
+    /**
+     * Streaming counters and latency histograms (setter rate, mixer lock,
+     * frame timing, setter-to-frame latency); cheap enough to poll every second
+     */
+    getStats(): HueStats | null {
+        return this.hueWrapper.getStats();
+    }
+
+    /**
+     * Stream at a fixed 60Hz, or adaptively: a few keep-alive frames per
+     * second while nothing changes, back to 60Hz on the next change
+     */
+    setRatePolicy(policy: Partial<RatePolicy>): boolean {
+        return this.hueWrapper.setRatePolicy(policy);
+    }
+
+    /**
+     * Correct each light's colors for its gamut (A, B or C, from the model
+     * id) before they are sent. Off by default.
+     */
+    setOutputCorrection(correction: Partial<OutputCorrection>): boolean {
+        return this.hueWrapper.setOutputCorrection(correction);
+    }
+
+    outputCorrection(): OutputCorrectionState {
+        return this.hueWrapper.getOutputCorrection();
+    }
+
+    /**
+     * How the last connection used the warm start cache, and the startup
+     * time it saved
+     */
+    warmStart(): WarmStartReport {
+        return this.hueWrapper.getWarmStart();
+    }
+
+    /**
+     * Listen for connection and stream state changes ('lost' when the stream
+     * drops, 'reconnected' when it is back) instead of polling getStatus().
+     * Replaces any previous listener; returns a function that removes it.
+     */
+    onStateChange(listener: StateCallback): () => void {
+        const token = ++this.stateListenerToken;
+        this.hueWrapper.setStateCallback(listener);
+        return () => {
+            if (this.stateListenerToken === token) {
+                this.hueWrapper.clearStateCallback();
+            }
+        };
+    }
+
+    /**
+     * Frames recorded by the simulated backend since sinceSeq
+     * (null when streaming to a real bridge)
+     */
+    capturedFrames(sinceSeq: number = 0): CapturedFrames | null {
+        return this.hueWrapper.getCapturedFrames(sinceSeq);
+    }
+
+    /**
+     * Record everything sent to the bridge into a compact binary file, for
+     * regression tests and reruns; stopCapture() returns the totals
+     */
+    startCapture(path: string): boolean {
+        return this.hueWrapper.startCapture(path);
+    }
+
+    stopCapture(): CaptureSummary | null {
+        return this.hueWrapper.stopCapture();
+    }
+
+    /**
+     * Play a capture back natively with its original timing
+     */
+    startReplay(path: string, loop: boolean = false): boolean {
+        return this.hueWrapper.startReplay(path, { loop });
+    }
+
+    stopReplay(): boolean {
+        return this.hueWrapper.stopReplay();
     }
 
     clearAllLights(): void {
@@ -93,33 +428,62 @@ export class Hue {
         this.hueLightControl.sendToDevice();
     }
 
-    private startUpdateLoop(updateFunc: (elapsed: number) => void): void {
+    // Native effects are computed on the EDK render thread; JS only starts them
+    private startNativeEffect(name: NativeEffectName, params: NativeEffectParams): void {
         this.stopCurrentEffect();
+        this.hueLightControl.sendToDevice();
+        this.hueWrapper.startEffect(name, params, this.hueLightControl.segments);
+    }
+
+    // Runs updateFunc once per render tick from the native frame clock, with
+    // elapsed taken from the tick time, so every sent frame is computed
+    // exactly once. Falls back to a 16 ms timer before initialize(). layers
+    // are created first and removed when the effect stops.
+    private startUpdateLoop(updateFunc: (elapsed: number) => void,
+                            layers: Record<string, LayerOptions> = {}): void {
+        this.stopCurrentEffect();
+        for (const [name, options] of Object.entries(layers)) {
+            try {
+                this.hueWrapper.removeLayer(name);
+                this.hueWrapper.createLayer(name, options);
+                this.effectLayers.push(name);
+            } catch {
+                // Not streaming yet: the update function's layer calls fail the same way
+            }
+        }
         this.effectRunning = true;
-        this.effectStartTime = Date.now();
+        // Same monotonic clock as the frame clock's timeMs
+        this.effectStartTime = Number(process.hrtime.bigint()) / 1e6;
 
-        const update = () => {
+        const update = (timeMs: number) => {
             if (!this.effectRunning) {
-                if (this.updateInterval) {
-                    clearInterval(this.updateInterval);
-                    this.updateInterval = null;
-                }
                 return;
             }
-            const elapsed = Date.now() - this.effectStartTime;
-            updateFunc(elapsed);
+            updateFunc(Math.max(timeMs - this.effectStartTime, 0));
             this.hueLightControl.sendToDevice();
         };
 
-        update();
-        this.updateInterval = setInterval(update, 16);
+        update(this.effectStartTime);
+        if (!this.effectRunning) {
+            return;
+        }
+        try {
+            this.frameClockRunning = this.hueWrapper.setFrameCallback((frame, timeMs) => update(timeMs));
+        } catch {
+            this.updateInterval = setInterval(() => update(Number(process.hrtime.bigint()) / 1e6), 16);
+        }
     }
 
     percentageBar(percentage: number): void {
         const level = percentage / 100;
-        this.hueLightControl.segments.forEach((segId, index) => {
+        const segments = this.hueLightControl.segments;
+        // Spread of +-0.15 around level from the first to the last segment,
+        // whatever the group size
+        const center = (segments.length - 1) / 2;
+        const reach = Math.max(center, 1);
+        segments.forEach((segId, index) => {
             const segmentLevel = Math.max(0, Math.min(1,
-                level + (index - 1.5) * 0.1
+                level + (index - center) / reach * 0.15
             ));
 
             let color;
@@ -141,125 +505,27 @@ export class Hue {
     }
 
     gradientWave(color1: Color, color2: Color, duration: number = 2000, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const phase = (elapsed % duration) / duration;
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const wavePos = (index / Math.max(1, this.hueLightControl.segments.length - 1) + phase) % 1;
-                const color = interpolateColor(color1, color2, wavePos);
-                this.hueLightControl.setSegmentColor(segId, color);
-            });
-        });
+        this.startNativeEffect('gradientWave', { colors: [color1, color2], period: duration, runTime });
     }
 
     rippleGradient(color: Color, duration: number = 1000, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const ripplePhase = (elapsed % duration) / duration;
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const distance = Math.abs(index - 1.5) / 1.5;
-                const brightness = Math.max(0, 1 - Math.abs(ripplePhase - distance));
-                const dimmedColor = {
-                    r: Math.round(color.r * brightness),
-                    g: Math.round(color.g * brightness),
-                    b: Math.round(color.b * brightness)
-                };
-                this.hueLightControl.setSegmentColor(segId, dimmedColor);
-            });
-        });
+        this.startNativeEffect('rippleGradient', { colors: [color], period: duration, runTime });
     }
 
     breathingGradient(color1: Color, color2: Color, period: number = 3000, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const phase = (elapsed % period) / period;
-            const brightness = 0.3 + 0.7 * (Math.sin(phase * Math.PI * 2) * 0.5 + 0.5);
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const gradPos = index / Math.max(1, this.hueLightControl.segments.length - 1);
-                const color = interpolateColor(color1, color2, gradPos);
-                const dimmedColor = {
-                    r: Math.round(color.r * brightness),
-                    g: Math.round(color.g * brightness),
-                    b: Math.round(color.b * brightness)
-                };
-                this.hueLightControl.setSegmentColor(segId, dimmedColor);
-            });
-        });
+        this.startNativeEffect('breathingGradient', { colors: [color1, color2], period, runTime });
     }
 
     chaseGradient(color: Color, speed: number = 500, runTime: number = 0): void {
-        const endTime = runTime > 0 ? this.effectStartTime + runTime : Infinity;
-        let position = 0;
-
-        this.startUpdateLoop((_elapsed) => {
-            if (Date.now() > endTime) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const distance = Math.min(
-                    Math.abs(index - position),
-                    Math.abs(index - position + 4),
-                    Math.abs(index - position - 4)
-                );
-                const brightness = Math.max(0, 1 - (distance * 0.4));
-                const dimmedColor = {
-                    r: Math.round(color.r * brightness),
-                    g: Math.round(color.g * brightness),
-                    b: Math.round(color.b * brightness)
-                };
-                this.hueLightControl.setSegmentColor(segId, dimmedColor);
-            });
-
-            position = (position + (speed / 1000)) % 4;
-        });
+        this.startNativeEffect('chaseGradient', { colors: [color], rate: speed, runTime });
     }
 
     rainbowWave(speed: number = 2000, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const hueShift = (elapsed % speed) / speed;
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const hue_value = (hueShift + index * 0.25) % 1;
-                const color = hsvToRgb(hue_value, 1, 1);
-                this.hueLightControl.setSegmentColor(segId, color);
-            });
-        });
+        this.startNativeEffect('rainbowWave', { period: speed, runTime });
     }
 
     pulseWave(color1: Color, color2: Color, speed: number = 1000, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const phase = (elapsed % speed) / speed;
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const segPhase = (phase + index * 0.25) % 1;
-                const pulseFactor = Math.sin(segPhase * Math.PI) ** 2;
-                const color = interpolateColor(color1, color2, pulseFactor);
-                this.hueLightControl.setSegmentColor(segId, color);
-            });
-        });
+        this.startNativeEffect('pulseWave', { colors: [color1, color2], period: speed, runTime });
     }
 
     countdownPulse(totalSeconds: number): void {
@@ -267,46 +533,8 @@ export class Hue {
     }
 
     countdownPulseWithColors(totalSeconds: number, startColor: Color = COLORS.darkRed, endColor: Color = COLORS.brightGreen): void {
-        const totalMs = totalSeconds * 1000;
-        const midColor = { r: 255, g: 200, b: 0 }; // Yellow/orange transition color
-
-        this.startUpdateLoop((elapsed) => {
-            if (elapsed > totalMs) {
-                this.stopCurrentEffect();
-                this.hueLightControl.setAllSegments(COLORS.white);
-                this.hueLightControl.sendToDevice();
-
-                setTimeout(() => {
-                    this.hueLightControl.setAllSegments(endColor);
-                    this.hueLightControl.sendToDevice();
-                }, 200);
-                return;
-            }
-
-            const timeLeft = 1 - (elapsed / totalMs);
-            const pulseSpeed = 2000 * timeLeft + 200;
-            const phase = (elapsed % pulseSpeed) / pulseSpeed;
-            const brightness = 0.2 + 0.8 * Math.sin(phase * Math.PI);
-
-            let color;
-            if (timeLeft > 0.66) {
-                // First third: use start color
-                color = startColor;
-            } else if (timeLeft > 0.33) {
-                // Middle third: interpolate from start color to mid color
-                color = interpolateColor(startColor, midColor, (0.66 - timeLeft) * 3);
-            } else {
-                // Final third: interpolate from mid color to end color
-                color = interpolateColor(midColor, endColor, (0.33 - timeLeft) * 3);
-            }
-
-            const dimmedColor = {
-                r: Math.round(color.r * brightness),
-                g: Math.round(color.g * brightness),
-                b: Math.round(color.b * brightness)
-            };
-            this.hueLightControl.setAllSegments(dimmedColor);
-        });
+        // Ends with a 200ms white flash, then holds endColor
+        this.startNativeEffect('countdownPulse', { colors: [startColor, endColor], period: totalSeconds * 1000 });
     }
 
     segmentedCountdownPulse(totalSeconds: number): void {
@@ -325,172 +553,34 @@ export class Hue {
         seg1StartColor: Color, seg1EndColor: Color,
         seg2StartColor: Color, seg2EndColor: Color
     ): void {
-        const totalMs = totalSeconds * 1000;
-        const midColor = { r: 255, g: 200, b: 0 }; // Yellow/orange transition color
-
-        // Store segment colors in an array for easier access
-        const segmentConfigs = [
-            { start: seg0StartColor, end: seg0EndColor },
-            { start: seg1StartColor, end: seg1EndColor },
-            { start: seg2StartColor, end: seg2EndColor }
-        ];
-
-        this.startUpdateLoop((elapsed) => {
-            if (elapsed > totalMs) {
-                this.stopCurrentEffect();
-
-                // Flash white on all segments
-                this.hueLightControl.setAllSegments(COLORS.white);
-                this.hueLightControl.sendToDevice();
-
-                // After 200ms, show each segment's end color
-                setTimeout(() => {
-                    segmentConfigs.forEach((config, index) => {
-                        this.hueLightControl.setSegmentColor(index, config.end);
-                    });
-                    this.hueLightControl.sendToDevice();
-                }, 200);
-                return;
-            }
-
-            const timeLeft = 1 - (elapsed / totalMs);
-
-            // Process each segment independently
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const config = segmentConfigs[index];
-                if (!config) {
-                    return;
-                }
-
-                // Add phase offset for each segment to create variety
-                const phaseOffset = (index * 0.33) * Math.PI;
-                const pulseSpeed = 2000 * timeLeft + 200;
-                const phase = ((elapsed % pulseSpeed) / pulseSpeed) + phaseOffset;
-                const brightness = 0.2 + 0.8 * Math.sin(phase * Math.PI);
-
-                let color;
-                if (timeLeft > 0.66) {
-                    // First third: use start color
-                    color = config.start;
-                } else if (timeLeft > 0.33) {
-                    // Middle third: interpolate from start color to mid color
-                    color = interpolateColor(config.start, midColor, (0.66 - timeLeft) * 3);
-                } else {
-                    // Final third: interpolate from mid color to end color
-                    color = interpolateColor(midColor, config.end, (0.33 - timeLeft) * 3);
-                }
-
-                const dimmedColor = {
-                    r: Math.round(color.r * brightness),
-                    g: Math.round(color.g * brightness),
-                    b: Math.round(color.b * brightness)
-                };
-
-                this.hueLightControl.setSegmentColor(segId, dimmedColor);
-            });
+        // Start/end color pairs per segment; ends with a 200ms white flash
+        this.startNativeEffect('segmentedCountdownPulse', {
+            colors: [
+                seg0StartColor, seg0EndColor,
+                seg1StartColor, seg1EndColor,
+                seg2StartColor, seg2EndColor
+            ],
+            period: totalSeconds * 1000
         });
     }
 
     flashColor(color: Color, duration: number = 500): void {
-        const steps = Math.floor(duration / 16);
-        let step = 0;
-
-        this.startUpdateLoop((_elapsed) => {
-            if (step >= steps) {
-                this.stopCurrentEffect();
-                this.hueLightControl.clearAllSegments();
-                this.hueLightControl.sendToDevice();
-                return;
-            }
-
-            const factor = 1 - (step / steps);
-            const brightness = factor ** 2;
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const segmentFactor = Math.max(0, brightness - (index * 0.1));
-                const dimmedColor = {
-                    r: Math.round(color.r * segmentFactor),
-                    g: Math.round(color.g * segmentFactor),
-                    b: Math.round(color.b * segmentFactor)
-                };
-                this.hueLightControl.setSegmentColor(segId, dimmedColor);
-            });
-
-            step++;
-        });
+        this.startNativeEffect('flashColor', { colors: [color], period: duration });
     }
 
     bouncingWave(color1: Color, color2: Color, speed: number = 2000, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                this.hueLightControl.clearAllSegments();
-                this.hueLightControl.sendToDevice();
-                return;
-            }
-
-            const cyclePosition = (elapsed % speed) / speed;
-            let activeSegment;
-            if (cyclePosition < 0.5) {
-                activeSegment = Math.floor(cyclePosition * 8) % 4;
-            } else {
-                activeSegment = 3 - Math.floor((cyclePosition - 0.5) * 8) % 4;
-            }
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                if (index === activeSegment) {
-                    const colorFactor = index / Math.max(1, this.hueLightControl.segments.length - 1);
-                    const color = interpolateColor(color1, color2, colorFactor);
-                    this.hueLightControl.setSegmentColor(segId, color);
-                } else {
-                    this.hueLightControl.clearSegment(segId);
-                }
-            });
-        });
+        this.startNativeEffect('bouncingWave', { colors: [color1, color2], period: speed, runTime });
     }
 
     pulsingBounce(color1: Color, color2: Color, bounceSpeed: number = 2000, pulseSpeed: number = 500, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                this.hueLightControl.clearAllSegments();
-                this.hueLightControl.sendToDevice();
-                return;
-            }
-
-            const cyclePosition = (elapsed % bounceSpeed) / bounceSpeed;
-            const pulsePhase = (elapsed % pulseSpeed) / pulseSpeed;
-            const brightness = 0.5 + 0.5 * Math.sin(pulsePhase * Math.PI * 2);
-
-            let activeSegment;
-            if (cyclePosition < 0.5) {
-                activeSegment = Math.floor(cyclePosition * 8) % 4;
-            } else {
-                activeSegment = 3 - Math.floor((cyclePosition - 0.5) * 8) % 4;
-            }
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                if (index === activeSegment) {
-                    const colorFactor = index / Math.max(1, this.hueLightControl.segments.length - 1);
-                    const color = interpolateColor(color1, color2, colorFactor);
-                    const dimmedColor = {
-                        r: Math.round(color.r * brightness),
-                        g: Math.round(color.g * brightness),
-                        b: Math.round(color.b * brightness)
-                    };
-                    this.hueLightControl.setSegmentColor(segId, dimmedColor);
-                } else {
-                    this.hueLightControl.clearSegment(segId);
-                }
-            });
-        });
+        this.startNativeEffect('bouncingWave', { colors: [color1, color2], period: bounceSpeed, rate: pulseSpeed, runTime });
     }
 
     fadeBounce(color1: Color, color2: Color, speed: number = 2000, runTime: number = 0): void {
         const trailBrightness: number[] = [0, 0, 0, 0];
 
         this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
+            if (runTime > 0 && elapsed > runTime) {
                 this.stopCurrentEffect();
                 this.hueLightControl.clearAllSegments();
                 this.hueLightControl.sendToDevice();
@@ -526,56 +616,7 @@ export class Hue {
     }
 
     doubleBounce(color1: Color, color2: Color, speed: number = 2000, runTime: number = 0): void {
-        this.startUpdateLoop((elapsed) => {
-            if (runTime > 0 && Date.now() > this.effectStartTime + runTime) {
-                this.stopCurrentEffect();
-                this.hueLightControl.clearAllSegments();
-                this.hueLightControl.sendToDevice();
-                return;
-            }
-
-            const cyclePosition = (elapsed % speed) / speed;
-
-            let wave1Segment;
-            if (cyclePosition < 0.5) {
-                wave1Segment = Math.floor(cyclePosition * 8) % 4;
-            } else {
-                wave1Segment = 3 - Math.floor((cyclePosition - 0.5) * 8) % 4;
-            }
-
-            let wave2Segment;
-            if (cyclePosition < 0.5) {
-                wave2Segment = 3 - Math.floor(cyclePosition * 8) % 4;
-            } else {
-                wave2Segment = Math.floor((cyclePosition - 0.5) * 8) % 4;
-            }
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                let brightness = 0;
-                let useColor1 = false;
-
-                if (index === wave1Segment) {
-                    brightness = 1.0;
-                    useColor1 = true;
-                }
-                if (index === wave2Segment) {
-                    brightness = Math.max(brightness, 0.8);
-                    useColor1 = false;
-                }
-
-                if (brightness > 0) {
-                    const color = useColor1 ? color1 : color2;
-                    const dimmedColor = {
-                        r: Math.round(color.r * brightness),
-                        g: Math.round(color.g * brightness),
-                        b: Math.round(color.b * brightness)
-                    };
-                    this.hueLightControl.setSegmentColor(segId, dimmedColor);
-                } else {
-                    this.hueLightControl.clearSegment(segId);
-                }
-            });
-        });
+        this.startNativeEffect('doubleBounce', { colors: [color1, color2], period: speed, runTime });
     }
 
     flashingColorSequence(colorSequence: Color[], flashCount: number = 6, flashSpeed: number = 150): void {
@@ -611,27 +652,8 @@ export class Hue {
     }
 
     fadeToBlack(): void {
-        const steps = 60;
-        let step = 0;
-
-        this.startUpdateLoop((_elapsed) => {
-            if (step >= steps) {
-                this.stopCurrentEffect();
-                this.hueLightControl.clearAllSegments();
-                this.hueLightControl.sendToDevice();
-                return;
-            }
-
-            const factor = 1 - (step / steps);
-            const color = COLORS.bloodRed;
-            const dimmedColor = {
-                r: Math.round(color.r * factor),
-                g: Math.round(color.g * factor),
-                b: Math.round(color.b * factor)
-            };
-            this.hueLightControl.setAllSegments(dimmedColor);
-            step++;
-        });
+        // 60 steps of 16ms
+        this.startNativeEffect('fadeToBlack', { colors: [COLORS.bloodRed], period: 960 });
     }
 
     /**
@@ -680,29 +702,7 @@ export class Hue {
      * @param strobeSpeed - Speed of each on/off cycle in milliseconds (default 50ms = 20Hz)
      */
     strobeLight(color: Color, duration: number = 1000, strobeSpeed: number = 50): void {
-        let isOn = false;
-        let lastToggle = 0;
-
-        this.startUpdateLoop((elapsed) => {
-            if (elapsed >= duration) {
-                this.stopCurrentEffect();
-                this.hueLightControl.clearAllSegments();  // End in OFF
-                this.hueLightControl.sendToDevice();
-                return;
-            }
-
-            if (elapsed - lastToggle >= strobeSpeed) {
-                if (!isOn) {
-                    this.hueLightControl.setAllSegments(color);
-                    isOn = true;
-                } else {
-                    this.hueLightControl.clearAllSegments();
-                    isOn = false;
-                }
-                this.hueLightControl.sendToDevice();
-                lastToggle = elapsed;
-            }
-        });
+        this.startNativeEffect('strobeLight', { colors: [color], period: duration, rate: strobeSpeed });
     }
 
     randomColorSequence(duration: number = 3000): void {
@@ -774,8 +774,16 @@ export class Hue {
     }
 
     explosionFlashRipple(baseColor: Color = COLORS.orange, flashColor: Color = COLORS.white, duration: number = 2000): void {
-        // Explosion that ripples outward from center
-        const waveSpeed = duration / 4;  // Time for wave to travel across all segments
+        // Explosion that ripples outward from the middle of the room, blending
+        // flash over base color and fading out; the ring crosses the area in
+        // about half the duration
+        const field: SpatialField = {
+            type: 'burst',
+            colors: [baseColor, flashColor],
+            speed: 3000 / duration,
+            width: 0.7,
+            duration,
+        };
 
         this.startUpdateLoop((elapsed) => {
             if (elapsed > duration) {
@@ -784,32 +792,11 @@ export class Hue {
                 this.hueLightControl.sendToDevice();
                 return;
             }
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                // Calculate distance-based delay for ripple effect
-                const distanceFromCenter = Math.abs(index - 1.5);
-                const wavePosition = elapsed / waveSpeed;
-                const segmentIntensity = Math.max(0, 1 - Math.abs(wavePosition - distanceFromCenter));
-
-                // Apply exponential decay over time
-                const timeDecay = Math.pow(1 - (elapsed / duration), 2);
-                const alpha = segmentIntensity * timeDecay;
-
-                if (alpha > 0.01) {
-                    // Blend flash with base color using alpha
-                    const color: Color = {
-                        r: flashColor.r,
-                        g: flashColor.g,
-                        b: flashColor.b,
-                        alpha: alpha
-                    };
-                    this.hueLightControl.setSegmentColor(segId, color);
-                } else {
-                    this.hueLightControl.setSegmentColor(segId, baseColor);
-                }
-            });
-
-            this.hueLightControl.sendToDevice();
+            try {
+                this.hueWrapper.setField(field, elapsed);
+            } catch {
+                // Not streaming
+            }
         });
     }
 
@@ -935,51 +922,42 @@ export class Hue {
      * Creates complex color patterns using transparency
      */
     multiLayerAlphaBlend(duration: number = 3000): void {
-        // Base layer: warm orange
+        const segments = this.hueLightControl.segments;
+        const ids = Int32Array.from(segments);
+        const blue = new Float32Array(segments.length * 3);
+        const sweep = new Float32Array(segments.length * 4);
+        for (let i = 0; i < segments.length; i++) {
+            blue.set([COLORS.blue.r, COLORS.blue.g, COLORS.blue.b], i * 3);
+            sweep.set([255, 255, 255, 0], i * 4);
+        }
+
+        // Base: warm orange on the manual layer, composited natively below both overlays
         this.hueLightControl.setAllSegments(COLORS.orange);
 
         this.startUpdateLoop((elapsed) => {
             if (elapsed > duration) {
                 this.stopCurrentEffect();
-                this.hueLightControl.setAllSegments(COLORS.orange);
-                this.hueLightControl.sendToDevice();
                 return;
             }
+            if (this.effectLayers.length === 0) {
+                return;  // not streaming
+            }
+            if (elapsed === 0) {
+                this.hueWrapper.setLayerFrame('pulse', ids, blue, 'rgb');
+            }
 
-            // Layer 1: Pulsing blue overlay
+            // Layer 1: pulsing blue overlay, only its opacity changes (max 50%)
             const pulse1 = Math.sin(elapsed * 0.003) * 0.5 + 0.5;
-            const blueOverlay: Color = {
-                r: COLORS.blue.r,
-                g: COLORS.blue.g,
-                b: COLORS.blue.b,
-                alpha: pulse1 * 0.5  // Max 50% opacity
-            };
+            this.hueWrapper.setLayerOptions('pulse', { opacity: pulse1 * 0.5 });
 
-            // Layer 2: Sweeping white highlight
+            // Layer 2: sweeping white highlight with distance-based alpha
             const sweepPosition = (elapsed % 1500) / 1500;
-
-            this.hueLightControl.segments.forEach((segId, index) => {
-                const segmentPosition = index / this.hueLightControl.segments.length;
-                const distance = Math.abs(segmentPosition - sweepPosition);
-
-                if (distance < 0.3) {
-                    // White highlight with distance-based alpha
-                    const alpha = (0.3 - distance) / 0.3 * 0.7;
-                    const whiteHighlight: Color = {
-                        r: 255,
-                        g: 255,
-                        b: 255,
-                        alpha: alpha
-                    };
-                    this.hueLightControl.setSegmentColor(segId, whiteHighlight);
-                } else {
-                    // Blue pulse layer
-                    this.hueLightControl.setSegmentColor(segId, blueOverlay);
-                }
+            segments.forEach((segId, index) => {
+                const distance = Math.abs(index / segments.length - sweepPosition);
+                sweep[index * 4 + 3] = distance < 0.3 ? (0.3 - distance) / 0.3 * 0.7 : 0;
             });
-
-            this.hueLightControl.sendToDevice();
-        });
+            this.hueWrapper.setLayerFrame('sweep', ids, sweep, 'rgba');
+        }, { pulse: { priority: 0 }, sweep: { priority: 1 } });
     }
 
     /**
@@ -1185,32 +1163,7 @@ export class Hue {
      * Creates an outward expanding wave
      */
     shockwave(color: Color, duration: number = 1500): void {
-        this.startUpdateLoop((elapsed) => {
-            if (elapsed > duration) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const progress = elapsed / duration;
-            const wavePosition = progress * (this.hueLightControl.segments.length + 1);
-
-            this.hueLightControl.segments.forEach((segmentId, index) => {
-                const distance = Math.abs(index - wavePosition);
-                let intensity = 0;
-
-                if (distance < 1) {
-                    // Wave is at this segment
-                    intensity = 1 - distance;
-                    intensity *= (1 - progress); // Fade as it expands
-                }
-
-                this.hueLightControl.setSegmentColor(segmentId, {
-                    r: color.r * intensity,
-                    g: color.g * intensity,
-                    b: color.b * intensity
-                });
-            });
-        });
+        this.startNativeEffect('shockwave', { colors: [color], period: duration });
     }
 
     /**
@@ -1218,35 +1171,7 @@ export class Hue {
      * Instant powerful flash effect
      */
     energyBurst(color: Color, duration: number = 800): void {
-        this.startUpdateLoop((elapsed) => {
-            if (elapsed > duration) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const progress = elapsed / duration;
-            let intensity = 0;
-
-            if (progress < 0.1) {
-                // Instant bright flash
-                intensity = 1;
-            } else if (progress < 0.3) {
-                // Hold bright briefly
-                intensity = 0.9;
-            } else {
-                // Rapid fade out
-                intensity = Math.max(0, 1 - ((progress - 0.3) / 0.7) * 1.5);
-            }
-
-            // Add slight over-brightness for burst effect
-            const burstMultiplier = progress < 0.1 ? 1.3 : 1;
-
-            this.hueLightControl.setAllSegments({
-                r: Math.min(255, color.r * intensity * burstMultiplier),
-                g: Math.min(255, color.g * intensity * burstMultiplier),
-                b: Math.min(255, color.b * intensity * burstMultiplier)
-            });
-        });
+        this.startNativeEffect('energyBurst', { colors: [color], period: duration });
     }
 
     /**
@@ -1254,31 +1179,7 @@ export class Hue {
      * Creates a spinning vortex effect
      */
     spiralVortex(color1: Color, color2: Color, duration: number = 2000): void {
-        this.startUpdateLoop((elapsed) => {
-            if (elapsed > duration) {
-                this.stopCurrentEffect();
-                return;
-            }
-
-            const rotationSpeed = 3; // Rotations per duration
-            const rotation = (elapsed / duration) * rotationSpeed * Math.PI * 2;
-
-            this.hueLightControl.segments.forEach((segmentId, index) => {
-                const angle = rotation + (index * Math.PI * 2 / this.hueLightControl.segments.length);
-                const intensity = (Math.sin(angle) + 1) / 2;
-
-                const color = interpolateColor(color1, color2, intensity);
-
-                // Add vortex depth effect
-                const depthFactor = Math.sin(elapsed * 0.003) * 0.3 + 0.7;
-
-                this.hueLightControl.setSegmentColor(segmentId, {
-                    r: color.r * depthFactor,
-                    g: color.g * depthFactor,
-                    b: color.b * depthFactor
-                });
-            });
-        });
+        this.startNativeEffect('spiralVortex', { colors: [color1, color2], period: duration });
     }
 
     /**
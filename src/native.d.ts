@@ -24,14 +24,266 @@ export interface BridgeStatus {
     streaming: boolean;
   };
 }
+// Per-light channel layout for setFrame():
+//   rgb  - r, g, b (0-255)
+//   rgba - r, g, b (0-255), alpha (0-1; 0-255 when sent as Uint8Array)
+//   xy   - x, y, brightness (0-1), Float32Array only
+//   ct   - mireds, brightness (0-1), Float32Array only
+export type FrameFormat = 'rgb' | 'rgba' | 'xy' | 'ct';
+// Named layers are composited natively above the native effect. Each layer
+// blends with what is below it (add, multiply and max per channel), then is
+// drawn over it with its per-light alpha times opacity.
+export type BlendMode = 'normal' | 'add' | 'multiply' | 'max';
+export interface LayerOptions {
+  // Higher priorities are drawn on top (default 0)
+  priority?: number;
+  // 0-1 (default 1)
+  opacity?: number;
+  blend?: BlendMode;
+}
+export interface LayerInfo extends Required<LayerOptions> {
+  name: string;
+}
+// Effects implemented natively and evaluated on the EDK render thread
+export type NativeEffectName =
+  | 'gradientWave' | 'rippleGradient' | 'breathingGradient' | 'chaseGradient'
+  | 'rainbowWave' | 'pulseWave' | 'countdownPulse' | 'segmentedCountdownPulse'
+  | 'flashColor' | 'fadeToBlack' | 'bouncingWave' | 'doubleBounce'
+  | 'strobeLight' | 'spiralVortex' | 'shockwave' | 'energyBurst';
+export interface NativeEffectParams {
+  colors?: { r: number; g: number; b: number }[];  // effect palette (0-255)
+  period?: number;   // cycle / total duration in ms
+  rate?: number;     // secondary timing (pulse or strobe speed)
+  runTime?: number;  // total run time in ms, 0 = until stopped
+}
+// Spatial fields, evaluated natively at each light's entertainment-area
+// position (x, y, z about -1 to 1). The field's 0-1 value picks a color along
+// colors; one color fades up from black. transparent instead uses the last
+// color with the value as alpha.
+//   radial   rings moving out from center at speed, wavelength apart
+//   sweep    a band of half-width width crossing the lights along direction
+//   falloff  1 at center, 0 at radius
+//   burst    one ring of half-width width expanding at speed, fading over duration ms
+export interface SpatialField {
+  type: 'radial' | 'sweep' | 'falloff' | 'burst';
+  colors?: { r: number; g: number; b: number }[];
+  center?: { x: number; y: number; z?: number };
+  direction?: { x: number; y: number; z?: number };
+  speed?: number;       // area units per second, default 1
+  wavelength?: number;  // default 1
+  width?: number;       // default 0.5
+  radius?: number;      // default 1
+  duration?: number;    // default 0, no fade
+  transparent?: boolean;
+}
+// The group's lights in slot order
+export interface LightPositions {
+  ids: string[];
+  x: Float32Array;
+  y: Float32Array;
+  z: Float32Array;
+}
+// Keyframe timelines: per-light tracks compiled natively and evaluated on the
+// render thread. easing shapes the transition toward the next keyframe.
+export type TimelineEasing = 'linear' | 'step' | 'easeIn' | 'easeOut' | 'easeInOut';
+export interface TimelineKeyframe {
+  t: number;  // ms from the start of the timeline
+  color: { r: number; g: number; b: number };  // 0-255
+  easing?: TimelineEasing;  // default 'linear'
+}
+export interface TimelineDefinition {
+  duration?: number;  // ms, defaults to the last keyframe
+  loop?: boolean;
+  tracks: { lightId: number; keyframes: TimelineKeyframe[] }[];
+}
+// A definition, its JSON text, or the binary form produced by encodeTimeline()
+export type TimelineSource = TimelineDefinition | string | Uint8Array | ArrayBuffer;
+// Sequences: a playlist of effects, timelines and static scenes switched on
+// the render thread. Each step takes over at its offset, blending in from
+// what was showing over crossfade ms; lights it does not cover keep their
+// colors. Effect and scene steps name their lights, timelines bring theirs.
+export type SequenceStep = {
+  at: number;          // ms from the start of the sequence
+  crossfade?: number;  // ms, default 0 (cut)
+  easing?: TimelineEasing;  // crossfade shape, default 'linear'
+} & (
+  | { effect: NativeEffectName; params?: NativeEffectParams; lightIds: number[] }
+  | { timeline: number }  // handle from loadTimeline()
+  | { scene: { r: number; g: number; b: number }[]; lightIds: number[] }  // one color per light, last repeats
+);
+export interface SequenceOptions {
+  duration?: number;  // ms; default ends after the last step finishes
+  loop?: boolean;     // needs a duration
+}
+export interface BackendOptions {
+  // 'edk' streams to a real bridge; 'simulated' runs an in-process bridge
+  // that accepts any credentials and records every output frame
+  backend?: 'edk' | 'simulated';
+  // Simulated backend: lights per group (default 10) and frames kept (default 1024)
+  lights?: number;
+  captureFrames?: number;
+  // Simulated backend: delay of group activation plus DTLS handshake, and of
+  // each bridge configuration request (default 0), so warm starts show
+  handshakeMs?: number;
+  discoveryMs?: number;
+}
+// Frames recorded by the simulated backend, oldest first. Frame i has number
+// firstSeq + i, a steady-clock timestamp (same clock as process.hrtime on
+// Linux) and r, g, b (0-1) per light at colors[(i * lightIds.length + light) * 3].
+export interface CapturedFrames {
+  lightIds: string[];
+  firstSeq: number;
+  count: number;
+  timesNs: Float64Array;
+  colors: Float32Array;
+}
+// Durations in microseconds. buckets[i] counts samples below 2^i us (the last
+// bucket everything above); p50 / p99 are bucket upper bounds.
+export interface StatsHistogram {
+  count: number;
+  mean: number;
+  p50: number;
+  p99: number;
+  max: number;
+  buckets: number[];
+}
+// Totals since the stream started, except setterCallsPerSecond which covers
+// the time since the previous getStats() call
+export interface StreamStats {
+  setterCalls: number;
+  setterCallsPerSecond: number;
+  // Light writes dropped because the light already shows that color (at
+  // wire precision), and setter calls that changed nothing at all
+  writesSkipped: number;
+  publishesSkipped: number;
+  framesSent: number;
+  // Render ticks with no new manual frame; the previous colors are kept
+  framesUnchanged: number;
+  // Published frames replaced by a newer one before the render thread took them
+  framesCoalesced: number;
+  // Render ticks missed (frame intervals longer than 1.5 periods); idle
+  // keep-alive frames are not counted
+  framesDropped: number;
+  frameJitterUs: number;
+  lockWaitUs: StatsHistogram;
+  lockHoldUs: StatsHistogram;
+  // Render work per frame, the whole mixer render and send
+  frameTimeUs: StatsHistogram;
+  frameIntervalUs: StatsHistogram;
+  // From a setter call to the render of the frame that carried it
+  setterToFrameUs: StatsHistogram;
+  rate: RateStats;
+}
+// 'fixed' streams at the full rate; 'adaptive' drops to idleFps keep-alive
+// frames once nothing has changed for idleAfterMs (default 1000 ms, 2 fps)
+// and returns to the full rate on the next change
+export interface RatePolicy {
+  mode: 'fixed' | 'adaptive';
+  idleAfterMs?: number;
+  idleFps?: number;
+}
+// Per-light gamut correction of the output colors: each color is clipped to
+// the light's gamut, keeping its luminance, and re-encoded with gamma (0 keeps
+// the sRGB curve). Omitted fields keep their current value.
+export interface OutputCorrection {
+  enabled: boolean;
+  gamma: number;
+}
+export type LightGamut = 'A' | 'B' | 'C';
+export interface OutputCorrectionState extends OutputCorrection {
+  // Gamut per light id; empty until correction is on and the group is known
+  gamuts: Record<string, LightGamut>;
+}
+// The last connection with a warm start cache set. startupMs runs from
+// connectManual() to streaming; savedMs compares it with the cold start
+// that wrote the cache.
+export interface WarmStartReport {
+  path: string | null;
+  used: boolean;
+  startupMs: number;
+  coldStartMs: number;
+  savedMs: number;
+  // The bridge was asked in the background whether the cache still holds,
+  // and the cache had to be rewritten
+  revalidated: boolean;
+  changed: boolean;
+}
+export interface RateStats {
+  mode: 'fixed' | 'adaptive';
+  state: 'full' | 'idle';
+  // Time spent at each rate since the stream started
+  fullRateMs: number;
+  idleRateMs: number;
+  switches: number;
+}
+// missedTicks counts ticks that passed while JS was still busy; those ticks
+// are folded into the next callback
+export type FrameCallback = (frame: number, timeMs: number, deadlineMs: number, missedTicks: number) => void;
+// 'lost' is a stream that dropped without being stopped; 'reconnected'
+// follows it once the stream is back
+export type StreamState = 'connected' | 'disconnected' | 'streaming' | 'lost' | 'reconnected' | 'stopped';
+export type StateCallback = (state: StreamState, timeMs: number) => void;
+export interface FrameClockStats {
+  callbacks: number;
+  missedTicks: number;
+  // Callbacks that returned after their deadline
+  lateCallbacks: number;
+}
+export interface SharedInputStats {
+  attached: boolean;
+  // Frames taken from the ring, and frames the producer wrote that were
+  // never taken (in `gaps` separate runs)
+  frames: number;
+  gaps: number;
+  lostFrames: number;
+  // Reads the producer overwrote mid-copy, retried or skipped
+  tornReads: number;
+  // Render ticks with no new frame in the ring
+  staleTicks: number;
+}
+// Output capture to a file (see native/capture_file.h for the format)
+export interface CaptureSummary {
+  frames: number;
+  // Frames sent after the group's light count changed, not recorded
+  skippedFrames: number;
+  // Frames not recorded because the disk fell too far behind
+  droppedFrames: number;
+  // Light entries written; only lights that changed are stored
+  changedLights: number;
+  bytes: number;
+  writeError: boolean;
+}
+export interface ReplayStats {
+  playing: boolean;
+  framesPlayed: number;
+  // 0 for a capture that was not closed cleanly
+  frameCount: number;
+}
+export interface HueStats extends StreamStats {
+  // Present while a frame callback is set
+  frameClock?: FrameClockStats;
+  // Present once attachSharedFrames() was called
+  sharedInput?: SharedInputStats;
+  // Present while capturing
+  capture?: CaptureSummary;
+  // Present once startReplay() was called
+  replay?: ReplayStats;
+}
 export class HueWrapper {
-  constructor(appName: string, deviceName: string);
+  constructor(appName: string, deviceName: string, options?: BackendOptions);
   initialize(): HueStatus;
   connectManual(config: BridgeConfig): boolean;
   selectGroup(groupId: string): boolean;
   start(): boolean;
   stop(): boolean;
 
+  // Async variants: the EDK handshake runs off the JS thread. selectGroupAsync
+  // and startAsync resolve as soon as the bridge is streaming (or false after
+  // timeoutMs, default 5000).
+  connectManualAsync(config: BridgeConfig): Promise<boolean>;
+  selectGroupAsync(groupId: string, timeoutMs?: number): Promise<boolean>;
+  startAsync(timeoutMs?: number): Promise<boolean>;
+
   // RGB color methods (0-255 range, auto-normalized to 0-1)
   setColorRGB(r: number, g: number, b: number): boolean;
   setColorRGBA(r: number, g: number, b: number, alpha: number): boolean;
@@ -56,11 +308,173 @@ export class HueWrapper {
   setBrightness(brightness: number): boolean;
   setLightBrightness(lightId: number, brightness: number): boolean;
 
+  // Apply a whole frame (one entry per light id) under a single mixer lock
+  setFrame(lightIds: Int32Array | number[], data: Float32Array | Uint8Array, format: FrameFormat): boolean;
+
+  // Fade lights from their current color to a target over durationMs,
+  // interpolated on every render tick. A newer color or transition for the
+  // same light starts over from wherever the fade has got to.
+  setLightTransition(lightId: number, color: { r: number; g: number; b: number; a?: number }, durationMs: number, easing?: TimelineEasing): boolean;
+  setLightTransitions(lightIds: Int32Array | number[], data: Float32Array | Uint8Array, format: FrameFormat, durationMs: number, easing?: TimelineEasing): boolean;
+
+  // Named layers, each updated independently; new layers are transparent.
+  // createLayer returns false if the name is taken.
+  createLayer(name: string, options?: LayerOptions): boolean;
+  setLayerOptions(name: string, options: LayerOptions): boolean;
+  setLayerFrame(name: string, lightIds: Int32Array | number[], data: Float32Array | Uint8Array, format: FrameFormat): boolean;
+  clearLayer(name: string): boolean;
+  removeLayer(name: string): boolean;
+  // Bottom first
+  getLayers(): LayerInfo[];
+
+  // Colors every light of the group from a spatial field at timeMs, as one
+  // frame on the frame layer or the named layer
+  setField(field: SpatialField, timeMs: number, layer?: string): boolean;
+  getLightPositions(): LightPositions;
+
+  // Frames written by another process to the POSIX shared memory ring
+  // `name` (layout in native/shared_frames.h); frame light i drives
+  // lightIds[i]. Throws if the ring cannot be opened.
+  attachSharedFrames(name: string, lightIds: number[]): boolean;
+  detachSharedFrames(): boolean;
+
+  // Native effects: rendered per tick on the EDK render thread
+  startEffect(name: NativeEffectName, params: NativeEffectParams, lightIds: number[]): boolean;
+  setEffectParams(params: NativeEffectParams): boolean;
+  stopEffect(): boolean;
+  // Whether a native effect, timeline or sequence is still playing; false
+  // once one ends by itself
+  isEffectRunning(): boolean;
+  // Move the running native effect or timeline to timeMs since its start
+  seekEffect(timeMs: number): boolean;
+
+  // Timelines: compile once, play by handle (throws on malformed input)
+  loadTimeline(source: TimelineSource): number;
+  playTimeline(handle: number, startMs?: number): boolean;
+  unloadTimeline(handle: number): boolean;
+
+  // Replaces the running native effect (throws on malformed steps)
+  playSequence(steps: SequenceStep[], options?: SequenceOptions): boolean;
+
+  // Recorded frames numbered above sinceSeq; null unless backend is 'simulated'
+  getCapturedFrames(sinceSeq?: number): CapturedFrames | null;
+  clearCapturedFrames(): boolean;
+
+  // Record every frame sent to a compact binary file (throws if it cannot be
+  // created); stopCapture returns null if no capture ran
+  startCapture(path: string): boolean;
+  stopCapture(): CaptureSummary | null;
+  // Stream a capture back with its original timing, on top of all layers
+  startReplay(path: string, options?: { loop?: boolean }): boolean;
+  stopReplay(): boolean;
+
   getLightIds(): string[];
+  // Heap allocations made on the calling thread; -1 unless built with count_allocations=1
+  getAllocationCount(): number;
   update(): boolean;
   getStatus(): BridgeStatus;
+  // Lock-free counters and latency histograms; null before initialize()
+  getStats(): HueStats | null;
+  // Omitted fields keep their current value; kept across shutdown()
+  setRatePolicy(policy: Partial<RatePolicy>): boolean;
+  getRatePolicy(): Required<RatePolicy>;
+  // Kept across shutdown(); gamma must be 0 or 1-4
+  setOutputCorrection(correction: Partial<OutputCorrection>): boolean;
+  getOutputCorrection(): OutputCorrectionState;
+  // Opt-in cache of bridge and group state; connectManual() for the cached
+  // bridge then resolves with the stream already up. Kept across shutdown().
+  setWarmStart(path: string | null): boolean;
+  getWarmStart(): WarmStartReport;
+  // Called once per render tick, right after the tick was sent; what it sets
+  // goes out on the next tick at deadlineMs. Times are monotonic ms on the
+  // process.hrtime() clock. Throws before initialize().
+  setFrameCallback(callback: FrameCallback): boolean;
+  clearFrameCallback(): boolean;
+  // Called on every stream state change, in order; kept across shutdown().
+  // Does not keep the process alive.
+  setStateCallback(callback: StateCallback): boolean;
+  clearStateCallback(): boolean;
+  shutdown(): boolean;
+}
+export interface SessionManagerOptions extends BackendOptions {
+  // Shared render clock for every session (default 60)
+  fps?: number;
+}
+export interface SessionStatsEntry extends StreamStats {
+  id: number;
+  bridgeId: string;
+  groupId: string;
+  streaming: boolean;
+}
+export interface SessionManagerStats {
+  fps: number;
+  running: boolean;
+  ticks: number;
+  // Ticks that started more than a frame late
+  lateTicks: number;
+  // First-to-last session render time within the latest tick
+  tickSpreadUs: number;
+  sessions: SessionStatsEntry[];
+}
+// Several bridges / entertainment groups streamed from one process. All
+// sessions are rendered on one shared clock; calls take the id from addSession().
+export class HueSessionManager {
+  constructor(appName: string, deviceName: string, options?: SessionManagerOptions);
+  addSession(config: BridgeConfig, groupId: string): number;
+  // Connects, selects the group and joins the render clock once streaming
+  connectSession(id: number, timeoutMs?: number): Promise<boolean>;
+  removeSession(id: number): boolean;
+  setFrame(id: number, lightIds: Int32Array | number[], data: Float32Array | Uint8Array, format: FrameFormat): boolean;
+  startEffect(id: number, name: NativeEffectName, params: NativeEffectParams, lightIds: number[]): boolean;
+  stopEffect(id: number): boolean;
+  getLightIds(id: number): string[];
+  getCapturedFrames(id: number, sinceSeq?: number): CapturedFrames | null;
+  getStats(): SessionManagerStats;
+  // Applies to every session, including ones added later
+  setRatePolicy(policy: Partial<RatePolicy>): boolean;
   shutdown(): boolean;
 }
+// Batch color math over whole frames (r, g, b interleaved per light, 0-255).
+// Each function writes into out, which may be the input array, and returns it.
+export interface ColorKernels {
+  readonly isa: 'avx2' | 'sse2' | 'scalar';
+  // a and b: one color (length 3) or one per light; t: one factor or one per light
+  lerpColors(a: Float32Array, b: Float32Array, t: Float32Array | number, out: Float32Array): Float32Array;
+  // h, s, v (0-1) per light, same results as hsvToRgb() before rounding
+  hsvToRgb(hsv: Float32Array, out: Float32Array): Float32Array;
+  // x, y, brightness per light, clipped to the Hue gamut; feeds setFrame(..., 'xy')
+  rgbToXy(rgb: Float32Array, out: Float32Array): Float32Array;
+  // Over every value: 255 * (v / 255) ^ gamma, and v * scale clamped to 0-255
+  applyGamma(data: Float32Array, gamma: number, out: Float32Array): Float32Array;
+  scaleBrightness(data: Float32Array, scale: number, out: Float32Array): Float32Array;
+}
+export declare const colorKernels: ColorKernels;
+// Precomputed cycles of the periodic native effects (gradientWave,
+// rippleGradient, breathingGradient, chaseGradient, rainbowWave, pulseWave),
+// keyed by effect, parameters and light count and shared by every session
+export interface FrameCacheStats {
+  limitBytes: number;
+  bytes: number;
+  tables: number;
+  hits: number;
+  misses: number;
+  evictions: number;
+}
+export interface FrameCache {
+  // Least recently used cycles are evicted above the limit (default 16 MiB);
+  // 0 renders every frame live
+  setLimit(bytes: number): boolean;
+  clear(): boolean;
+  stats(): FrameCacheStats;
+}
+export declare const frameCache: FrameCache;
+// Decodes a whole capture file; firstSeq is 1 and timesNs are the original
+// send times. Throws if the file is not a capture.
+export declare function readCaptureFile(path: string): CapturedFrames;
 declare module './hue-edk/build/Release/hue_edk.node' {
   export const HueWrapper: typeof HueWrapper;
+  export const HueSessionManager: typeof HueSessionManager;
+  export const colorKernels: ColorKernels;
+  export const frameCache: FrameCache;
+  export const readCaptureFile: (path: string) => CapturedFrames;
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+import type { TimelineDefinition, TimelineEasing } from './native';
+
+const EASING_CODES: Record<TimelineEasing, number> = {
+    linear: 0,
+    step: 1,
+    easeIn: 2,
+    easeOut: 3,
+    easeInOut: 4,
+};
+
+const HEADER_SIZE = 20;
+const TRACK_HEADER_SIZE = 8;
+const KEYFRAME_SIZE = 12;
+
+// Colors are stored as bytes, so channels are rounded and clamped to 0-255
+// rather than wrapped modulo 256 by setUint8()
+function toByte(value: number): number {
+    return Math.min(255, Math.max(0, Math.round(value)));
+}
+
+/**
+ * Encode a timeline in the compact binary form accepted by loadTimeline().
+ * Layout (little-endian): "HTL1", u8 flags (bit 0 = loop), 3 reserved bytes,
+ * f64 duration, u32 trackCount, then per track i32 lightId, u32 keyframeCount
+ * and keyframeCount x { f64 t, u8 r, u8 g, u8 b, u8 easing }.
+ */
+export function encodeTimeline(timeline: TimelineDefinition): Uint8Array {
+    let size = HEADER_SIZE;
+    for (const track of timeline.tracks) {
+        size += TRACK_HEADER_SIZE + track.keyframes.length * KEYFRAME_SIZE;
+    }
+
+    const bytes = new Uint8Array(size);
+    const view = new DataView(bytes.buffer);
+    bytes.set([0x48, 0x54, 0x4c, 0x31], 0);  // "HTL1"
+    view.setUint8(4, timeline.loop ? 1 : 0);
+    view.setFloat64(8, timeline.duration ?? 0, true);
+    view.setUint32(16, timeline.tracks.length, true);
+
+    let offset = HEADER_SIZE;
+    for (const track of timeline.tracks) {
+        view.setInt32(offset, track.lightId, true);
+        view.setUint32(offset + 4, track.keyframes.length, true);
+        offset += TRACK_HEADER_SIZE;
+        for (const key of track.keyframes) {
+            view.setFloat64(offset, key.t, true);
+            view.setUint8(offset + 8, toByte(key.color.r));
+            view.setUint8(offset + 9, toByte(key.color.g));
+            view.setUint8(offset + 10, toByte(key.color.b));
+            view.setUint8(offset + 11, EASING_CODES[key.easing ?? 'linear']);
+            offset += KEYFRAME_SIZE;
+        }
+    }
+    return bytes;
+}